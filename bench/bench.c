@@ -0,0 +1,517 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+// Micro-benchmarks of each stage of the interpreter, run with "make bench".
+// Each benchmark runs in rounds calibrated to last BENCH_ROUND_NS, and the
+// median round is reported as ns/op. The results are written as JSON, with
+// one benchmark per line, so that a previous run can be read back as the
+// baseline ("make bench-baseline") and compared with a regression threshold
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "data-structures/string_buffer.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "variables.h"
+
+#define BENCH_ROUND_NS 10000000ull
+#define BENCH_ROUNDS 7
+#define BENCH_MAX_RESULTS 128
+#define BENCH_MAX_NAME_LENGTH 128
+#define BENCH_DEFAULT_THRESHOLD 10.0
+
+typedef void (*Bench_Function)(void *const data, const uint64_t iterations);
+
+struct Bench_Result {
+    char name[BENCH_MAX_NAME_LENGTH];
+    double ns_per_op;
+    double min_ns_per_op;
+    uint64_t iterations;
+};
+
+struct Bench_Results {
+    struct Bench_Result list[BENCH_MAX_RESULTS];
+    size_t size;
+    // Only the benchmarks whose name contain it are run
+    const char *filter;
+};
+
+// Keeps the compiler from discarding the results of the benchmarked functions
+static volatile double sink;
+
+// Fixed corpora used by the lexer, parser and evaluation benchmarks
+static const struct Corpus {
+    const char *name;
+    const char *line;
+} corpora[] = {
+    {"arithmetic", "1 + 2 * 3 - 4 / 5 + 6 ^ 2 - 7 * (8 + 9)"},
+    {"functions", "sqrt(2) + sin(pi) * cos(0.5) + log(10) - exp(1) + hypot(3, 4)"},
+    {"variables", "result = alpha * beta + kappa / delta - alpha ^ 2"},
+    {"numbers", "3.141592653589793 + 6.02214076e23 - 0x7fffffff * 0b101010 + 1e-9"},
+    {"nested", "((((1 + 2) * (3 + 4)) / ((5 - 6) * (7 - 8))) ^ (((9))))"},
+};
+
+static const char *const numbers[] = {
+    "42",
+    "3.141592653589793",
+    "6.02214076e23",
+    "0x7fffffff",
+    "0b101010",
+};
+
+static const size_t workspace_sizes[] = {16, 1024, 65536};
+
+static double elapsed_ns(const Bench_Function function, void *const data, const uint64_t iterations) {
+    const uint64_t start = monotonic_time_ns();
+    function(data, iterations);
+    return (double)(monotonic_time_ns() - start);
+}
+
+static int compare_doubles(const void *const a, const void *const b) {
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void measure(struct Bench_Results *const results, const char *const name, const Bench_Function function, void *const data) {
+    if ((results->filter != NULL) && (strstr(name, results->filter) == NULL)) {
+        return;
+    }
+    if (results->size >= BENCH_MAX_RESULTS) {
+        fprintf(stderr, "Too many benchmarks, \"%s\" was skipped!\n", name);
+        return;
+    }
+    // Doubles the iterations until a round is long enough to be timed precisely
+    uint64_t iterations = 1;
+    double ns = elapsed_ns(function, data, iterations);
+    while (ns < (double)(BENCH_ROUND_NS / 16)) {
+        iterations *= 2;
+        ns = elapsed_ns(function, data, iterations);
+    }
+    iterations = (uint64_t)((double)iterations * (double)BENCH_ROUND_NS / ns) + 1;
+    double rounds[BENCH_ROUNDS];
+    for (size_t i = 0; i < BENCH_ROUNDS; i++) {
+        rounds[i] = elapsed_ns(function, data, iterations) / (double)iterations;
+    }
+    qsort(rounds, BENCH_ROUNDS, sizeof(double), compare_doubles);
+    struct Bench_Result *const result = &results->list[results->size++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->ns_per_op = rounds[BENCH_ROUNDS / 2];
+    result->min_ns_per_op = rounds[0];
+    result->iterations = iterations;
+    fprintf(stderr, "%-40s %12.2lf ns/op\n", result->name, result->ns_per_op);
+}
+
+//------------------------------------------------------------------------------
+// Lexer, parser and evaluation
+//------------------------------------------------------------------------------
+
+struct Pipeline_Data {
+    struct Context *ctx;
+    struct String line;
+    size_t head_idx;
+};
+
+static void run_lex(void *const data, const uint64_t iterations) {
+    struct Pipeline_Data *const pipeline = data;
+    for (uint64_t i = 0; i < iterations; i++) {
+        lex(&pipeline->ctx->lexer, pipeline->line);
+    }
+}
+
+static void run_parse(void *const data, const uint64_t iterations) {
+    struct Pipeline_Data *const pipeline = data;
+    for (uint64_t i = 0; i < iterations; i++) {
+        pipeline->head_idx = parse(&pipeline->ctx->parser);
+    }
+}
+
+static void run_evaluate(void *const data, const uint64_t iterations) {
+    struct Pipeline_Data *const pipeline = data;
+    for (uint64_t i = 0; i < iterations; i++) {
+        enum Evaluation_Status status = Eval_OK;
+        sink = evaluate(&pipeline->ctx->parser, pipeline->head_idx, &status);
+    }
+}
+
+static void bench_pipeline(struct Bench_Results *const results, struct Context *const ctx) {
+    const char *const variables[] = {"alpha", "beta", "kappa", "delta"};
+    for (size_t i = 0; i < (sizeof(variables) / sizeof(variables[0])); i++) {
+        assign_variable(&ctx->vars, create_string((char *)variables[i]), (double)(i + 2));
+    }
+    char name[BENCH_MAX_NAME_LENGTH];
+    for (size_t i = 0; i < (sizeof(corpora) / sizeof(corpora[0])); i++) {
+        struct Pipeline_Data pipeline = {
+            .ctx = ctx,
+            .line = create_string((char *)corpora[i].line),
+        };
+        if (lex(&ctx->lexer, pipeline.line) || array_index_is_invalid(ctx->parser.nodes, parse(&ctx->parser))) {
+            fprintf(stderr, "The corpus \"%s\" is invalid!\n", corpora[i].name);
+            continue;
+        }
+        snprintf(name, sizeof(name), "lex/%s", corpora[i].name);
+        measure(results, name, run_lex, &pipeline);
+        snprintf(name, sizeof(name), "parse/%s", corpora[i].name);
+        measure(results, name, run_parse, &pipeline);
+        pipeline.head_idx = parse(&ctx->parser);
+        snprintf(name, sizeof(name), "evaluate/%s", corpora[i].name);
+        measure(results, name, run_evaluate, &pipeline);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Variables
+//------------------------------------------------------------------------------
+
+#define VARIABLE_NAME_LENGTH 8
+
+struct Variables_Data {
+    struct Variables *vars;
+    // Names of the variables in the workspace, and names that aren't, which
+    // are sorted between them, so that inserting them moves half of the list
+    char *names;
+    char *missing_names;
+    size_t size;
+};
+
+static struct String variable_name(char *const names, const size_t size, const uint64_t i) {
+    // Visits the names out of order, so that the searches don't benefit from the previous one
+    const size_t index = (size_t)((i * 7919) % size);
+    return create_sized_string(&names[index * VARIABLE_NAME_LENGTH], VARIABLE_NAME_LENGTH - 1);
+}
+
+static void run_search_hit(void *const data, const uint64_t iterations) {
+    struct Variables_Data *const variables = data;
+    size_t index = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = search_variable(variables->vars, variable_name(variables->names, variables->size, i), &index);
+    }
+}
+
+static void run_search_miss(void *const data, const uint64_t iterations) {
+    struct Variables_Data *const variables = data;
+    size_t index = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = search_variable(variables->vars, variable_name(variables->missing_names, variables->size, i), &index);
+    }
+}
+
+static void run_assign_existing(void *const data, const uint64_t iterations) {
+    struct Variables_Data *const variables = data;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = assign_variable(variables->vars, variable_name(variables->names, variables->size, i), (double)i);
+    }
+}
+
+static void run_assign_new(void *const data, const uint64_t iterations) {
+    struct Variables_Data *const variables = data;
+    for (uint64_t i = 0; i < iterations; i++) {
+        const struct String name = variable_name(variables->missing_names, variables->size, i);
+        sink = assign_variable(variables->vars, name, (double)i);
+        delete_variable(variables->vars, name);
+    }
+}
+
+static void bench_variables(struct Bench_Results *const results, struct Context *const ctx) {
+    char name[BENCH_MAX_NAME_LENGTH];
+    for (size_t i = 0; i < (sizeof(workspace_sizes) / sizeof(workspace_sizes[0])); i++) {
+        const size_t size = workspace_sizes[i];
+        struct Variables vars = create_variables(64, &ctx->diagnostics);
+        struct Variables_Data variables = {
+            .vars = &vars,
+            .names = malloc(size * VARIABLE_NAME_LENGTH),
+            .missing_names = malloc(size * VARIABLE_NAME_LENGTH),
+            .size = size,
+        };
+        if ((variables.names == NULL) || (variables.missing_names == NULL)) {
+            fprintf(stderr, "Couldn't allocate memory for the variables benchmark!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t j = 0; j < size; j++) {
+            snprintf(&variables.names[j * VARIABLE_NAME_LENGTH], VARIABLE_NAME_LENGTH, "v%06zu", j % 1000000);
+            snprintf(&variables.missing_names[j * VARIABLE_NAME_LENGTH], VARIABLE_NAME_LENGTH, "v%05zux", (j / 10) % 100000);
+            assign_variable(&vars, create_sized_string(&variables.names[j * VARIABLE_NAME_LENGTH], VARIABLE_NAME_LENGTH - 1), (double)j);
+        }
+        snprintf(name, sizeof(name), "search_variable/hit/%zu", size);
+        measure(results, name, run_search_hit, &variables);
+        snprintf(name, sizeof(name), "search_variable/miss/%zu", size);
+        measure(results, name, run_search_miss, &variables);
+        snprintf(name, sizeof(name), "assign_variable/existing/%zu", size);
+        measure(results, name, run_assign_existing, &variables);
+        snprintf(name, sizeof(name), "assign_variable/new+delete/%zu", size);
+        measure(results, name, run_assign_new, &variables);
+        destroy_variables(&vars);
+        free(variables.names);
+        free(variables.missing_names);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Numbers
+//------------------------------------------------------------------------------
+
+static void run_parse_number(void *const data, const uint64_t iterations) {
+    const struct String *const number = data;
+    String_Length length = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = parse_number(*number, &length);
+    }
+}
+
+static void bench_numbers(struct Bench_Results *const results) {
+    char name[BENCH_MAX_NAME_LENGTH];
+    for (size_t i = 0; i < (sizeof(numbers) / sizeof(numbers[0])); i++) {
+        struct String number = create_string((char *)numbers[i]);
+        snprintf(name, sizeof(name), "parse_number/%s", numbers[i]);
+        measure(results, name, run_parse_number, &number);
+    }
+}
+
+//------------------------------------------------------------------------------
+// String buffer
+//------------------------------------------------------------------------------
+
+#define TYPED_LINE "x = sqrt(alpha ^ 2 + beta ^ 2) * sin(theta) + 0.5 * gamma"
+
+// Types a line at the end, as the user does, and stores it in the history
+static void run_type_line(void *const data, const uint64_t iterations) {
+    struct String_Buffer *const buffer = data;
+    const String_Length length = (String_Length)(sizeof(TYPED_LINE) - 1);
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (String_Length j = 0; j < length; j++) {
+            add_char_at(buffer, TYPED_LINE[j], j);
+        }
+        update_current_string(buffer);
+    }
+}
+
+// Inserts and removes a character in the middle of the current line
+static void run_edit_middle(void *const data, const uint64_t iterations) {
+    struct String_Buffer *const buffer = data;
+    const String_Length position = (String_Length)(get_current_node(buffer)->length / 2);
+    for (uint64_t i = 0; i < iterations; i++) {
+        add_char_at(buffer, '+', position);
+        remove_char_at(buffer, position);
+    }
+}
+
+// Copies the previous line of the history to the current one, as the up arrow does
+static void run_recall_history(void *const data, const uint64_t iterations) {
+    struct String_Buffer *const buffer = data;
+    for (uint64_t i = 0; i < iterations; i++) {
+        const String_Node_Index previous = get_previous_node(buffer, buffer->current_index, INVALID_STRING_INDEX);
+        copy_string_at_index(buffer, previous);
+    }
+}
+
+static void bench_string_buffer(struct Bench_Results *const results) {
+    struct String_Buffer *const buffer = malloc(sizeof(struct String_Buffer));
+    if (buffer == NULL) {
+        fprintf(stderr, "Couldn't allocate memory for the string buffer benchmark!\n");
+        exit(EXIT_FAILURE);
+    }
+    *buffer = create_string_buffer();
+    measure(results, "string_buffer/type_line", run_type_line, buffer);
+    run_type_line(buffer, 1);
+    for (String_Length j = 0; j < (String_Length)(sizeof(TYPED_LINE) - 1); j++) {
+        add_char_at(buffer, TYPED_LINE[j], j);
+    }
+    measure(results, "string_buffer/edit_middle", run_edit_middle, buffer);
+    measure(results, "string_buffer/recall_history", run_recall_history, buffer);
+    free(buffer);
+}
+
+//------------------------------------------------------------------------------
+// Results
+//------------------------------------------------------------------------------
+
+// Returns true if found an error
+static bool write_results(const struct Bench_Results *const results, const char *const file_name) {
+    FILE *const file = (file_name != NULL) ? fopen(file_name, "w") : stdout;
+    if (file == NULL) {
+        perror(file_name);
+        return true;
+    }
+    fprintf(file, "{\"benchmarks\": [\n");
+    for (size_t i = 0; i < results->size; i++) {
+        const struct Bench_Result *const result = &results->list[i];
+        fprintf(file, "{\"name\": \"%s\", \"ns_per_op\": %.3lf, \"min_ns_per_op\": %.3lf, \"iterations\": %" PRIu64 "}%s\n",
+                result->name, result->ns_per_op, result->min_ns_per_op, result->iterations, (i + 1 < results->size) ? "," : "");
+    }
+    fprintf(file, "]}\n");
+    const bool error = ferror(file) || ((file != stdout) && fclose(file));
+    if (error) {
+        perror(file_name);
+    }
+    return error;
+}
+
+// Reads a file written by write_results. Returns true if found an error
+static bool read_baseline(struct Bench_Results *const baseline, const char *const file_name) {
+    FILE *const file = fopen(file_name, "r");
+    if (file == NULL) {
+        return true;
+    }
+    char line[512];
+    while ((fgets(line, sizeof(line), file) != NULL) && (baseline->size < BENCH_MAX_RESULTS)) {
+        struct Bench_Result *const result = &baseline->list[baseline->size];
+        if (sscanf(line, " {\"name\": \"%127[^\"]\", \"ns_per_op\": %lf", result->name, &result->ns_per_op) == 2) {
+            baseline->size++;
+        }
+    }
+    fclose(file);
+    return false;
+}
+
+// Returns the number of benchmarks slower than the baseline by more than the threshold
+static size_t compare_results(const struct Bench_Results *const results, const struct Bench_Results *const baseline, const double threshold) {
+    size_t regressions = 0;
+    fprintf(stderr, "\n%-40s %12s %12s %9s\n", "Benchmark", "Baseline", "Current", "Change");
+    for (size_t i = 0; i < results->size; i++) {
+        const struct Bench_Result *const result = &results->list[i];
+        const struct Bench_Result *previous = NULL;
+        for (size_t j = 0; (j < baseline->size) && (previous == NULL); j++) {
+            if (!strcmp(baseline->list[j].name, result->name)) {
+                previous = &baseline->list[j];
+            }
+        }
+        if (previous == NULL) {
+            fprintf(stderr, "%-40s %12s %12.2lf %9s\n", result->name, "-", result->ns_per_op, "new");
+            continue;
+        }
+        const double change = 100.0 * (result->ns_per_op - previous->ns_per_op) / previous->ns_per_op;
+        const bool regression = (change > threshold);
+        fprintf(stderr, "%-40s %12.2lf %12.2lf %+8.1lf%%%s\n", result->name, previous->ns_per_op, result->ns_per_op, change, regression ? "  REGRESSION" : "");
+        if (regression) {
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+static void usage(const char *const program) {
+    fprintf(stderr, "[Usage] %s [--output file.json] [--baseline file.json] [--optional-baseline] [--threshold percent] [--filter name]\n", program);
+}
+
+int main(const int argc, const char *const argv[]) {
+    const char *output_file = NULL;
+    const char *baseline_file = NULL;
+    // A missing baseline is an error, unless it was declared optional
+    bool optional_baseline = false;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    struct Bench_Results *const results = calloc(2, sizeof(struct Bench_Results));
+    if (results == NULL) {
+        fprintf(stderr, "Couldn't allocate memory for the results!\n");
+        return EXIT_FAILURE;
+    }
+    struct Bench_Results *const baseline = &results[1];
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--optional-baseline")) {
+            optional_baseline = true;
+        } else if ((i + 1) >= argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (!strcmp(argv[i], "--output")) {
+            output_file = argv[++i];
+        } else if (!strcmp(argv[i], "--baseline")) {
+            baseline_file = argv[++i];
+        } else if (!strcmp(argv[i], "--threshold")) {
+            char *end = NULL;
+            threshold = strtod(argv[++i], &end);
+            if ((end == argv[i]) || (*end != '\0') || !(threshold >= 0.0)) {
+                fprintf(stderr, "Invalid threshold: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (!strcmp(argv[i], "--filter")) {
+            results->filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    struct Context ctx;
+    create_context(&ctx, stderr);
+    bench_pipeline(results, &ctx);
+    bench_variables(results, &ctx);
+    bench_numbers(results);
+    bench_string_buffer(results);
+    destroy_context(&ctx);
+    int exit_status = EXIT_SUCCESS;
+    if (write_results(results, output_file)) {
+        exit_status = EXIT_FAILURE;
+    }
+    if (baseline_file != NULL) {
+        if (read_baseline(baseline, baseline_file)) {
+            fprintf(stderr, "\nThere is no baseline at \"%s\", store one with \"make bench-baseline\"\n", baseline_file);
+            if (!optional_baseline) {
+                exit_status = EXIT_FAILURE;
+            }
+        } else {
+            const size_t regressions = compare_results(results, baseline, threshold);
+            if (regressions > 0) {
+                fprintf(stderr, "\n%zu benchmarks are more than %.1lf%% slower than the baseline!\n", regressions, threshold);
+                exit_status = EXIT_FAILURE;
+            }
+        }
+    }
+    free(results);
+    return exit_status;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,368 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+// Scaling benchmark, run with "make bench-scaling". It generates expressions
+// with a controlled shape at growing sizes, times lex(), parse() and
+// evaluate() on each one, and fits the empirical growth exponent k of
+// time ~ tokens^k, so that a quadratic behaviour shows up as k close to 2.
+// A line can't be longer than the maximum String_Length, so each shape only
+// grows until it reaches this limit. With "--generate shape tokens" the
+// expression is printed instead, to be used elsewhere (as with --bench)
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "variables.h"
+
+#define SCALING_MIN_TOKENS 10
+#define SCALING_MAX_TOKENS 1000000
+// Minimum duration of each timed round
+#define SCALING_ROUND_NS 20000000ull
+#define SCALING_ROUNDS 3
+#define MAX_LINE_LENGTH ((size_t)UINT16_MAX)
+// Longest piece appended by a generator
+#define MAX_PIECE_LENGTH 32
+
+struct Generated {
+    char text[MAX_LINE_LENGTH + 1];
+    size_t length;
+    size_t tokens;
+};
+
+// Appends the index-th piece of the shape to the expression
+typedef void (*Generator)(struct Generated *const expression, const size_t index);
+
+// 1 + 1 + 1 + ...
+static void generate_left_chain(struct Generated *const expression, const size_t index) {
+    (void)index;
+    expression->length += (size_t)sprintf(&expression->text[expression->length], (expression->tokens == 0) ? "1" : " + 1");
+    expression->tokens += (expression->tokens == 0) ? 1 : 2;
+}
+
+// 1 ^ 1 ^ 1 ^ ..., which is nested to the right
+static void generate_right_powers(struct Generated *const expression, const size_t index) {
+    (void)index;
+    expression->length += (size_t)sprintf(&expression->text[expression->length], (expression->tokens == 0) ? "1" : " ^ 1");
+    expression->tokens += (expression->tokens == 0) ? 1 : 2;
+}
+
+// ((((1))))
+static void generate_deep_parentheses(struct Generated *const expression, const size_t index) {
+    if (index == 0) {
+        expression->text[expression->length++] = '1';
+        expression->tokens++;
+    }
+    memmove(&expression->text[1], expression->text, expression->length);
+    expression->text[0] = '(';
+    expression->text[expression->length + 1] = ')';
+    expression->length += 2;
+    expression->tokens += 2;
+}
+
+// sin(sin(sin(1)))
+static void generate_function_nesting(struct Generated *const expression, const size_t index) {
+    if (index == 0) {
+        expression->text[expression->length++] = '1';
+        expression->tokens++;
+    }
+    memmove(&expression->text[4], expression->text, expression->length);
+    memcpy(expression->text, "sin(", 4);
+    expression->text[expression->length + 4] = ')';
+    expression->length += 5;
+    expression->tokens += 3;
+}
+
+// v0 + v1 + v2 + ..., whose variables are created before the measurements
+static void generate_distinct_variables(struct Generated *const expression, const size_t index) {
+    expression->length += (size_t)sprintf(&expression->text[expression->length], (expression->tokens == 0) ? "v%zu" : " + v%zu", index);
+    expression->tokens += (expression->tokens == 0) ? 1 : 2;
+}
+
+static const struct Shape {
+    const char *name;
+    Generator generator;
+} shapes[] = {
+    {"left_chain", generate_left_chain},
+    {"right_powers", generate_right_powers},
+    {"deep_parentheses", generate_deep_parentheses},
+    {"function_nesting", generate_function_nesting},
+    {"distinct_variables", generate_distinct_variables},
+};
+
+#define SHAPES_QUANTITY (sizeof(shapes) / sizeof(shapes[0]))
+
+// Generates an expression with at least the given number of tokens. Returns
+// true if it would be longer than the maximum length of a line
+static bool generate(const struct Shape *const shape, const size_t tokens, struct Generated *const expression) {
+    expression->length = 0;
+    expression->tokens = 0;
+    for (size_t index = 0; expression->tokens < tokens; index++) {
+        if ((expression->length + MAX_PIECE_LENGTH) > MAX_LINE_LENGTH) {
+            return true;
+        }
+        shape->generator(expression, index);
+    }
+    expression->text[expression->length] = '\0';
+    return false;
+}
+
+enum Stage {
+    STAGE_LEX,
+    STAGE_PARSE,
+    STAGE_EVALUATE,
+};
+
+struct Stage_Data {
+    struct Context *ctx;
+    struct String line;
+    size_t head_idx;
+};
+
+// Keeps the compiler from discarding the evaluations
+static volatile double sink;
+
+static void run_stage(struct Stage_Data *const data, const enum Stage stage, const uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        switch (stage) {
+        case STAGE_LEX:
+            lex(&data->ctx->lexer, data->line);
+            break;
+        case STAGE_PARSE:
+            data->head_idx = parse(&data->ctx->parser);
+            break;
+        case STAGE_EVALUATE: {
+            enum Evaluation_Status status = Eval_OK;
+            sink = evaluate(&data->ctx->parser, data->head_idx, &status);
+            break;
+        }
+        }
+    }
+}
+
+// Returns the minimum time of a run of the stage, in nanoseconds
+static double time_stage(struct Stage_Data *const data, const enum Stage stage) {
+    double best = INFINITY;
+    uint64_t iterations = 1;
+    for (size_t round = 0; round < SCALING_ROUNDS;) {
+        const uint64_t start = monotonic_time_ns();
+        run_stage(data, stage, iterations);
+        const uint64_t elapsed = monotonic_time_ns() - start;
+        if (elapsed < SCALING_ROUND_NS) {
+            // Calibrating, the round is too short to be timed precisely
+            iterations *= 2;
+            continue;
+        }
+        best = fmin(best, (double)elapsed / (double)iterations);
+        round++;
+    }
+    return best;
+}
+
+struct Measurement {
+    size_t tokens;
+    size_t length;
+    double ns[3];
+    // Memory used by the tokens and by the nodes of the tree. The evaluation
+    // doesn't allocate memory, only uses the stack
+    size_t tokens_bytes;
+    size_t nodes_bytes;
+};
+
+// Returns true if found an error
+static bool measure(const struct Generated *const expression, struct Measurement *const measurement) {
+    // Each measurement has its own context, so that the memory used by the previous one doesn't count
+    struct Context ctx;
+    create_context(&ctx, stderr);
+    for (size_t i = 0; i * 2 <= expression->tokens; i++) {
+        char name[32];
+        const int length = snprintf(name, sizeof(name), "v%zu", i);
+        assign_variable(&ctx.vars, create_sized_string(name, (String_Length)length), 1.0);
+    }
+    struct Stage_Data data = {
+        .ctx = &ctx,
+        .line = create_sized_string((char *)expression->text, (String_Length)expression->length),
+    };
+    bool error = lex(&ctx.lexer, data.line);
+    if (!error) {
+        data.head_idx = parse(&ctx.parser);
+        error = array_index_is_invalid(ctx.parser.nodes, data.head_idx);
+    }
+    if (!error) {
+        *measurement = (struct Measurement){
+            .tokens = array_size(ctx.lexer.tokens),
+            .length = expression->length,
+            .ns = {
+                time_stage(&data, STAGE_LEX),
+                time_stage(&data, STAGE_PARSE),
+                time_stage(&data, STAGE_EVALUATE),
+            },
+            .tokens_bytes = array_capacity(ctx.lexer.tokens) * sizeof(struct Token),
+            .nodes_bytes = array_capacity(ctx.parser.nodes) * sizeof(struct Token_Node),
+        };
+    }
+    destroy_context(&ctx);
+    return error;
+}
+
+// Least squares fit of log(y) = k*log(x) + c, returning k
+static double growth_exponent(const struct Measurement *const measurements, const size_t quantity, const size_t stage) {
+    double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+    for (size_t i = 0; i < quantity; i++) {
+        const double x = log((double)measurements[i].tokens);
+        const double y = log(measurements[i].ns[stage]);
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+    }
+    const double n = (double)quantity;
+    return ((n * sum_xy) - (sum_x * sum_y)) / ((n * sum_xx) - (sum_x * sum_x));
+}
+
+static void benchmark_shape(const struct Shape *const shape, struct Generated *const expression) {
+    struct Measurement measurements[32];
+    size_t quantity = 0;
+    printf("%s\n%10s %10s %14s %14s %14s %12s %12s\n", shape->name, "tokens", "chars", "lex ns", "parse ns", "evaluate ns", "token bytes", "node bytes");
+    // Sizes of 1, 2 and 5 times each power of ten
+    for (size_t decade = SCALING_MIN_TOKENS; decade <= SCALING_MAX_TOKENS; decade *= 10) {
+        const size_t steps[] = {1, 2, 5};
+        for (size_t step = 0; (step < (sizeof(steps) / sizeof(steps[0]))) && ((decade * steps[step]) <= SCALING_MAX_TOKENS); step++) {
+            if (generate(shape, decade * steps[step], expression)) {
+                printf("%10zu %10s (longer than a line)\n", decade * steps[step], "-");
+                goto fit;
+            }
+            struct Measurement *const measurement = &measurements[quantity];
+            if (measure(expression, measurement)) {
+                fprintf(stderr, "The expression of %zu tokens couldn't be parsed!\n", expression->tokens);
+                goto fit;
+            }
+            printf("%10zu %10zu %14.0lf %14.0lf %14.0lf %12zu %12zu\n", measurement->tokens, measurement->length,
+                   measurement->ns[STAGE_LEX], measurement->ns[STAGE_PARSE], measurement->ns[STAGE_EVALUATE],
+                   measurement->tokens_bytes, measurement->nodes_bytes);
+            fflush(stdout);
+            quantity++;
+        }
+    }
+fit:
+    if (quantity >= 2) {
+        printf("Growth exponent: lex %.2lf, parse %.2lf, evaluate %.2lf\n\n",
+               growth_exponent(measurements, quantity, STAGE_LEX),
+               growth_exponent(measurements, quantity, STAGE_PARSE),
+               growth_exponent(measurements, quantity, STAGE_EVALUATE));
+    }
+}
+
+static const struct Shape *find_shape(const char *const name) {
+    for (size_t i = 0; i < SHAPES_QUANTITY; i++) {
+        if (!strcmp(shapes[i].name, name)) {
+            return &shapes[i];
+        }
+    }
+    fprintf(stderr, "Unknown shape \"%s\", the shapes are:", name);
+    for (size_t i = 0; i < SHAPES_QUANTITY; i++) {
+        fprintf(stderr, " %s", shapes[i].name);
+    }
+    fprintf(stderr, "\n");
+    return NULL;
+}
+
+static void usage(const char *const program) {
+    fprintf(stderr, "[Usage] %s [--shape name] [--generate name tokens]\n", program);
+}
+
+int main(const int argc, const char *const argv[]) {
+    struct Generated *const expression = malloc(sizeof(struct Generated));
+    if (expression == NULL) {
+        fprintf(stderr, "Couldn't allocate memory for the expressions!\n");
+        return EXIT_FAILURE;
+    }
+    int exit_status = EXIT_SUCCESS;
+    if ((argc == 4) && !strcmp(argv[1], "--generate")) {
+        const struct Shape *const shape = find_shape(argv[2]);
+        char *end = NULL;
+        const unsigned long long tokens = strtoull(argv[3], &end, 10);
+        if ((shape == NULL) || (end == argv[3]) || (*end != '\0')) {
+            exit_status = EXIT_FAILURE;
+        } else if (generate(shape, (size_t)tokens, expression)) {
+            fprintf(stderr, "An expression of %llu tokens would be longer than a line!\n", tokens);
+            exit_status = EXIT_FAILURE;
+        } else {
+            printf("%s\n", expression->text);
+        }
+    } else if ((argc == 3) && !strcmp(argv[1], "--shape")) {
+        const struct Shape *const shape = find_shape(argv[2]);
+        if (shape == NULL) {
+            exit_status = EXIT_FAILURE;
+        } else {
+            benchmark_shape(shape, expression);
+        }
+    } else if (argc == 1) {
+        for (size_t i = 0; i < SHAPES_QUANTITY; i++) {
+            benchmark_shape(&shapes[i], expression);
+        }
+    } else {
+        usage(argv[0]);
+        exit_status = EXIT_FAILURE;
+    }
+    free(expression);
+    return exit_status;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
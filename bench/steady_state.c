@@ -0,0 +1,285 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+// Verifies that the lines of the REPL and of --batch allocate no memory once
+// warmed up, run with "make check". This executable replaces malloc and the
+// other allocation functions of glibc, to count every call to the heap, the
+// ones of the C library included. The REPL is driven by interpret_session_line,
+// the function main calls for each line typed, and the batch pipeline by
+// run_batch, with the diagnostics written as by the interpreter
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "context.h"
+#include "data-structures/sized_string.h"
+#include "metrics.h"
+#include "printing.h"
+#include "result_output.h"
+#include "session.h"
+
+#ifndef __GLIBC__
+#error "The steady state check replaces the allocator of glibc, so it only runs on Linux"
+#endif
+
+#define STEADY_STATE_REPETITIONS 1000
+// The smaller batch fills twice the chunks of --batch (16 of 256 KiB), so that all of them have grown
+#define STEADY_STATE_BATCH_SIZE (8 * 1024 * 1024)
+#define STEADY_STATE_NULL_DEVICE "/dev/null"
+
+// Lines that succeed, warn and fail in each phase, written once per repetition
+static const char *const lines[] = {
+    "x = 3",
+    "x * 2 + sqrt(16) - max(1, 2, 3)",
+    "((1 + 2) * (3 + 4)) ^ 0.5 / hypot(x, 4)",
+    "",
+    "sqrt(-1)",
+    "undefined_name + 1",
+    "1 + # 2",
+    "(1 + 2",
+    "sin()",
+};
+
+//------------------------------------------------------------------------------
+// Allocator
+//------------------------------------------------------------------------------
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *pointer);
+
+// The workers of the batch allocate concurrently with the main thread
+static atomic_uint_fast64_t heap_calls;
+
+static inline void count_heap_call(void) {
+    atomic_fetch_add_explicit(&heap_calls, 1, memory_order_relaxed);
+}
+
+void *malloc(size_t size) {
+    count_heap_call();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    count_heap_call();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    count_heap_call();
+    return __libc_realloc(pointer, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    count_heap_call();
+    return __libc_memalign(alignment, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    count_heap_call();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+    count_heap_call();
+    void *const memory = __libc_memalign(alignment, size);
+    if (memory == NULL) {
+        return ENOMEM;
+    }
+    *pointer = memory;
+    return 0;
+}
+
+void free(void *pointer) {
+    __libc_free(pointer);
+}
+
+static inline uint64_t heap_calls_so_far(void) {
+    return atomic_load_explicit(&heap_calls, memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// REPL
+//------------------------------------------------------------------------------
+
+static void interpret_lines(struct Session *const session) {
+    for (size_t i = 0; i < (sizeof(lines) / sizeof(lines[0])); i++) {
+        interpret_session_line(session, create_string((char *)lines[i]));
+    }
+}
+
+// Once the lines have been interpreted, interpreting them again must not
+// allocate any memory. Returns true if found an allocation
+static bool check_session(struct Context *const ctx, const char *const name) {
+    struct Session session = create_session(ctx, NULL);
+    interpret_lines(&session);
+    const uint64_t warmed_up = heap_calls_so_far();
+    for (size_t repetition = 0; repetition < STEADY_STATE_REPETITIONS; repetition++) {
+        interpret_lines(&session);
+    }
+    const uint64_t calls = heap_calls_so_far() - warmed_up;
+    if (calls > 0) {
+        fprintf(stderr, "[Error] Interpreting the lines %d times in the REPL, %s, called the allocator %" PRIu64 " times after the warm up!\n", STEADY_STATE_REPETITIONS, name, calls);
+        return true;
+    }
+    fprintf(stderr, "The REPL, %s, allocates no memory per line\n", name);
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Batch
+//------------------------------------------------------------------------------
+
+// Writes the lines repeatedly, until the file has the requested size. Returns true if found an error
+static bool write_batch_file(const char *const file_name, const size_t size, size_t *const lines_quantity) {
+    FILE *const file = fopen(file_name, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "[Error] Couldn't create the file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    size_t written = 0;
+    *lines_quantity = 0;
+    while (written < size) {
+        for (size_t i = 0; i < (sizeof(lines) / sizeof(lines[0])); i++) {
+            const int length = fprintf(file, "%s\n", lines[i]);
+            written += (length > 0) ? (size_t)length : 0;
+        }
+        *lines_quantity += sizeof(lines) / sizeof(lines[0]);
+    }
+    return (fclose(file) != 0);
+}
+
+// Returns true if found an error
+static bool count_batch_calls(struct Context *const ctx, const char *const file_name, uint64_t *const calls) {
+    struct Result_Output output;
+    const uint64_t start = heap_calls_so_far();
+    if (open_result_output(&output, STEADY_STATE_NULL_DEVICE, &ctx->diagnostics)) {
+        return true;
+    }
+    run_batch(ctx, file_name, &output);
+    const bool error = close_result_output(&output);
+    *calls = heap_calls_so_far() - start;
+    return error;
+}
+
+// A batch twice as long must call the allocator as many times, because each
+// line reuses the memory of the chunks. Returns true if found an allocation
+static bool check_batch(struct Context *const ctx, const char *const file_name) {
+    size_t small_lines = 0;
+    size_t large_lines = 0;
+    uint64_t small_calls = 0;
+    uint64_t large_calls = 0;
+    // The first batch is the warm up
+    if (write_batch_file(file_name, STEADY_STATE_BATCH_SIZE, &small_lines) ||
+        count_batch_calls(ctx, file_name, &small_calls) ||
+        count_batch_calls(ctx, file_name, &small_calls) ||
+        write_batch_file(file_name, 2 * STEADY_STATE_BATCH_SIZE, &large_lines) ||
+        count_batch_calls(ctx, file_name, &large_calls)) {
+        remove(file_name);
+        return true;
+    }
+    remove(file_name);
+    if (large_calls != small_calls) {
+        fprintf(stderr, "[Error] A batch of %zu lines called the allocator %" PRIu64 " times, but one of %zu lines called it %" PRIu64 " times!\n", small_lines, small_calls, large_lines, large_calls);
+        return true;
+    }
+    fprintf(stderr, "The batch allocates no memory per line (%" PRIu64 " calls to the allocator for %zu or %zu lines)\n", small_calls, small_lines, large_lines);
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+
+int main(const int argc, const char *const argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "[Usage] %s temporary_file\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    // The results and the diagnostics are discarded, but still formatted
+    FILE *const null_device = fopen(STEADY_STATE_NULL_DEVICE, "wb");
+    if ((null_device == NULL) || (freopen(STEADY_STATE_NULL_DEVICE, "wb", stdout) == NULL)) {
+        fprintf(stderr, "[Error] Couldn't open \"%s\"!\n", STEADY_STATE_NULL_DEVICE);
+        return EXIT_FAILURE;
+    }
+    // The context is set up as in main, with the metrics always on
+    struct Context ctx;
+    create_context(&ctx, null_device);
+    struct Metrics metrics;
+    init_metrics(&metrics);
+    ctx.metrics = &metrics;
+    struct Diagnostic_Sink sink = create_diagnostic_sink(null_device, DIAGNOSTIC_FORMAT_TEXT);
+    ctx.diagnostics.sink = &sink;
+    int exit_status = EXIT_SUCCESS;
+    if (check_session(&ctx, "with the diagnostics sink") || check_batch(&ctx, argv[1])) {
+        exit_status = EXIT_FAILURE;
+    }
+    // Without a sink, as in the library, each message is written at once
+    ctx.diagnostics.sink = NULL;
+    if (check_session(&ctx, "without the diagnostics sink")) {
+        exit_status = EXIT_FAILURE;
+    }
+    destroy_context(&ctx);
+    destroy_diagnostic_sink(&sink);
+    fclose(null_device);
+    return exit_status;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
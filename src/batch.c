@@ -0,0 +1,700 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "batch.h"
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
+#include "data-structures/sized_string.h"
+#include "data-structures/spsc_ring.h"
+#include "journal.h"
+#include "lex.h"
+#include "metrics.h"
+#include "parser.h"
+#include "perf_counters.h"
+#include "platform.h"
+#include "printing.h"
+#include "result_output.h"
+#include "sampling_profiler.h"
+#include "slow_log.h"
+#include "timing.h"
+#include "trace.h"
+
+#define BATCH_CHUNK_SIZE (256 * 1024)
+// The reader and the evaluator also need a processor
+#define BATCH_MAX_WORKERS 7
+// Every chunk is in one of the rings, so they can never be full
+#define BATCH_MAX_CHUNKS SPSC_RING_CAPACITY
+// Attempts made on a full or empty ring before sleeping
+#define BATCH_SPIN_TRIES 64
+
+// Diagnostic found by a worker, which is reported when its line is evaluated
+struct Batch_Diagnostic {
+    size_t line;  // Index of the line in the chunk
+    struct Stored_Diagnostic diagnostic;
+};
+
+struct Batch_Line {
+    // Points to the text of the chunk, logged by --slow-log
+    struct String text;
+    size_t head_idx;
+    bool has_error;
+    bool lex_error;
+    // Every line is measured with --timing, --trace and --slow-log, otherwise only the
+    // ones sampled for the latency of the metrics
+    bool measured;
+    uint64_t lex_ns;
+    uint64_t parse_ns;
+};
+
+// Chunks are allocated once and recycled, so the buffers keep their capacity.
+// The names of the tokens point to the text, so it must outlive the trees
+struct Batch_Chunk {
+    char *text;
+    size_t size;
+    size_t capacity;
+    // Number in the file of the first line of the chunk, only counted with --trace and --profile
+    size_t first_line;
+    // Dynamic arrays filled by the workers
+    struct Batch_Line *lines;
+    struct Token_Node *nodes;
+    struct Batch_Diagnostic *diagnostics;
+};
+
+// Ring of chunks between two threads. The threads spin briefly while the
+// ring is empty or full, and then sleep until the other side changes it,
+// so a slow input doesn't keep a processor busy
+struct Chunk_Queue {
+    struct Spsc_Ring ring;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    // Number of threads sleeping on the condition
+    atomic_uint sleepers;
+};
+
+struct Batch_Worker {
+    pthread_t thread;
+    // Context with its own lexer and parser. Its variables are not used
+    struct Context ctx;
+    struct Batch_Chunk *chunk;
+    size_t line;
+    bool timed;
+    bool sampled;
+    // Opened by the worker itself, because the counters only count the thread that opened them
+    bool counted;
+    struct Perf_Counters perf;
+    struct Chunk_Queue input;
+    struct Chunk_Queue output;
+};
+
+struct Batch {
+    const char *file_name;
+    FILE *file;
+    struct Context *ctx;
+    struct Result_Output *output;
+    // Used to report the diagnostics with the location in the file
+    struct Diagnostics diagnostics;
+    size_t line;
+    // Set by the evaluator when the built-in function "exit" is called
+    atomic_bool stop;
+    int read_error;
+    // Partial line at the end of the last chunk read
+    char *pending;
+    size_t pending_size;
+    size_t pending_capacity;
+    struct Batch_Chunk chunks[BATCH_MAX_CHUNKS];
+    size_t chunks_quantity;
+    // Chunks given back by the evaluator to the reader
+    struct Chunk_Queue free_chunks;
+    size_t workers_quantity;
+    struct Batch_Worker workers[BATCH_MAX_WORKERS];
+};
+
+static void init_chunk_queue(struct Chunk_Queue *const queue) {
+    init_spsc_ring(&queue->ring);
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    atomic_init(&queue->sleepers, 0);
+}
+
+static void destroy_chunk_queue(struct Chunk_Queue *const queue) {
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->mutex);
+}
+
+// Wakes the other side after a chunk was pushed or popped
+static void notify_chunk_queue(struct Chunk_Queue *const queue) {
+    // Orders the change of the ring before the read of the sleepers, paired
+    // with the fence in wait_chunk_queue, so a wake up is never lost
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->sleepers, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&queue->mutex);
+        pthread_cond_broadcast(&queue->changed);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+}
+
+// Tries the operation a few times, and then sleeps until the other side changes the ring
+static void wait_chunk_queue(struct Chunk_Queue *const queue, bool (*const try_operation)(struct Chunk_Queue *const, void **const), void **const chunk) {
+    for (size_t i = 0; i < BATCH_SPIN_TRIES; i++) {
+        if (try_operation(queue, chunk)) {
+            return;
+        }
+        yield_processor();
+    }
+    pthread_mutex_lock(&queue->mutex);
+    atomic_fetch_add_explicit(&queue->sleepers, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (!try_operation(queue, chunk)) {
+        pthread_cond_wait(&queue->changed, &queue->mutex);
+    }
+    atomic_fetch_sub_explicit(&queue->sleepers, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+static bool try_push_chunk(struct Chunk_Queue *const queue, void **const chunk) {
+    return spsc_ring_try_push(&queue->ring, *chunk);
+}
+
+static bool try_pop_chunk(struct Chunk_Queue *const queue, void **const chunk) {
+    return spsc_ring_try_pop(&queue->ring, chunk);
+}
+
+static void push_chunk(struct Chunk_Queue *const queue, struct Batch_Chunk *const chunk) {
+    void *item = chunk;
+    wait_chunk_queue(queue, try_push_chunk, &item);
+    notify_chunk_queue(queue);
+}
+
+static struct Batch_Chunk *pop_chunk(struct Chunk_Queue *const queue) {
+    void *chunk = NULL;
+    wait_chunk_queue(queue, try_pop_chunk, &chunk);
+    notify_chunk_queue(queue);
+    return chunk;
+}
+
+static void *reallocate_buffer(void *const buffer, const size_t old_size, const size_t size) {
+    void *const new_buffer = tracked_realloc(MEMORY_FILE_BUFFERS, buffer, old_size, size);
+    if (new_buffer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the batch!\n");
+    }
+    return new_buffer;
+}
+
+// Fills the chunk with whole lines, and keeps the partial line that follows them.
+// Returns true at the end of the file
+static bool read_chunk(struct Batch *const batch, struct Batch_Chunk *const chunk) {
+    while (chunk->capacity <= batch->pending_size) {
+        chunk->text = reallocate_buffer(chunk->text, chunk->capacity, 2 * chunk->capacity);
+        chunk->capacity *= 2;
+    }
+    if (batch->pending_size > 0) {
+        memcpy(chunk->text, batch->pending, batch->pending_size);
+    }
+    chunk->size = batch->pending_size;
+    batch->pending_size = 0;
+    while (true) {
+        chunk->size += fread(&chunk->text[chunk->size], sizeof(char), chunk->capacity - chunk->size, batch->file);
+        if (chunk->size < chunk->capacity) {
+            if (ferror(batch->file)) {
+                batch->read_error = errno;
+            }
+            return true;
+        }
+        size_t end = chunk->size;
+        while ((end > 0) && (chunk->text[end - 1] != '\n')) {
+            end--;
+        }
+        if (end > 0) {
+            batch->pending_size = chunk->size - end;
+            if (batch->pending_capacity < batch->pending_size) {
+                batch->pending = reallocate_buffer(batch->pending, batch->pending_capacity, chunk->capacity);
+                batch->pending_capacity = chunk->capacity;
+            }
+            memcpy(batch->pending, &chunk->text[end], batch->pending_size);
+            chunk->size = end;
+            return false;
+        }
+        // The line doesn't fit in the chunk
+        chunk->text = reallocate_buffer(chunk->text, chunk->capacity, 2 * chunk->capacity);
+        chunk->capacity *= 2;
+    }
+}
+
+// The chunks are distributed to the workers in turns, so the evaluator
+// can restore their order by collecting them in the same turns
+static void *read_chunks(void *const arg) {
+    struct Batch *const batch = arg;
+    name_trace_thread("batch reader");
+    size_t sequence = 0;
+    size_t line_number = 1;
+    bool finished = false;
+    while (!finished && !atomic_load_explicit(&batch->stop, memory_order_relaxed)) {
+        struct Batch_Chunk *const chunk = pop_chunk(&batch->free_chunks);
+        const uint64_t start = monotonic_time_ns();
+        finished = read_chunk(batch, chunk);
+        if ((chunk->size == 0) && finished) {
+            break;
+        }
+        if (tracing() || sampling_profiler_running()) {
+            trace_event("read_chunk", "io", start, monotonic_time_ns() - start, line_number);
+            chunk->first_line = line_number;
+            for (const char *c = chunk->text; (c = memchr(c, '\n', (size_t)(&chunk->text[chunk->size] - c))) != NULL; c++) {
+                line_number++;
+            }
+        }
+        push_chunk(&batch->workers[sequence % batch->workers_quantity].input, chunk);
+        sequence++;
+    }
+    for (size_t i = 0; i < batch->workers_quantity; i++) {
+        push_chunk(&batch->workers[i].input, NULL);
+    }
+    return NULL;
+}
+
+static void collect_diagnostic(void *const user_data, const struct Diagnostic *const found) {
+    struct Batch_Worker *const worker = user_data;
+    struct Batch_Diagnostic diagnostic = {
+        .line = worker->line,
+    };
+    store_diagnostic(&diagnostic.diagnostic, found);
+    array_push(worker->chunk->diagnostics, diagnostic);
+    if (worker->chunk->diagnostics == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the batch!\n");
+    }
+}
+
+// Phases of the line being parsed by a worker
+struct Batch_Phases {
+    struct Batch_Worker *worker;
+    bool measured;
+    uint64_t lexed;
+    struct Perf_Sample counters[TIMING_PHASES + 1];
+};
+
+static void mark_lexed(void *const user_data) {
+    struct Batch_Phases *const phases = user_data;
+    struct Batch_Worker *const worker = phases->worker;
+    phases->lexed = phases->measured ? monotonic_time_ns() : 0;
+    if (worker->counted) {
+        read_perf_counters(&worker->perf, &phases->counters[TIMING_PARSE]);
+    }
+    sample_line_phase(worker->chunk->first_line + worker->line, TIMING_PARSE);
+}
+
+static void parse_chunk(struct Batch_Worker *const worker, struct Batch_Chunk *const chunk) {
+    struct Context *const ctx = &worker->ctx;
+    array_free_all(chunk->lines);
+    array_free_all(chunk->nodes);
+    array_free_all(chunk->diagnostics);
+    worker->chunk = chunk;
+    // All the trees of the chunk are stored in its own array of nodes
+    struct Token_Node *const nodes = ctx->parser.nodes;
+    ctx->parser.nodes = chunk->nodes;
+    size_t offset = 0;
+    for (worker->line = 0; offset < chunk->size; worker->line++) {
+        struct Batch_Phases phases = {
+            .worker = worker,
+            .measured = worker->timed || (worker->sampled && ((worker->line % METRICS_SAMPLING_INTERVAL) == 0)),
+        };
+        if (worker->counted) {
+            read_perf_counters(&worker->perf, &phases.counters[TIMING_LEX]);
+        }
+        sample_line_phase(chunk->first_line + worker->line, TIMING_LEX);
+        const uint64_t start = phases.measured ? monotonic_time_ns() : 0;
+        struct Parsed_Line parsed;
+        const enum Parse_Status status = parse_line(ctx, &ctx->parser, chunk->text, chunk->size, &offset, &parsed, mark_lexed, &phases);
+        const uint64_t parsed_ns = phases.measured ? monotonic_time_ns() : 0;
+        if (worker->counted) {
+            read_perf_counters(&worker->perf, &phases.counters[TIMING_EVALUATE]);
+        }
+        if (!parsed.is_lexed) {
+            // The parser didn't run
+            phases.lexed = parsed_ns;
+            phases.counters[TIMING_PARSE] = phases.counters[TIMING_EVALUATE];
+        }
+        const struct Batch_Line line = {
+            .text = create_sized_string((char *)parsed.text, (String_Length)((parsed.length > UINT16_MAX) ? UINT16_MAX : parsed.length)),
+            .head_idx = parsed.head_idx,
+            .has_error = (status == PARSE_ERROR),
+            .lex_error = !parsed.is_lexed,
+            .measured = phases.measured,
+            .lex_ns = phases.lexed - start,
+            .parse_ns = parsed_ns - phases.lexed,
+        };
+        if (worker->counted) {
+            // Only the totals are kept, the lines are counted by the evaluator
+            add_phase_counters(&worker->perf, TIMING_LEX, &phases.counters[TIMING_LEX], &phases.counters[TIMING_PARSE]);
+            add_phase_counters(&worker->perf, TIMING_PARSE, &phases.counters[TIMING_PARSE], &phases.counters[TIMING_EVALUATE]);
+        }
+        if (tracing()) {
+            const size_t line_number = chunk->first_line + worker->line;
+            trace_event(timing_phase_names[TIMING_LEX], "line", start, line.lex_ns, line_number);
+            trace_event(timing_phase_names[TIMING_PARSE], "line", start + line.lex_ns, line.parse_ns, line_number);
+        }
+        array_push(chunk->lines, line);
+        if (chunk->lines == NULL) {
+            print_crash_and_exit("Couldn't allocate memory for the batch!\n");
+        }
+    }
+    sample_outside_lines();
+    chunk->nodes = ctx->parser.nodes;
+    ctx->parser.nodes = nodes;
+}
+
+static void *parse_chunks(void *const arg) {
+    struct Batch_Worker *const worker = arg;
+    name_trace_thread("batch worker");
+    if (worker->counted) {
+        // If the evaluator could open the counters, the workers are expected to
+        worker->counted = !open_perf_counters(&worker->perf);
+    }
+    struct Batch_Chunk *chunk = NULL;
+    while ((chunk = pop_chunk(&worker->input)) != NULL) {
+        parse_chunk(worker, chunk);
+        push_chunk(&worker->output, chunk);
+    }
+    if (worker->counted) {
+        close_perf_counters(&worker->perf);
+    }
+    push_chunk(&worker->output, NULL);
+    return NULL;
+}
+
+static void report_diagnostic(struct Batch *const batch, const struct Diagnostic *const found) {
+    struct Diagnostic diagnostic = *found;
+    diagnostic.source = batch->file_name;
+    diagnostic.line = batch->line;
+    emit_diagnostic(&batch->diagnostics, &diagnostic);
+}
+
+static void report_evaluation_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    report_diagnostic(user_data, diagnostic);
+}
+
+static enum Line_Outcome line_outcome(const struct Parser *const parser, const struct Batch_Line *const line, const enum Evaluation_Status status) {
+    if (line->lex_error) {
+        return LINE_LEX_ERROR;
+    }
+    if (line->has_error) {
+        return LINE_PARSE_ERROR;
+    }
+    if (array_index_is_invalid(parser->nodes, line->head_idx)) {
+        return LINE_EMPTY;
+    }
+    return (status == Eval_Error) ? LINE_EVALUATION_ERROR : LINE_OK;
+}
+
+// Only the phases that ran are added to the latency of the metrics
+static void record_line_latency(struct Metrics *const metrics, const enum Line_Outcome outcome, const uint64_t ns[TIMING_PHASES]) {
+    record_phase_latency(metrics, TIMING_LEX, ns[TIMING_LEX]);
+    if (outcome != LINE_LEX_ERROR) {
+        record_phase_latency(metrics, TIMING_PARSE, ns[TIMING_PARSE]);
+    }
+    if ((outcome == LINE_OK) || (outcome == LINE_EVALUATION_ERROR)) {
+        record_phase_latency(metrics, TIMING_EVALUATE, ns[TIMING_EVALUATE]);
+    }
+    record_phase_latency(metrics, TIMING_PRINT, ns[TIMING_PRINT]);
+}
+
+// Same as the evaluation of a line in evaluate_chunk, but measuring the time
+// and the hardware counters of each phase, and tracing them
+static void evaluate_measured_line(struct Batch *const batch, struct Parser *const parser, const struct Batch_Line *const line) {
+    struct Context *const ctx = batch->ctx;
+    struct Perf_Sample counters[3];
+    if (ctx->perf_counters != NULL) {
+        read_perf_counters(ctx->perf_counters, &counters[0]);
+    }
+    const uint64_t start = monotonic_time_ns();
+    enum Evaluation_Status status = Eval_Error;
+    double result = NAN;
+    if (!line->has_error) {
+        status = Eval_OK;
+        result = evaluate(parser, line->head_idx, &status);
+    }
+    const uint64_t evaluated = monotonic_time_ns();
+    if (ctx->perf_counters != NULL) {
+        read_perf_counters(ctx->perf_counters, &counters[1]);
+    }
+    sample_line_phase(batch->line, TIMING_PRINT);
+    write_result(batch->output, status, result);
+    if (ctx->perf_counters != NULL) {
+        read_perf_counters(ctx->perf_counters, &counters[2]);
+        add_phase_counters(ctx->perf_counters, TIMING_EVALUATE, &counters[0], &counters[1]);
+        add_phase_counters(ctx->perf_counters, TIMING_PRINT, &counters[1], &counters[2]);
+        finish_line_counters(ctx->perf_counters);
+    }
+    const uint64_t ns[TIMING_PHASES] = {
+        [TIMING_LEX] = line->lex_ns,
+        [TIMING_PARSE] = line->parse_ns,
+        [TIMING_EVALUATE] = evaluated - start,
+        [TIMING_PRINT] = monotonic_time_ns() - evaluated,
+    };
+    if (ctx->timing != NULL) {
+        add_line_timing(ctx->timing, ns);
+    }
+    if (ctx->metrics != NULL) {
+        const enum Line_Outcome outcome = line_outcome(parser, line, status);
+        if (line->measured) {
+            record_line_latency(ctx->metrics, outcome, ns);
+        }
+        record_line_outcome(ctx->metrics, outcome);
+    }
+    if (slow_logging() && line->measured) {
+        log_slow_line(parser, line->head_idx, line->text, batch->line, ns);
+    }
+    if (tracing()) {
+        trace_event(timing_phase_names[TIMING_EVALUATE], "line", start, ns[TIMING_EVALUATE], batch->line);
+        trace_event(timing_phase_names[TIMING_PRINT], "line", evaluated, ns[TIMING_PRINT], batch->line);
+    }
+}
+
+static void evaluate_chunk(struct Batch *const batch, const struct Batch_Chunk *const chunk) {
+    struct Context *const ctx = batch->ctx;
+    // The trees are evaluated directly from the array of nodes of the chunk
+    struct Parser parser = ctx->parser;
+    parser.nodes = chunk->nodes;
+    size_t diagnostic_idx = 0;
+    for (size_t i = 0; i < array_size(chunk->lines); i++, batch->line++) {
+        for (; (diagnostic_idx < array_size(chunk->diagnostics)) && (chunk->diagnostics[diagnostic_idx].line == i); diagnostic_idx++) {
+            const struct Diagnostic diagnostic = stored_diagnostic(&chunk->diagnostics[diagnostic_idx].diagnostic);
+            report_diagnostic(batch, &diagnostic);
+        }
+        const struct Batch_Line line = chunk->lines[i];
+        sample_line_phase(batch->line, TIMING_EVALUATE);
+        if (line.measured || (ctx->perf_counters != NULL)) {
+            evaluate_measured_line(batch, &parser, &line);
+        } else {
+            enum Evaluation_Status status = Eval_Error;
+            double result = NAN;
+            if (!line.has_error) {
+                status = Eval_OK;
+                result = evaluate(&parser, line.head_idx, &status);
+            }
+            sample_line_phase(batch->line, TIMING_PRINT);
+            write_result(batch->output, status, result);
+            if (ctx->metrics != NULL) {
+                record_line_outcome(ctx->metrics, line_outcome(&parser, &line, status));
+            }
+        }
+        if ((ctx->actions & ACTION_EXIT) != 0) {
+            atomic_store_explicit(&batch->stop, true, memory_order_relaxed);
+            break;
+        }
+    }
+    sample_outside_lines();
+    // The journal is committed, the diagnostics and the metrics are written once per chunk instead of once per line
+    if (ctx->vars.journal != NULL) {
+        commit_journal(ctx->vars.journal);
+    }
+    flush_diagnostics(&batch->diagnostics);
+    if (ctx->metrics != NULL) {
+        write_metrics_periodically(&ctx->diagnostics, ctx->metrics, array_size(ctx->vars.list));
+    }
+}
+
+static void evaluate_chunks(struct Batch *const batch) {
+    batch->line = 1;
+    for (size_t sequence = 0;; sequence++) {
+        struct Batch_Chunk *const chunk = pop_chunk(&batch->workers[sequence % batch->workers_quantity].output);
+        if (chunk == NULL) {
+            break;
+        }
+        // After the exit, the chunks are only given back until the reader stops
+        if (!atomic_load_explicit(&batch->stop, memory_order_relaxed)) {
+            evaluate_chunk(batch, chunk);
+        }
+        push_chunk(&batch->free_chunks, chunk);
+    }
+}
+
+static void create_chunks(struct Batch *const batch) {
+    batch->chunks_quantity = 2 * batch->workers_quantity + 2;
+    if (batch->chunks_quantity > BATCH_MAX_CHUNKS) {
+        batch->chunks_quantity = BATCH_MAX_CHUNKS;
+    }
+    for (size_t i = 0; i < batch->chunks_quantity; i++) {
+        struct Batch_Chunk *const chunk = &batch->chunks[i];
+        *chunk = (struct Batch_Chunk){
+            .text = tracked_malloc(MEMORY_FILE_BUFFERS, BATCH_CHUNK_SIZE),
+            .capacity = BATCH_CHUNK_SIZE,
+            .lines = array_new(sizeof(struct Batch_Line), 1024),
+            .nodes = array_new(sizeof(struct Token_Node), 4096),
+            .diagnostics = array_new(sizeof(struct Batch_Diagnostic), 8),
+        };
+        if ((chunk->text == NULL) || (chunk->lines == NULL) || (chunk->nodes == NULL) || (chunk->diagnostics == NULL)) {
+            print_crash_and_exit("Couldn't allocate memory for the batch!\n");
+        }
+        spsc_ring_try_push(&batch->free_chunks.ring, chunk);
+    }
+}
+
+static void destroy_chunks(struct Batch *const batch) {
+    for (size_t i = 0; i < batch->chunks_quantity; i++) {
+        tracked_free(MEMORY_FILE_BUFFERS, batch->chunks[i].text, batch->chunks[i].capacity);
+        array_del(batch->chunks[i].lines);
+        array_del(batch->chunks[i].nodes);
+        array_del(batch->chunks[i].diagnostics);
+    }
+}
+
+// Returns the number of workers started
+static size_t start_workers(struct Batch *const batch) {
+    size_t quantity = number_of_processors();
+    quantity = (quantity > 2) ? (quantity - 2) : 1;
+    if (quantity > BATCH_MAX_WORKERS) {
+        quantity = BATCH_MAX_WORKERS;
+    }
+    size_t started = 0;
+    for (; started < quantity; started++) {
+        struct Batch_Worker *const worker = &batch->workers[started];
+        create_context(&worker->ctx, batch->ctx->diagnostics.file);
+        worker->ctx.diagnostics.callback = collect_diagnostic;
+        worker->ctx.diagnostics.user_data = worker;
+        worker->timed = (batch->ctx->timing != NULL) || tracing() || slow_logging();
+        worker->sampled = (batch->ctx->metrics != NULL);
+        worker->counted = (batch->ctx->perf_counters != NULL);
+        init_chunk_queue(&worker->input);
+        init_chunk_queue(&worker->output);
+        if (pthread_create(&worker->thread, NULL, parse_chunks, worker) != 0) {
+            destroy_chunk_queue(&worker->input);
+            destroy_chunk_queue(&worker->output);
+            destroy_context(&worker->ctx);
+            break;
+        }
+    }
+    return started;
+}
+
+static void stop_workers(struct Batch *const batch) {
+    for (size_t i = 0; i < batch->workers_quantity; i++) {
+        pthread_join(batch->workers[i].thread, NULL);
+        if (batch->workers[i].counted) {
+            merge_perf_counters(batch->ctx->perf_counters, &batch->workers[i].perf);
+        }
+        destroy_chunk_queue(&batch->workers[i].input);
+        destroy_chunk_queue(&batch->workers[i].output);
+        destroy_context(&batch->workers[i].ctx);
+    }
+}
+
+bool run_batch(struct Context *const ctx, const char *const file_name, struct Result_Output *const output) {
+    FILE *const file = fopen(file_name, "rb");
+    if (file == NULL) {
+        print_error(&ctx->diagnostics, "Couldn't open the file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    struct Batch *const batch = malloc(sizeof(struct Batch));
+    if (batch == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the batch!\n");
+    }
+    batch->file_name = file_name;
+    batch->file = file;
+    batch->ctx = ctx;
+    batch->output = output;
+    batch->diagnostics = ctx->diagnostics;
+    atomic_init(&batch->stop, false);
+    batch->read_error = 0;
+    batch->pending = NULL;
+    batch->pending_size = 0;
+    batch->pending_capacity = 0;
+    init_chunk_queue(&batch->free_chunks);
+    bool error = false;
+    batch->workers_quantity = start_workers(batch);
+    if (batch->workers_quantity == 0) {
+        print_error(&ctx->diagnostics, "Couldn't start the threads of the batch!\n");
+        destroy_chunk_queue(&batch->free_chunks);
+        free(batch);
+        fclose(file);
+        return true;
+    }
+    create_chunks(batch);
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, read_chunks, batch) != 0) {
+        print_error(&ctx->diagnostics, "Couldn't start the threads of the batch!\n");
+        for (size_t i = 0; i < batch->workers_quantity; i++) {
+            push_chunk(&batch->workers[i].input, NULL);
+        }
+        stop_workers(batch);
+        error = true;
+    } else {
+        const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+        ctx->diagnostics.callback = report_evaluation_diagnostic;
+        ctx->diagnostics.user_data = batch;
+        ctx->input.is_interactive = false;
+        evaluate_chunks(batch);
+        ctx->diagnostics = previous_diagnostics;
+        pthread_join(reader, NULL);
+        stop_workers(batch);
+        if (batch->read_error != 0) {
+            print_error(&ctx->diagnostics, "Couldn't read the file \"%s\", because of the following error: %s\n", file_name, strerror(batch->read_error));
+            error = true;
+        }
+    }
+    destroy_chunks(batch);
+    destroy_chunk_queue(&batch->free_chunks);
+    tracked_free(MEMORY_FILE_BUFFERS, batch->pending, batch->pending_capacity);
+    free(batch);
+    fclose(file);
+    return error;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,157 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "benchmark.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+
+#define BENCHMARK_MAX_SAMPLES 1000
+
+static size_t count_nodes(const struct Parser *const parser, const size_t node_idx) {
+    if (array_index_is_invalid(parser->nodes, node_idx)) {
+        return 0;
+    }
+    return 1 + count_nodes(parser, parser->nodes[node_idx].left_idx) + count_nodes(parser, parser->nodes[node_idx].right_idx);
+}
+
+static void ignore_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    (void)user_data;
+    (void)diagnostic;
+}
+
+static int compare_doubles(const void *const a, const void *const b) {
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+bool benchmark_tree(struct Parser *const parser, const size_t head_idx, const uint64_t iterations, struct Benchmark *const benchmark) {
+    struct Context *const ctx = parser->ctx;
+    enum Evaluation_Status status = Eval_OK;
+    const double result = evaluate(parser, head_idx, &status);
+    if ((status == Eval_Error) || (iterations == 0)) {
+        return true;
+    }
+    const size_t samples = (iterations < BENCHMARK_MAX_SAMPLES) ? (size_t)iterations : BENCHMARK_MAX_SAMPLES;
+    double *const sample_ns = malloc(samples * sizeof(double));
+    if (sample_ns == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the benchmark!\n");
+    }
+    // The warnings were already reported by the first evaluation
+    const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+    ctx->diagnostics.callback = ignore_diagnostic;
+    uint64_t total = 0;
+    for (size_t sample = 0; sample < samples; sample++) {
+        // The remainder of the division is spread over the first samples
+        const uint64_t length = (iterations / samples) + ((sample < (iterations % samples)) ? 1 : 0);
+        const uint64_t start = monotonic_time_ns();
+        for (uint64_t i = 0; i < length; i++) {
+            status = Eval_OK;
+            evaluate(parser, head_idx, &status);
+        }
+        const uint64_t elapsed = monotonic_time_ns() - start;
+        sample_ns[sample] = (double)elapsed / (double)length;
+        total += elapsed;
+    }
+    ctx->diagnostics = previous_diagnostics;
+    qsort(sample_ns, samples, sizeof(double), compare_doubles);
+    // Nearest rank
+    const size_t p99_rank = (99 * samples + 99) / 100;
+    *benchmark = (struct Benchmark){
+        .iterations = iterations,
+        .nodes = count_nodes(parser, head_idx),
+        .samples = samples,
+        .ns_per_evaluation = (double)total / (double)iterations,
+        .min_ns = sample_ns[0],
+        .median_ns = sample_ns[samples / 2],
+        .p99_ns = sample_ns[p99_rank - 1],
+        .result = result,
+    };
+    free(sample_ns);
+    return false;
+}
+
+void print_benchmark(const struct Benchmark *const benchmark) {
+    printf("Evaluated %" PRIu64 " times an expression of %zu AST nodes, resulting in %lg\n",
+           benchmark->iterations, benchmark->nodes, benchmark->result);
+    printf("%.3lf ns/eval (min %.3lf, median %.3lf, p99 %.3lf, over %zu samples)\n",
+           benchmark->ns_per_evaluation, benchmark->min_ns, benchmark->median_ns, benchmark->p99_ns, benchmark->samples);
+}
+
+bool benchmark_expression(struct Context *const ctx, const struct String expression, const uint64_t iterations) {
+    array_free_all(ctx->parser.nodes);
+    struct Parsed_Line parsed;
+    const enum Parse_Status status = parse_string(ctx, &ctx->parser, expression, &parsed, NULL, NULL);
+    if (status != PARSE_OK) {
+        if (status == PARSE_EMPTY) {
+            print_error(&ctx->diagnostics, "There is no expression to benchmark!\n");
+        }
+        return true;
+    }
+    struct Benchmark benchmark;
+    if (benchmark_tree(&ctx->parser, parsed.head_idx, iterations, &benchmark)) {
+        return true;
+    }
+    print_benchmark(&benchmark);
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
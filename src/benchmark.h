@@ -0,0 +1,96 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __BENCHMARK
+#define __BENCHMARK
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "context.h"
+#include "data-structures/sized_string.h"
+#include "parser.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+#define BENCHMARK_DEFAULT_ITERATIONS 1000000
+
+struct Benchmark {
+    uint64_t iterations;
+    // Number of nodes of the abstract syntax tree evaluated
+    size_t nodes;
+    // The iterations are split in samples, each one timed as a whole,
+    // so that reading the clock doesn't dominate short expressions
+    size_t samples;
+    double ns_per_evaluation;
+    // Distribution of the average time of an evaluation in each sample
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+    double result;
+};
+
+// Evaluates the tree repeatedly through evaluate(). The diagnostics are only
+// reported by the first evaluation, which is not timed.
+// Returns true if found an error
+bool benchmark_tree(struct Parser *const parser, const size_t head_idx, const uint64_t iterations, struct Benchmark *const benchmark)
+    __attribute__((nonnull));
+void print_benchmark(const struct Benchmark *const benchmark)
+    __attribute__((nonnull));
+// Parses the expression once and benchmarks it. Returns true if found an error
+bool benchmark_expression(struct Context *const ctx, const struct String expression, const uint64_t iterations)
+    __attribute__((nonnull));
+
+#endif  // __BENCHMARK
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,213 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "context.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "input_stream.h"
+#include "lex.h"
+#include "metrics.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+#include "slow_log.h"
+#include "timing.h"
+#include "variables.h"
+
+void create_context(struct Context *const ctx, FILE *const diagnostics_file) {
+    ctx->diagnostics = create_diagnostics(diagnostics_file);
+    ctx->lexer = create_lex(64, &ctx->diagnostics);
+    ctx->vars = create_variables(64, &ctx->diagnostics);
+    ctx->parser = create_parser(ctx, 1024);
+    ctx->input = create_input_stream(&ctx->diagnostics);
+    ctx->actions = 0;
+    ctx->timing = NULL;
+    ctx->perf_counters = NULL;
+    ctx->metrics = NULL;
+}
+
+void destroy_context(struct Context *const ctx) {
+    destroy_lex(&ctx->lexer);
+    destroy_variables(&ctx->vars);
+    destroy_parser(&ctx->parser);
+}
+
+enum Parse_Status parse_string(struct Context *const ctx, struct Parser *const parser, const struct String text,
+                               struct Parsed_Line *const line, const Lexed_Callback lexed, void *const user_data) {
+    *line = (struct Parsed_Line){
+        .text = text.data,
+        .length = text.length,
+        .is_lexed = false,
+        .head_idx = SIZE_MAX,
+    };
+    if (lex(&ctx->lexer, text)) {
+        return PARSE_ERROR;
+    }
+    line->is_lexed = true;
+    if (lexed != NULL) {
+        lexed(user_data);
+    }
+    const size_t head_idx = parse_append(parser);
+    if (array_index_is_invalid(parser->nodes, head_idx)) {
+        // parse only returns an invalid node for an empty line or an invalid expression
+        return (array_size(ctx->lexer.tokens) == 0) ? PARSE_EMPTY : PARSE_ERROR;
+    }
+    line->head_idx = head_idx;
+    return PARSE_OK;
+}
+
+enum Parse_Status parse_line(struct Context *const ctx, struct Parser *const parser, const char *const text, const size_t size, size_t *const offset,
+                             struct Parsed_Line *const line, const Lexed_Callback lexed, void *const user_data) {
+    const char *const begin = &text[*offset];
+    const char *const new_line = memchr(begin, '\n', size - *offset);
+    size_t length = (new_line == NULL) ? (size - *offset) : (size_t)(new_line - begin);
+    *offset = (new_line == NULL) ? size : (*offset + length + 1);
+    if ((length > 0) && (begin[length - 1] == '\r')) {
+        length--;
+    }
+    if (length > UINT16_MAX) {
+        *line = (struct Parsed_Line){
+            .text = begin,
+            .length = length,
+            .is_lexed = false,
+            .head_idx = SIZE_MAX,
+        };
+        print_error(&ctx->diagnostics, "The line is too long!\n");
+        return PARSE_ERROR;
+    }
+    return parse_string(ctx, parser, create_sized_string((char *)begin, (String_Length)length), line, lexed, user_data);
+}
+
+static enum Evaluation_Status run_line(struct Context *const ctx, const struct String line, double *const result) {
+    array_free_all(ctx->parser.nodes);
+    struct Parsed_Line parsed;
+    const enum Parse_Status parse_status = parse_string(ctx, &ctx->parser, line, &parsed, NULL, NULL);
+    if (parse_status != PARSE_OK) {
+        return (parse_status == PARSE_EMPTY) ? Eval_Dont_Print : Eval_Error;
+    }
+    enum Evaluation_Status status = Eval_OK;
+    const double value = evaluate(&ctx->parser, parsed.head_idx, &status);
+    if (status == Eval_OK) {
+        *result = value;
+    }
+    return status;
+}
+
+// Only the phases that ran are added to the latency of the metrics
+static void record_line_metrics(struct Context *const ctx, const enum Line_Outcome outcome, const uint64_t ns[TIMING_PHASES]) {
+    struct Metrics *const metrics = ctx->metrics;
+    record_phase_latency(metrics, TIMING_LEX, ns[TIMING_LEX]);
+    if (outcome != LINE_LEX_ERROR) {
+        record_phase_latency(metrics, TIMING_PARSE, ns[TIMING_PARSE]);
+    }
+    if ((outcome == LINE_OK) || (outcome == LINE_EVALUATION_ERROR)) {
+        record_phase_latency(metrics, TIMING_EVALUATE, ns[TIMING_EVALUATE]);
+    }
+    record_line_outcome(metrics, outcome);
+    write_metrics_periodically(&ctx->diagnostics, metrics, array_size(ctx->vars.list));
+}
+
+static void mark_time(void *const user_data) {
+    *(uint64_t *)user_data = monotonic_time_ns();
+}
+
+// Same as run_line, but measuring each phase for the metrics and --slow-log
+static enum Evaluation_Status run_measured_line(struct Context *const ctx, const struct String line, double *const result) {
+    uint64_t ns[TIMING_PHASES] = {0};
+    enum Evaluation_Status status = Eval_Error;
+    enum Line_Outcome outcome = LINE_LEX_ERROR;
+    const uint64_t lex_start = monotonic_time_ns();
+    uint64_t parse_start = 0;
+    array_free_all(ctx->parser.nodes);
+    struct Parsed_Line parsed;
+    const enum Parse_Status parse_status = parse_string(ctx, &ctx->parser, line, &parsed, mark_time, &parse_start);
+    const uint64_t evaluate_start = monotonic_time_ns();
+    if (!parsed.is_lexed) {
+        ns[TIMING_LEX] = evaluate_start - lex_start;
+    } else {
+        ns[TIMING_LEX] = parse_start - lex_start;
+        ns[TIMING_PARSE] = evaluate_start - parse_start;
+        if (parse_status != PARSE_OK) {
+            const bool empty = (parse_status == PARSE_EMPTY);
+            status = empty ? Eval_Dont_Print : Eval_Error;
+            outcome = empty ? LINE_EMPTY : LINE_PARSE_ERROR;
+        } else {
+            status = Eval_OK;
+            const double value = evaluate(&ctx->parser, parsed.head_idx, &status);
+            ns[TIMING_EVALUATE] = monotonic_time_ns() - evaluate_start;
+            outcome = (status == Eval_Error) ? LINE_EVALUATION_ERROR : LINE_OK;
+            if (status == Eval_OK) {
+                *result = value;
+            }
+        }
+    }
+    if (ctx->metrics != NULL) {
+        record_line_metrics(ctx, outcome, ns);
+    }
+    if (slow_logging()) {
+        log_slow_line(&ctx->parser, parsed.head_idx, line, 0, ns);
+    }
+    return status;
+}
+
+enum Evaluation_Status evaluate_line(struct Context *const ctx, const struct String line, double *const result) {
+    if ((ctx->metrics == NULL) && !slow_logging()) {
+        return run_line(ctx, line, result);
+    }
+    return run_measured_line(ctx, line, result);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
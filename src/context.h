@@ -0,0 +1,146 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __CONTEXT
+#define __CONTEXT
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "input_stream.h"
+#include "lex.h"
+#include "metrics.h"
+#include "parser.h"
+#include "perf_counters.h"
+#include "printing.h"
+#include "timing.h"
+#include "variables.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+enum Actions {
+    ACTION_EXIT = 1,
+    ACTION_PRINT_TOKENS = 2,
+    ACTION_PRINT_TREE = 4,
+    ACTION_PRINT_GRAPH = 8,
+    ACTION_PRINT_VARIABLES = 16,
+    ACTION_PRINT_LINES = 32,
+};
+
+// Everything an interpreter needs. There is no global mutable state, so
+// different contexts can be used concurrently by different threads.
+// The components point to each other, so a context can't be moved after created
+struct Context {
+    struct Diagnostics diagnostics;
+    struct Lexer lexer;
+    struct Variables vars;
+    struct Parser parser;
+    struct Input_Stream input;
+    // Set by the command line arguments and by the built-in function "exit"
+    enum Actions actions;
+    // Time spent in each phase of the lines, only measured if not NULL
+    struct Timing *timing;
+    // Hardware counters of each phase of the lines, only read if not NULL
+    struct Perf_Counters *perf_counters;
+    // Counters and latency of the lines, kept by the command line interpreter
+    struct Metrics *metrics;
+};
+
+// The diagnostics are printed to the file until a callback is set
+void create_context(struct Context *const ctx, FILE *const diagnostics_file)
+    __attribute__((nonnull));
+void destroy_context(struct Context *const ctx)
+    __attribute__((nonnull));
+
+enum Parse_Status {
+    PARSE_OK,
+    PARSE_EMPTY,
+    PARSE_ERROR,
+};
+
+// Line read by parse_string or parse_line
+struct Parsed_Line {
+    // Text of the line, without the new line characters
+    const char *text;
+    size_t length;
+    // The lexer succeeded, so an error was found by the parser
+    bool is_lexed;
+    // Root of the tree in the nodes of the parser, or SIZE_MAX if the status isn't PARSE_OK
+    size_t head_idx;
+};
+
+// Called by parse_string between the lexer and the parser, so that each phase can be measured
+typedef void (*Lexed_Callback)(void *const user_data);
+
+// Lexes and parses the text, appending the tree to the nodes of the parser, which
+// may be a copy of the parser of the context with its own nodes. The callback is optional
+enum Parse_Status parse_string(struct Context *const ctx, struct Parser *const parser, const struct String text,
+                               struct Parsed_Line *const line, const Lexed_Callback lexed, void *const user_data)
+    __attribute__((nonnull(1, 2, 4)));
+// Same as parse_string, for the line that begins at the offset of the text, which ends
+// at the next new line (ignoring a carriage return before it) or at the end of the
+// text. The offset is moved to the beginning of the next line. Lines longer than the
+// longest String are errors
+enum Parse_Status parse_line(struct Context *const ctx, struct Parser *const parser, const char *const text, const size_t size, size_t *const offset,
+                             struct Parsed_Line *const line, const Lexed_Callback lexed, void *const user_data)
+    __attribute__((nonnull(1, 2, 3, 5, 6)));
+
+// Runs the lexer, the parser and the evaluation of a line. Lexical and syntax
+// errors are reported as Eval_Error, and empty lines as Eval_Dont_Print.
+// The result is only written when the status is Eval_OK
+enum Evaluation_Status evaluate_line(struct Context *const ctx, const struct String line, double *const result)
+    __attribute__((nonnull));
+
+#endif  // __CONTEXT
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,217 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "coprocess.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/sized_string.h"
+#include "journal.h"
+#include "platform.h"
+#include "printing.h"
+
+// Requests can't be longer than the longest String, plus the identifier
+#define COPROCESS_BUFFER_SIZE (2 * (UINT16_MAX + 1))
+#define COPROCESS_OUTPUT_BUFFER_SIZE (1024 * 1024)
+// Only the first diagnostics of each request are sent
+#define COPROCESS_MAX_DIAGNOSTICS 8
+
+struct Coprocess {
+    FILE *output;
+    size_t diagnostics_count;
+    struct Stored_Diagnostic diagnostics[COPROCESS_MAX_DIAGNOSTICS];
+    // Is ignoring the rest of a request that didn't fit in the buffer?
+    bool discarding;
+    size_t used;
+    char input[COPROCESS_BUFFER_SIZE];
+};
+
+static void collect_diagnostic(void *const user_data, const struct Diagnostic *const found) {
+    struct Coprocess *const coprocess = user_data;
+    if (coprocess->diagnostics_count >= COPROCESS_MAX_DIAGNOSTICS) {
+        return;
+    }
+    struct Stored_Diagnostic *const diagnostic = &coprocess->diagnostics[coprocess->diagnostics_count++];
+    store_diagnostic(diagnostic, found);
+    // A message must fit in a single line of the protocol
+    for (char *c = diagnostic->message; *c != '\0'; c++) {
+        if ((*c == '\n') || (*c == '\r')) {
+            *c = ' ';
+        }
+    }
+}
+
+static void reply_request(struct Coprocess *const coprocess, struct Context *const ctx, const char *const data, size_t length) {
+    if ((length > 0) && (data[length - 1] == '\r')) {
+        length--;
+    }
+    // Skip the blank lines between requests
+    size_t begin = 0;
+    while ((begin < length) && ((data[begin] == ' ') || (data[begin] == '\t'))) {
+        begin++;
+    }
+    if (begin == length) {
+        return;
+    }
+    size_t id_end = begin;
+    while ((id_end < length) && (data[id_end] != ' ') && (data[id_end] != '\t')) {
+        id_end++;
+    }
+    const int id_length = (int)(id_end - begin);
+    const char *const id = &data[begin];
+    coprocess->diagnostics_count = 0;
+    double result = 0.0;
+    enum Evaluation_Status status = Eval_Error;
+    // The columns of the diagnostics are relative to the beginning of the expression
+    size_t expression_begin = id_end;
+    while ((expression_begin < length) && ((data[expression_begin] == ' ') || (data[expression_begin] == '\t'))) {
+        expression_begin++;
+    }
+    const size_t expression_length = length - expression_begin;
+    if (expression_length > UINT16_MAX) {
+        print_error(&ctx->diagnostics, "The expression is too long!\n");
+    } else {
+        status = evaluate_line(ctx, create_sized_string((char *)&data[expression_begin], (String_Length)expression_length), &result);
+        if (ctx->vars.journal != NULL) {
+            commit_journal(ctx->vars.journal);
+        }
+    }
+    switch (status) {
+    case Eval_OK:
+        fprintf(coprocess->output, "%.*s OK %.17g %zu\n", id_length, id, result, coprocess->diagnostics_count);
+        break;
+    case Eval_Dont_Print:
+        fprintf(coprocess->output, "%.*s NONE - %zu\n", id_length, id, coprocess->diagnostics_count);
+        break;
+    case Eval_Error:
+        fprintf(coprocess->output, "%.*s ERROR - %zu\n", id_length, id, coprocess->diagnostics_count);
+        break;
+    }
+    for (size_t i = 0; i < coprocess->diagnostics_count; i++) {
+        const struct Stored_Diagnostic *const diagnostic = &coprocess->diagnostics[i];
+        const char *const level = (diagnostic->level == DIAGNOSTIC_ERROR) ? "error" : "warning";
+        if (diagnostic->column == NO_DIAGNOSTIC_COLUMN) {
+            fprintf(coprocess->output, "%s - %s\n", level, diagnostic->message);
+        } else {
+            fprintf(coprocess->output, "%s %zu %s\n", level, diagnostic->column, diagnostic->message);
+        }
+    }
+}
+
+bool run_coprocess(struct Context *const ctx, FILE *const output) {
+    struct Coprocess *const coprocess = malloc(sizeof(struct Coprocess));
+    if (coprocess == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the coprocess!\n");
+    }
+    coprocess->output = output;
+    // The replies are only flushed explicitly, after each batch of requests
+    setvbuf(coprocess->output, NULL, _IOFBF, COPROCESS_OUTPUT_BUFFER_SIZE);
+    coprocess->used = 0;
+    coprocess->discarding = false;
+    const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+    ctx->diagnostics.callback = collect_diagnostic;
+    ctx->diagnostics.user_data = coprocess;
+    ctx->input.is_interactive = false;
+    bool finished = false;
+    while (!finished && ((ctx->actions & ACTION_EXIT) == 0)) {
+        const size_t capacity = COPROCESS_BUFFER_SIZE - coprocess->used;
+        const size_t received = read_from_stdin(&coprocess->input[coprocess->used], capacity);
+        if (received == 0) {
+            // The last request may not end with a new line
+            finished = true;
+            if ((coprocess->used > 0) && !coprocess->discarding) {
+                reply_request(coprocess, ctx, coprocess->input, coprocess->used);
+                coprocess->used = 0;
+            }
+        }
+        const size_t previous = coprocess->used;
+        coprocess->used += received;
+        size_t begin = 0;
+        const char *new_line = memchr(&coprocess->input[previous], '\n', coprocess->used - previous);
+        if (coprocess->discarding) {
+            if (new_line == NULL) {
+                coprocess->used = 0;
+                continue;
+            }
+            begin = (size_t)(new_line - coprocess->input) + 1;
+            new_line = memchr(&coprocess->input[begin], '\n', coprocess->used - begin);
+            coprocess->discarding = false;
+        }
+        while ((new_line != NULL) && ((ctx->actions & ACTION_EXIT) == 0)) {
+            const size_t end = (size_t)(new_line - coprocess->input);
+            reply_request(coprocess, ctx, &coprocess->input[begin], end - begin);
+            begin = end + 1;
+            new_line = memchr(&coprocess->input[begin], '\n', coprocess->used - begin);
+        }
+        coprocess->used -= begin;
+        memmove(coprocess->input, &coprocess->input[begin], coprocess->used);
+        if (coprocess->used == COPROCESS_BUFFER_SIZE) {
+            // The request can't be answered, and its identifier is unknown
+            fprintf(coprocess->output, "- ERROR - 1\nerror - The request is too long\n");
+            coprocess->used = 0;
+            coprocess->discarding = true;
+        }
+        // A short read drained the input, so the next one may wait: the changes are flushed before the replies reporting them
+        if ((received < capacity) && (ctx->vars.journal != NULL)) {
+            flush_journal(ctx->vars.journal);
+        }
+        fflush(coprocess->output);
+    }
+    ctx->diagnostics = previous_diagnostics;
+    const bool error = (ferror(coprocess->output) != 0);
+    free(coprocess);
+    return error;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -44,7 +44,7 @@
 #define array_size(array)     ((size_t *)(array))[-1]
 #define array_capacity(array) ((size_t *)(array))[-2]
 
-#define array_del(array) free((void *)((char *)(array) - HEADER_SIZE))
+#define array_del(array) _array_del((array), sizeof(*(array)))
 #define array_free_all(array) (array_size(array) = 0)
 
 #define array_resize(array, new_capacity) \
@@ -90,6 +90,8 @@
 void *array_new(size_t base_size, size_t initial_capacity) __attribute__((warn_unused_result));
 // This function shouldn't be called directly, insted use the macro array_resize
 void *_array_resize(void *array, size_t base_size, size_t new_capacity) __attribute__((warn_unused_result));
+// This function shouldn't be called directly, insted use the macro array_del
+void _array_del(void *array, size_t base_size);
 
 #endif  // __DYNAMIC_ARRAY
 
@@ -101,8 +103,11 @@ void *_array_resize(void *array, size_t base_size, size_t new_capacity) __attrib
 
 #include <stdlib.h>
 
+// The memory of the arrays is accounted in memory_stats.h
+#include "memory_stats.h"
+
 void *array_new(size_t base_size, size_t initial_capacity) {
-    void *p = malloc(initial_capacity * base_size + HEADER_SIZE);
+    void *p = tracked_malloc(MEMORY_ARRAYS, initial_capacity * base_size + HEADER_SIZE);
     if (p == NULL) {
         return NULL;
     }
@@ -115,9 +120,10 @@ void *array_new(size_t base_size, size_t initial_capacity) {
 // This function shouldn't be called directly, insted use the macro array_resize
 void *_array_resize(void *array, size_t base_size, size_t new_capacity) {
     void *p = ((char *)array - HEADER_SIZE);
-    void *new_p = realloc(p, new_capacity * base_size + HEADER_SIZE);
+    const size_t old_size = array_capacity(array) * base_size + HEADER_SIZE;
+    void *new_p = tracked_realloc(MEMORY_ARRAYS, p, old_size, new_capacity * base_size + HEADER_SIZE);
     if (new_p == NULL) {
-        free(p);
+        tracked_free(MEMORY_ARRAYS, p, old_size);
         return NULL;
     }
     void *new_array = (char *)new_p + HEADER_SIZE;
@@ -125,6 +131,11 @@ void *_array_resize(void *array, size_t base_size, size_t new_capacity) {
     return(new_array);
 }
 
+// This function shouldn't be called directly, insted use the macro array_del
+void _array_del(void *array, size_t base_size) {
+    tracked_free(MEMORY_ARRAYS, (char *)array - HEADER_SIZE, array_capacity(array) * base_size + HEADER_SIZE);
+}
+
 #endif // DYNAMIC_ARRAY_IMPLEMENTATION
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "histogram.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+void init_histogram(struct Histogram *const histogram) {
+    memset(histogram, 0, sizeof(struct Histogram));
+    histogram->min = UINT64_MAX;
+}
+
+// Index of the most significant bit set, which must exist
+static unsigned int highest_bit(uint64_t value) {
+    unsigned int bit = 0;
+    for (unsigned int shift = 32; shift > 0; shift /= 2) {
+        if ((value >> shift) != 0) {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+static size_t bucket_index(const uint64_t value) {
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return (size_t)value;
+    }
+    // The bits below the most significant one select the sub-bucket
+    const unsigned int exponent = highest_bit(value);
+    const unsigned int shift = exponent - HISTOGRAM_SUB_BUCKET_BITS;
+    const size_t sub_bucket = (size_t)(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+    return HISTOGRAM_SUB_BUCKETS + (shift * HISTOGRAM_SUB_BUCKETS) + sub_bucket;
+}
+
+// Returns the middle of the range of values recorded in the bucket
+static uint64_t bucket_value(const size_t index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    const size_t shift = (index - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS;
+    const size_t sub_bucket = (index - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+    const uint64_t lowest = (uint64_t)(HISTOGRAM_SUB_BUCKETS + sub_bucket) << shift;
+    return lowest + (((uint64_t)1 << shift) / 2);
+}
+
+void histogram_record(struct Histogram *const histogram, const uint64_t value) {
+    histogram->buckets[bucket_index(value)]++;
+    histogram->count++;
+    histogram->sum += value;
+    if (value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+uint64_t histogram_percentile(const struct Histogram *const histogram, const double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)ceil((percentile / 100.0) * (double)histogram->count);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            // The exact extremes are known, so they bound the approximated value
+            const uint64_t value = bucket_value(i);
+            return (value < histogram->min) ? histogram->min : ((value > histogram->max) ? histogram->max : value);
+        }
+    }
+    return histogram->max;
+}
+
+double histogram_mean(const struct Histogram *const histogram) {
+    return (histogram->count == 0) ? 0.0 : ((double)histogram->sum / (double)histogram->count);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,162 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "memory_stats.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const char *const memory_category_names[MEMORY_CATEGORIES] = {
+    [MEMORY_ARRAYS] = "arrays",
+    [MEMORY_VARIABLE_NAMES] = "variable names",
+    [MEMORY_FILE_BUFFERS] = "file buffers",
+};
+
+struct Memory_Counters {
+    atomic_size_t current_bytes;
+    atomic_size_t peak_bytes;
+    atomic_uint_fast64_t allocations;
+    atomic_uint_fast64_t reallocations;
+    atomic_uint_fast64_t frees;
+    atomic_uint_fast64_t copied_bytes;
+};
+
+static struct Memory_Counters counters[MEMORY_CATEGORIES];
+
+static void add_bytes(struct Memory_Counters *const category, const size_t size) {
+    const size_t current = atomic_fetch_add_explicit(&category->current_bytes, size, memory_order_relaxed) + size;
+    size_t peak = atomic_load_explicit(&category->peak_bytes, memory_order_relaxed);
+    while ((current > peak) && !atomic_compare_exchange_weak_explicit(&category->peak_bytes, &peak, current, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void subtract_bytes(struct Memory_Counters *const category, const size_t size) {
+    atomic_fetch_sub_explicit(&category->current_bytes, size, memory_order_relaxed);
+}
+
+void track_allocation(const enum Memory_Category category, const size_t size) {
+    atomic_fetch_add_explicit(&counters[category].allocations, 1, memory_order_relaxed);
+    add_bytes(&counters[category], size);
+}
+
+void *tracked_malloc(const enum Memory_Category category, const size_t size) {
+    void *const pointer = malloc(size);
+    if (pointer != NULL) {
+        track_allocation(category, size);
+    }
+    return pointer;
+}
+
+void *tracked_realloc(const enum Memory_Category category, void *const pointer, const size_t old_size, const size_t new_size) {
+    if (pointer == NULL) {
+        return tracked_malloc(category, new_size);
+    }
+    // The old pointer can't be used after realloc, so its address is saved before
+    const uintptr_t old_address = (uintptr_t)pointer;
+    void *const new_pointer = realloc(pointer, new_size);
+    if (new_pointer == NULL) {
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&counters[category].reallocations, 1, memory_order_relaxed);
+    if ((uintptr_t)new_pointer != old_address) {
+        atomic_fetch_add_explicit(&counters[category].copied_bytes, (old_size < new_size) ? old_size : new_size, memory_order_relaxed);
+    }
+    if (new_size >= old_size) {
+        add_bytes(&counters[category], new_size - old_size);
+    } else {
+        subtract_bytes(&counters[category], old_size - new_size);
+    }
+    return new_pointer;
+}
+
+void tracked_free(const enum Memory_Category category, void *const pointer, const size_t size) {
+    if (pointer == NULL) {
+        return;
+    }
+    free(pointer);
+    atomic_fetch_add_explicit(&counters[category].frees, 1, memory_order_relaxed);
+    subtract_bytes(&counters[category], size);
+}
+
+struct Memory_Usage get_memory_usage(const enum Memory_Category category) {
+    return (struct Memory_Usage){
+        .current_bytes = atomic_load_explicit(&counters[category].current_bytes, memory_order_relaxed),
+        .peak_bytes = atomic_load_explicit(&counters[category].peak_bytes, memory_order_relaxed),
+        .allocations = atomic_load_explicit(&counters[category].allocations, memory_order_relaxed),
+        .reallocations = atomic_load_explicit(&counters[category].reallocations, memory_order_relaxed),
+        .frees = atomic_load_explicit(&counters[category].frees, memory_order_relaxed),
+        .copied_bytes = atomic_load_explicit(&counters[category].copied_bytes, memory_order_relaxed),
+    };
+}
+
+uint64_t total_allocations(void) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < MEMORY_CATEGORIES; i++) {
+        const struct Memory_Usage usage = get_memory_usage((enum Memory_Category)i);
+        total += usage.allocations + usage.reallocations;
+    }
+    return total;
+}
+
+void print_memory_stats(FILE *const file) {
+    fprintf(file, "%-16s %14s %14s %12s %13s %12s %14s\n", "memory", "current bytes", "peak bytes", "allocations", "reallocations", "frees", "copied bytes");
+    for (size_t i = 0; i < MEMORY_CATEGORIES; i++) {
+        const struct Memory_Usage usage = get_memory_usage((enum Memory_Category)i);
+        fprintf(file, "%-16s %14zu %14zu %12" PRIu64 " %13" PRIu64 " %12" PRIu64 " %14" PRIu64 "\n", memory_category_names[i],
+                usage.current_bytes, usage.peak_bytes, usage.allocations, usage.reallocations, usage.frees, usage.copied_bytes);
+    }
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
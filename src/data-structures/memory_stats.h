@@ -0,0 +1,105 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __MEMORY_STATS
+#define __MEMORY_STATS
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Accounting of the heap memory used by the interpreter, shown by --memstats
+// and by the built-in function memstats. The counters are atomic, because the
+// workers of --batch and --parallel allocate their arrays concurrently, and
+// are only updated when the memory is allocated, resized or freed
+
+enum Memory_Category {
+    MEMORY_ARRAYS,          // Dynamic arrays (dynamic_array.h)
+    MEMORY_VARIABLE_NAMES,  // Names of the variables
+    MEMORY_FILE_BUFFERS,    // Contents of the files read
+    MEMORY_CATEGORIES,
+};
+
+struct Memory_Usage {
+    size_t current_bytes;
+    size_t peak_bytes;
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t frees;
+    // Bytes copied by the reallocations that moved the memory
+    uint64_t copied_bytes;
+};
+
+extern const char *const memory_category_names[MEMORY_CATEGORIES];
+
+// Same as malloc, realloc and free, but accounting the memory in the category.
+// The size of the memory must be passed to tracked_realloc and tracked_free
+void *tracked_malloc(const enum Memory_Category category, const size_t size)
+    __attribute__((warn_unused_result));
+void *tracked_realloc(const enum Memory_Category category, void *const pointer, const size_t old_size, const size_t new_size)
+    __attribute__((warn_unused_result));
+void tracked_free(const enum Memory_Category category, void *const pointer, const size_t size);
+// Accounts memory allocated by other means, which is later freed by tracked_free
+void track_allocation(const enum Memory_Category category, const size_t size);
+struct Memory_Usage get_memory_usage(const enum Memory_Category category);
+// Sum of the allocations and reallocations of all categories, used to verify
+// that a loop doesn't allocate memory
+uint64_t total_allocations(void);
+void print_memory_stats(FILE *const file)
+    __attribute__((nonnull));
+
+#endif  // __MEMORY_STATS
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -77,6 +77,14 @@ int string_compare(const struct String str1, const struct String str2) {
 }
 
 // Parses a integer number using base 10, 16, 8 or 2
+uint64_t hash_string(const struct String str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (String_Length i = 0; i < str.length; i++) {
+        hash = (hash ^ (uint8_t)str.data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
 static long int string_to_int_base(const char *const data, const String_Length length, const int base, String_Length *const num_len) {
     long int number = 0;
     String_Length index = 0;
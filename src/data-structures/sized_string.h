@@ -57,6 +57,8 @@ struct String create_sized_string(char *const str, const String_Length length)
 bool string_is_empty(const struct String *const str)
     __attribute__((nonnull));
 int string_compare(const struct String str1, const struct String str2);
+// FNV-1a hash of the content of the string
+uint64_t hash_string(const struct String str);
 
 // Functions used to convert strings to numbers (without checking for signal)
 // The number of characters parsed into the returned number is stored in num_len
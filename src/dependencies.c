@@ -0,0 +1,188 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "dependencies.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "functions.h"
+#include "lex.h"
+#include "parser.h"
+#include "printing.h"
+
+static void check_allocation(const void *const pointer) {
+    if (pointer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the names of the script!\n");
+    }
+}
+
+struct Name_Table create_name_table(const bool copy_names) {
+    struct Name_Table table = {
+        .owns_names = copy_names,
+        .names = array_new(sizeof(struct String), 256),
+        .last_lines = array_new(sizeof(size_t), 256),
+        .last_accesses = array_new(sizeof(size_t), 256),
+    };
+    check_allocation(table.names);
+    check_allocation(table.last_lines);
+    check_allocation(table.last_accesses);
+    return table;
+}
+
+void destroy_name_table(struct Name_Table *const table) {
+    for (size_t i = 0; table->owns_names && (i < array_size(table->names)); i++) {
+        free(table->names[i].data);
+    }
+    array_del(table->names);
+    array_del(table->last_lines);
+    array_del(table->last_accesses);
+    free(table->indexes);
+}
+
+static void grow_table(struct Name_Table *const table) {
+    free(table->indexes);
+    table->capacity = (table->capacity == 0) ? 1024 : (2 * table->capacity);
+    table->indexes = malloc(table->capacity * sizeof(size_t));
+    check_allocation(table->indexes);
+    for (size_t i = 0; i < table->capacity; i++) {
+        table->indexes[i] = NO_NAME;
+    }
+    for (size_t name = 0; name < array_size(table->names); name++) {
+        size_t position = (size_t)hash_string(table->names[name]) & (table->capacity - 1);
+        while (table->indexes[position] != NO_NAME) {
+            position = (position + 1) & (table->capacity - 1);
+        }
+        table->indexes[position] = name;
+    }
+}
+
+size_t intern_name(struct Name_Table *const table, const struct String name) {
+    // The table is kept at most half full
+    if (2 * (array_size(table->names) + 1) > table->capacity) {
+        grow_table(table);
+    }
+    size_t position = (size_t)hash_string(name) & (table->capacity - 1);
+    while (table->indexes[position] != NO_NAME) {
+        const size_t index = table->indexes[position];
+        if (string_compare(name, table->names[index]) == 0) {
+            return index;
+        }
+        position = (position + 1) & (table->capacity - 1);
+    }
+    struct String new_name = name;
+    if (table->owns_names) {
+        new_name.data = malloc(name.length + 1);
+        check_allocation(new_name.data);
+        memcpy(new_name.data, name.data, name.length);
+    }
+    array_push(table->names, new_name);
+    array_push(table->last_lines, NO_NAME);
+    array_push(table->last_accesses, NO_NAME);
+    check_allocation(table->names);
+    check_allocation(table->last_lines);
+    check_allocation(table->last_accesses);
+    table->indexes[position] = array_size(table->names) - 1;
+    return table->indexes[position];
+}
+
+static void add_access(struct Name_Table *const table, const size_t line, const struct String name, const bool is_write, struct Access **const accesses) {
+    const size_t index = intern_name(table, name);
+    if (table->last_lines[index] != line) {
+        const struct Access access = {
+            .name = index,
+        };
+        array_push(*accesses, access);
+        check_allocation(*accesses);
+        table->last_lines[index] = line;
+        table->last_accesses[index] = array_size(*accesses) - 1;
+    }
+    if (is_write) {
+        (*accesses)[table->last_accesses[index]].is_write = true;
+    } else {
+        (*accesses)[table->last_accesses[index]].is_read = true;
+    }
+}
+
+static bool collect_node_accesses(struct Name_Table *const table, const size_t line, const struct Token_Node *const nodes, const size_t node_idx, const bool is_write, struct Access **const accesses) {
+    if (array_index_is_invalid(nodes, node_idx)) {
+        return false;
+    }
+    const struct Token_Node node = nodes[node_idx];
+    bool has_side_effects = false;
+    switch (node.tok.type) {
+    case TOK_NAME:
+        add_access(table, line, node.tok.name, is_write, accesses);
+        break;
+    case TOK_FUNCTION:
+        has_side_effects = !functions[node.tok.function_index].return_value;
+        break;
+    case TOK_OPERATOR:
+    case TOK_UNARY_OPERATOR:
+    case TOK_DELIMITER:
+    case TOK_NUMBER:
+        break;
+    }
+    const bool is_assignment = (node.tok.type == TOK_OPERATOR) && (node.tok.op == '=');
+    has_side_effects |= collect_node_accesses(table, line, nodes, node.left_idx, is_assignment, accesses);
+    has_side_effects |= collect_node_accesses(table, line, nodes, node.right_idx, false, accesses);
+    return has_side_effects;
+}
+
+bool collect_accesses(struct Name_Table *const table, const size_t line, const struct Token_Node *const nodes, const size_t head_idx, struct Access **const accesses) {
+    return collect_node_accesses(table, line, nodes, head_idx, false, accesses);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
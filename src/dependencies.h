@@ -0,0 +1,104 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __DEPENDENCIES
+#define __DEPENDENCIES
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "data-structures/sized_string.h"
+#include "parser.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Analysis of the variables used by each line of a script, from which the
+// dependencies between the lines are found. Every name in the tree of a line
+// is read when evaluated, except the names at the left of '=', which are only
+// written. The names are identified by their index in a Name_Table.
+
+#define NO_NAME ((size_t)-1)
+
+struct Name_Table {
+    // Dynamic arrays, with one element per name
+    struct String *names;
+    size_t *last_lines;     // Last line that accessed each name
+    size_t *last_accesses;  // Index of that access
+    // Hash table with the indexes of the names, using linear probing
+    size_t *indexes;
+    size_t capacity;
+    // Are the names copied to memory owned by the table?
+    bool owns_names;
+};
+
+struct Access {
+    size_t name;
+    bool is_read;
+    bool is_write;
+};
+
+// If the names are not copied, they must outlive the table
+struct Name_Table create_name_table(const bool copy_names);
+void destroy_name_table(struct Name_Table *const table)
+    __attribute__((nonnull));
+size_t intern_name(struct Name_Table *const table, const struct String name)
+    __attribute__((nonnull));
+// Appends to the dynamic array accesses the variables accessed by the tree of the
+// line, once per name. The line must be an identifier different for each call.
+// Returns true if the tree calls a built-in function with side effects (the
+// functions that don't return a value), which may use any variable
+bool collect_accesses(struct Name_Table *const table, const size_t line, const struct Token_Node *const nodes, const size_t head_idx, struct Access **const accesses)
+    __attribute__((nonnull));
+
+#endif  // __DEPENDENCIES
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
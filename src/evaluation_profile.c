@@ -0,0 +1,241 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "evaluation_profile.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data-structures/dynamic_array.h"
+#include "functions.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+
+#define GRAPH_IDENTATION 4
+
+static uint64_t measure_clock_overhead(void) {
+    uint64_t overhead = UINT64_MAX;
+    for (size_t i = 0; i < 1000; i++) {
+        const uint64_t start = monotonic_time_ns();
+        const uint64_t elapsed = monotonic_time_ns() - start;
+        if (elapsed < overhead) {
+            overhead = elapsed;
+        }
+    }
+    return overhead;
+}
+
+struct Evaluation_Profile create_evaluation_profile(const enum Explain_Format format) {
+    struct Evaluation_Profile profile = (struct Evaluation_Profile){
+        .format = format,
+        .nodes = NULL,
+        .nodes_capacity = 0,
+        .functions = calloc(functions_quantity, sizeof(struct Function_Stats)),
+        .clock_overhead_ns = measure_clock_overhead(),
+    };
+    if (profile.functions == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the profile!\n");
+    }
+    return profile;
+}
+
+void destroy_evaluation_profile(struct Evaluation_Profile *const profile) {
+    free(profile->nodes);
+    free(profile->functions);
+    profile->nodes = NULL;
+    profile->nodes_capacity = 0;
+    profile->functions = NULL;
+}
+
+void clear_node_stats(struct Evaluation_Profile *const profile) {
+    if (profile->nodes != NULL) {
+        memset(profile->nodes, 0, profile->nodes_capacity * sizeof(struct Node_Stats));
+    }
+}
+
+void record_node_time(struct Evaluation_Profile *const profile, const size_t node_idx, const uint64_t ns) {
+    if (node_idx >= profile->nodes_capacity) {
+        size_t capacity = (profile->nodes_capacity == 0) ? 1024 : profile->nodes_capacity;
+        while (node_idx >= capacity) {
+            capacity *= 2;
+        }
+        struct Node_Stats *const nodes = realloc(profile->nodes, capacity * sizeof(struct Node_Stats));
+        if (nodes == NULL) {
+            print_crash_and_exit("Couldn't allocate memory for the profile!\n");
+        }
+        memset(&nodes[profile->nodes_capacity], 0, (capacity - profile->nodes_capacity) * sizeof(struct Node_Stats));
+        profile->nodes = nodes;
+        profile->nodes_capacity = capacity;
+    }
+    profile->nodes[node_idx].visits++;
+    profile->nodes[node_idx].total_ns += ns;
+}
+
+void record_function_time(struct Evaluation_Profile *const profile, const size_t function_index, const uint64_t ns) {
+    profile->functions[function_index].calls++;
+    profile->functions[function_index].total_ns += ns;
+}
+
+static struct Node_Stats get_node_stats(const struct Evaluation_Profile *const profile, const size_t node_idx) {
+    return (node_idx < profile->nodes_capacity) ? profile->nodes[node_idx] : (struct Node_Stats){0};
+}
+
+static uint64_t self_time(const struct Evaluation_Profile *const profile, const struct Parser *const parser, const size_t node_idx) {
+    uint64_t children_ns = 0;
+    const size_t left_idx = parser->nodes[node_idx].left_idx;
+    if (array_index_is_valid(parser->nodes, left_idx)) {
+        children_ns += get_node_stats(profile, left_idx).total_ns;
+    }
+    const size_t right_idx = parser->nodes[node_idx].right_idx;
+    if (array_index_is_valid(parser->nodes, right_idx)) {
+        children_ns += get_node_stats(profile, right_idx).total_ns;
+    }
+    const uint64_t total_ns = get_node_stats(profile, node_idx).total_ns;
+    return (total_ns > children_ns) ? (total_ns - children_ns) : 0;
+}
+
+static void print_explained_node(const struct Evaluation_Profile *const profile, const struct Parser *const parser, const size_t node_idx, const unsigned int level, const uint64_t tree_ns) {
+    const struct Node_Stats stats = get_node_stats(profile, node_idx);
+    const uint64_t self_ns = self_time(profile, parser, node_idx);
+    printf("[%" PRIu64 "x, total %" PRIu64 " ns, self %" PRIu64 " ns, %.1lf%%] ", stats.visits, stats.total_ns, self_ns,
+           (tree_ns > 0) ? (100.0 * (double)self_ns / (double)tree_ns) : 0.0);
+    print_token(parser->nodes[node_idx].tok);
+    const size_t left_idx = parser->nodes[node_idx].left_idx;
+    if (array_index_is_valid(parser->nodes, left_idx)) {
+        printf("%*sLEFT:  ", level * 2, "");
+        print_explained_node(profile, parser, left_idx, level + 1, tree_ns);
+    }
+    const size_t right_idx = parser->nodes[node_idx].right_idx;
+    if (array_index_is_valid(parser->nodes, right_idx)) {
+        printf("%*sRIGHT: ", level * 2, "");
+        print_explained_node(profile, parser, right_idx, level + 1, tree_ns);
+    }
+}
+
+static void print_explained_graph_node(const struct Evaluation_Profile *const profile, const struct Parser *const parser, const size_t node_idx, const uint64_t tree_ns) {
+    const struct Node_Stats stats = get_node_stats(profile, node_idx);
+    const uint64_t self_ns = self_time(profile, parser, node_idx);
+    // The saturation of the red grows with the share of the self time
+    const double share = (tree_ns > 0) ? ((double)self_ns / (double)tree_ns) : 0.0;
+    printf("%*snode%03zu  [ style=filled, fillcolor=\"0.000 %.3lf 1.000\", label = \"", GRAPH_IDENTATION, "", node_idx, share);
+    print_token_string(parser->nodes[node_idx].tok);
+    printf("\\n%" PRIu64 "x, total %" PRIu64 " ns\\nself %" PRIu64 " ns (%.1lf%%)\" ];\n", stats.visits, stats.total_ns, self_ns, 100.0 * share);
+    const size_t left_idx = parser->nodes[node_idx].left_idx;
+    if (array_index_is_valid(parser->nodes, left_idx)) {
+        print_explained_graph_node(profile, parser, left_idx, tree_ns);
+        printf("%*snode%03zu -> node%03zu;\n", GRAPH_IDENTATION, "", node_idx, left_idx);
+    }
+    const size_t right_idx = parser->nodes[node_idx].right_idx;
+    if (array_index_is_valid(parser->nodes, right_idx)) {
+        print_explained_graph_node(profile, parser, right_idx, tree_ns);
+        printf("%*snode%03zu -> node%03zu;\n", GRAPH_IDENTATION, "", node_idx, right_idx);
+    }
+}
+
+void print_explained_tree(const struct Evaluation_Profile *const profile, const struct Parser *const parser, const size_t head_idx) {
+    if (array_index_is_invalid(parser->nodes, head_idx)) {
+        return;
+    }
+    const uint64_t tree_ns = get_node_stats(profile, head_idx).total_ns;
+    switch (profile->format) {
+    case EXPLAIN_TREE:
+        printf("Evaluation profile (the clock overhead is about %" PRIu64 " ns per node):\n", profile->clock_overhead_ns);
+        printf("HEAD:  ");
+        print_explained_node(profile, parser, head_idx, 0, tree_ns);
+        printf("\n");
+        break;
+    case EXPLAIN_GRAPH:
+        printf("digraph AST {\n");
+        printf("%*snode [ fontname=\"Arial\" ];\n", GRAPH_IDENTATION, "");
+        print_explained_graph_node(profile, parser, head_idx, tree_ns);
+        printf("}\n\n");
+        break;
+    }
+}
+
+static const struct Evaluation_Profile *sorting_profile = NULL;
+
+static int compare_functions(const void *const a, const void *const b) {
+    const uint64_t x = sorting_profile->functions[*(const size_t *)a].total_ns;
+    const uint64_t y = sorting_profile->functions[*(const size_t *)b].total_ns;
+    return (x < y) - (x > y);
+}
+
+void print_function_profile(FILE *const file, const struct Evaluation_Profile *const profile) {
+    size_t *const called = malloc(functions_quantity * sizeof(size_t));
+    if (called == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the profile!\n");
+    }
+    size_t quantity = 0;
+    for (size_t i = 0; i < functions_quantity; i++) {
+        if (profile->functions[i].calls > 0) {
+            called[quantity++] = i;
+        }
+    }
+    if (quantity > 0) {
+        sorting_profile = profile;
+        qsort(called, quantity, sizeof(size_t), compare_functions);
+        fprintf(file, "Time spent in the built-in functions (the arguments are evaluated before, unless they are lazy):\n");
+        fprintf(file, "%-12s %12s %16s %12s\n", "function", "calls", "total ns", "mean ns");
+        for (size_t i = 0; i < quantity; i++) {
+            const struct Function_Stats *const stats = &profile->functions[called[i]];
+            fprintf(file, "%-12s %12" PRIu64 " %16" PRIu64 " %12.1lf\n", functions[called[i]].name, stats->calls, stats->total_ns,
+                    (double)stats->total_ns / (double)stats->calls);
+        }
+    }
+    free(called);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,116 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __EVALUATION_PROFILE
+#define __EVALUATION_PROFILE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "parser.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Profile of the evaluation used by --explain (like EXPLAIN ANALYZE of SQL).
+// When a parser has a profile, evaluate() counts the visits and measures the
+// time spent in each node of the tree, and perform_function_call the time
+// spent in each built-in function. The time of a node includes its children,
+// so its self time is its time without the time of its children. Each time
+// measurement reads the clock twice, and this overhead is also included
+
+enum Explain_Format {
+    EXPLAIN_TREE,
+    EXPLAIN_GRAPH,
+};
+
+struct Node_Stats {
+    uint64_t visits;
+    uint64_t total_ns;
+};
+
+struct Function_Stats {
+    uint64_t calls;
+    uint64_t total_ns;
+};
+
+struct Evaluation_Profile {
+    enum Explain_Format format;
+    // Indexed as the nodes of the parser, and cleared at each line
+    struct Node_Stats *nodes;
+    size_t nodes_capacity;
+    // Indexed as the table of built-in functions, and kept until the end
+    struct Function_Stats *functions;
+    // Smallest difference between two readings of the clock
+    uint64_t clock_overhead_ns;
+};
+
+struct Evaluation_Profile create_evaluation_profile(const enum Explain_Format format);
+void destroy_evaluation_profile(struct Evaluation_Profile *const profile)
+    __attribute__((nonnull));
+void clear_node_stats(struct Evaluation_Profile *const profile)
+    __attribute__((nonnull));
+void record_node_time(struct Evaluation_Profile *const profile, const size_t node_idx, const uint64_t ns)
+    __attribute__((nonnull));
+void record_function_time(struct Evaluation_Profile *const profile, const size_t function_index, const uint64_t ns)
+    __attribute__((nonnull));
+// Outputs to stdout the tree annotated with the visits and times of each node,
+// in the style of print_tree, or as a graphviz heatmap of the self time
+void print_explained_tree(const struct Evaluation_Profile *const profile, const struct Parser *const parser, const size_t head_idx)
+    __attribute__((nonnull));
+// Lists the built-in functions called, from the slowest
+void print_function_profile(FILE *const file, const struct Evaluation_Profile *const profile)
+    __attribute__((nonnull));
+
+#endif  // __EVALUATION_PROFILE
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
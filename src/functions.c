@@ -27,15 +27,24 @@
 #include "functions.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "benchmark.h"
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
 #include "data-structures/sized_string.h"
+#include "metrics.h"
+#include "parser.h"
 #include "printing.h"
 #include "variables.h"
 #include "input_stream.h"
+#include "snapshot.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -44,61 +53,89 @@
 #define M_E 2.7182818284590452354
 #endif
 
-double fn_load(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+double fn_exit(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)column;
+    (void)first_arg;
+    (void)second_arg;
+    ctx->actions |= ACTION_EXIT;
+    return NAN;
+}
+
+double fn_load(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)column;
     (void)first_arg;
     (void)second_arg;
     printf("Please insert the name of the file from which the variables should be loaded?\n");
-    const struct String file_name = get_line_from_input();
-    load_variables_from_file(vars, file_name);
+    const struct String file_name = get_line_from_input(&ctx->input);
+    load_variables_from_file(&ctx->vars, file_name);
     return NAN;
 }
 
-double fn_save(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+double fn_save(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)column;
     (void)first_arg;
     (void)second_arg;
     printf("Please insert the name of the file in which the variables should be saved?\n");
-    const struct String file_name = get_line_from_input();
-    save_variables_to_file(vars, file_name);
+    const struct String file_name = get_line_from_input(&ctx->input);
+    save_variables_to_file(&ctx->vars, file_name);
+    return NAN;
+}
+
+double fn_restore(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)column;
+    (void)first_arg;
+    (void)second_arg;
+    printf("Please insert the name of the snapshot file from which the variables should be restored?\n");
+    const struct String file_name = get_line_from_input(&ctx->input);
+    restore_snapshot(&ctx->vars, file_name);
     return NAN;
 }
 
-double fn_clear(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+double fn_snapshot(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)column;
     (void)first_arg;
     (void)second_arg;
-    clear_variables(vars);
+    printf("Please insert the name of the snapshot file in which the variables should be saved?\n");
+    const struct String file_name = get_line_from_input(&ctx->input);
+    save_snapshot(&ctx->vars, file_name);
     return NAN;
 }
 
-double fn_delete(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+double fn_clear(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)column;
+    (void)first_arg;
+    (void)second_arg;
+    clear_variables(&ctx->vars);
+    return NAN;
+}
+
+double fn_delete(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     if ((first_arg.name.data == NULL) || (first_arg.name.length == 0)) {
-        print_column(column);
-        print_error("The function \"delete\" expects a reference to a variable as argument\n");
+        print_column(&ctx->diagnostics, column);
+        print_error(&ctx->diagnostics, "The function \"delete\" expects a reference to a variable as argument\n");
         return NAN;
     }
-    if (delete_variable(vars, first_arg.name) == EXIT_FAILURE) {
-        print_error("The variable %.*s does not exist!\n", first_arg.name.length, first_arg.name.data);
+    if (delete_variable(&ctx->vars, first_arg.name) == EXIT_FAILURE) {
+        print_error(&ctx->diagnostics, "The variable %.*s does not exist!\n", first_arg.name.length, first_arg.name.data);
     }
     return NAN;
 }
 
-double fn_variables(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+double fn_variables(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)column;
     (void)first_arg;
     (void)second_arg;
-    if (variable_list_is_empty(vars)) {
+    if (variable_list_is_empty(&ctx->vars)) {
         printf("The variables list is empty!\n");
     } else {
-        print_variables(vars);
+        print_variables(&ctx->vars);
     }
     return NAN;
 }
 
-double fn_functions(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_functions(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)first_arg;
     (void)second_arg;
@@ -106,355 +143,380 @@ double fn_functions(struct Variables *const vars, const size_t column, const str
     return NAN;
 }
 
-double fn_euler(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_memstats(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
+    (void)column;
+    (void)first_arg;
+    (void)second_arg;
+    print_memory_stats(stdout);
+    return NAN;
+}
+
+double fn_stats(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)first_arg;
+    (void)second_arg;
+    if (ctx->metrics == NULL) {
+        print_column(&ctx->diagnostics, column);
+        print_error(&ctx->diagnostics, "The metrics aren't kept in this session!\n");
+        return NAN;
+    }
+    print_metrics(stdout, ctx->metrics, array_size(ctx->vars.list));
+    return NAN;
+}
+
+double fn_bench(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    enum Evaluation_Status status = Eval_OK;
+    const double iterations = evaluate(second_arg.parser, second_arg.node_idx, &status);
+    if (status == Eval_Error) {
+        *second_arg.status = Eval_Error;
+        return NAN;
+    }
+    if (!isfinite(iterations) || (iterations < 1.0) || (iterations > (double)UINT32_MAX)) {
+        print_column(&ctx->diagnostics, column);
+        print_error(&ctx->diagnostics, "The function \"bench\" expects a number of iterations between 1 and %" PRIu32 "!\n", UINT32_MAX);
+        *second_arg.status = Eval_Error;
+        return NAN;
+    }
+    struct Benchmark benchmark;
+    // The errors of the benchmarked expression were reported by its first evaluation
+    if (benchmark_tree(first_arg.parser, first_arg.node_idx, (uint64_t)iterations, &benchmark)) {
+        *first_arg.status = Eval_Error;
+        return NAN;
+    }
+    print_benchmark(&benchmark);
+    return NAN;
+}
+
+double fn_euler(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)first_arg;
     (void)second_arg;
     return M_E;
 }
 
-double fn_pi(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_pi(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)first_arg;
     (void)second_arg;
     return M_PI;
 }
 
-double fn_ceil(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_ceil(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return ceil(first_arg.value);
 }
 
-double fn_floor(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_floor(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return floor(first_arg.value);
 }
 
-double fn_trunc(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_trunc(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return trunc(first_arg.value);
 }
 
-double fn_round(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_round(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return round(first_arg.value);
 }
 
-double fn_abs(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_abs(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return fabs(first_arg.value);
 }
 
-double fn_sqrt(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_sqrt(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = sqrt(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The sqrt function received an argument less than zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The sqrt function received an argument less than zero!\n");
     }
     return value;
 }
 
-double fn_cbrt(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_cbrt(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return cbrt(first_arg.value);
 }
 
-double fn_exp(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_exp(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = exp(first_arg.value);
     if (errno == ERANGE) {
-        print_column(column);
-        print_warning("Overflow occurred when calling the exp function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the exp function!\n");
     }
     return value;
 }
 
-double fn_exp2(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_exp2(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = exp2(first_arg.value);
     if (errno == ERANGE) {
-        print_column(column);
-        print_warning("Overflow occurred when calling the exp2 function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the exp2 function!\n");
     }
     return value;
 }
 
-double fn_log(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_log(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = log(first_arg.value);
     switch (errno) {
     case EDOM:
-        print_column(column);
-        print_warning("The log function received an argument less than zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The log function received an argument less than zero!\n");
         break;
     case ERANGE:
-        print_column(column);
-        print_warning("The log function received an argument equal to zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The log function received an argument equal to zero!\n");
         break;
     }
     return value;
 }
 
-double fn_log10(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_log10(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = log10(first_arg.value);
     switch (errno) {
     case EDOM:
-        print_column(column);
-        print_warning("The log10 function received an argument less than zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The log10 function received an argument less than zero!\n");
         break;
     case ERANGE:
-        print_column(column);
-        print_warning("The log10 function received an argument equal to zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The log10 function received an argument equal to zero!\n");
         break;
     }
     return value;
 }
 
-double fn_log2(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_log2(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = log2(first_arg.value);
     switch (errno) {
     case EDOM:
-        print_column(column);
-        print_warning("The log2 function received an argument less than zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The log2 function received an argument less than zero!\n");
         break;
     case ERANGE:
-        print_column(column);
-        print_warning("The log2 function received an argument equal to zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The log2 function received an argument equal to zero!\n");
         break;
     }
     return value;
 }
 
-double fn_erf(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_erf(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return erf(first_arg.value);
 }
 
-double fn_gamma(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_gamma(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = tgamma(first_arg.value);
     switch (errno) {
     case EDOM:
-        print_column(column);
-        print_warning("The gamma function received an argument less than zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The gamma function received an argument less than zero!\n");
         break;
     case ERANGE:
-        print_column(column);
-        print_warning("Overflow occurred when calling the gamma function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the gamma function!\n");
         break;
     }
     return value;
 }
 
-double fn_sin(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_sin(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = sin(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The sin function received an invalid argument!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The sin function received an invalid argument!\n");
     }
     return value;
 }
 
-double fn_cos(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_cos(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = cos(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The cos function received an invalid argument!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The cos function received an invalid argument!\n");
     }
     return value;
 }
 
-double fn_tan(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_tan(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = tan(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The tan function received an invalid argument!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The tan function received an invalid argument!\n");
     }
     return value;
 }
 
-double fn_asin(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_asin(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = asin(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The asin function received an argument outside the range [-1, 1]!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The asin function received an argument outside the range [-1, 1]!\n");
     }
     return value;
 }
 
-double fn_acos(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_acos(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = acos(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The acos function received an argument outside the range [-1, 1]!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The acos function received an argument outside the range [-1, 1]!\n");
     }
     return value;
 }
 
-double fn_atan(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_atan(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return atan(first_arg.value);
 }
 
-double fn_sinh(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_sinh(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = sinh(first_arg.value);
     if (errno == ERANGE) {
-        print_column(column);
-        print_warning("Overflow occurred when calling the sinh function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the sinh function!\n");
     }
     return value;
 }
 
-double fn_cosh(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_cosh(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = cosh(first_arg.value);
     if (errno == ERANGE) {
-        print_column(column);
-        print_warning("Overflow occurred when calling the cosh function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the cosh function!\n");
     }
     return value;
 }
 
-double fn_tanh(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_tanh(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return tanh(first_arg.value);
 }
 
-double fn_asinh(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_asinh(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     (void)second_arg;
     return asinh(first_arg.value);
 }
 
-double fn_acosh(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_acosh(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = acosh(first_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("The argument passed to the acosh function must be greather than 1!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The argument passed to the acosh function must be greather than 1!\n");
     }
     return value;
 }
 
-double fn_atanh(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_atanh(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     (void)second_arg;
     errno = 0;
     const double value = atanh(first_arg.value);
     switch (errno) {
     case EDOM:
-        print_column(column);
-        print_warning("The atanh function received an argument outside the range [-1, 1]!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The atanh function received an argument outside the range [-1, 1]!\n");
         break;
     case ERANGE:
-        print_column(column);
-        print_warning("The atanh function received an argument equal to 1 or -1!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The atanh function received an argument equal to 1 or -1!\n");
         break;
     }
     return value;
 }
 
-double fn_pow(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_pow(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     errno = 0;
     const double value = pow(first_arg.value, second_arg.value);
     switch (errno) {
     case EDOM:
-        print_column(column);
-        print_warning("The first argument passed to the pow function is negative, while the second is finite noninteger number!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "The first argument passed to the pow function is negative, while the second is finite noninteger number!\n");
         break;
     case ERANGE:
-        print_column(column);
-        print_warning("Overflow occurred when calling the pow function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the pow function!\n");
         break;
     }
     return value;
 }
 
-double fn_atan2(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_atan2(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
+    (void)ctx;
     (void)column;
     return atan2(first_arg.value, second_arg.value);
 }
 
-double fn_hypot(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_hypot(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     errno = 0;
     const double value = hypot(first_arg.value, second_arg.value);
     if (errno == ERANGE) {
-        print_column(column);
-        print_warning("Overflow occurred when calling the hypot function!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Overflow occurred when calling the hypot function!\n");
     }
     return value;
 }
 
-double fn_mod(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
+double fn_mod(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
     errno = 0;
     const double value = fmod(first_arg.value, second_arg.value);
     if (errno == EDOM) {
-        print_column(column);
-        print_warning("Either the first argument of mod is infinity, or the second is zero!\n");
+        print_column(&ctx->diagnostics, column);
+        print_warning(&ctx->diagnostics, "Either the first argument of mod is infinity, or the second is zero!\n");
     }
     return value;
 }
@@ -481,6 +543,20 @@ const struct Function functions[] = {
         .return_value = false,
         .fn = &fn_save,
     },
+    {
+        .name = "restore",
+        .description = "Restore variables from a binary snapshot file",
+        .arity = 0,
+        .return_value = false,
+        .fn = &fn_restore,
+    },
+    {
+        .name = "snapshot",
+        .description = "Save variables to a binary snapshot file",
+        .arity = 0,
+        .return_value = false,
+        .fn = &fn_snapshot,
+    },
     {
         .name = "clear",
         .description = "Clear all variables from memory",
@@ -509,6 +585,28 @@ const struct Function functions[] = {
         .return_value = false,
         .fn = &fn_functions,
     },
+    {
+        .name = "memstats",
+        .description = "Display the heap memory used by the arrays, variable names and file buffers",
+        .arity = 0,
+        .return_value = false,
+        .fn = &fn_memstats,
+    },
+    {
+        .name = "stats",
+        .description = "Display the number of lines evaluated, the errors found and the latency of each phase",
+        .arity = 0,
+        .return_value = false,
+        .fn = &fn_stats,
+    },
+    {
+        .name = "bench",
+        .description = "Evaluates it's first argument repeatedly, the number of times given by the second, and reports the time taken",
+        .arity = 2,
+        .return_value = false,
+        .lazy_arguments = true,
+        .fn = &fn_bench,
+    },
     {
         .name = "euler",
         .description = "Returns the euler constant",
@@ -753,9 +851,6 @@ size_t search_function(const struct String name) {
     return functions_quantity;
 }
 
-// Defined on main.c
-extern unsigned int max_uint(const unsigned int a, const unsigned int b);
-
 static inline unsigned int longest_name_functions(void) {
     unsigned int length = 0;
     for (size_t i = 0; i < functions_quantity; i++) {
@@ -30,26 +30,36 @@
 #include <stdbool.h>
 
 #include "data-structures/sized_string.h"
+#include "parser.h"
 #include "variables.h"
 
 #if !defined(__GNUC__) && !defined(__attribute__)
 #define __attribute__(a)
 #endif
 
+// Defined on context.h
+struct Context;
+
 // Struct used to store the argument of a function. It may contain a value,
-// a name (possible referente to a variable), or both
+// a name (possible referente to a variable), or both. The node of the argument
+// is also passed, so that functions with lazy arguments can evaluate it, and
+// report through the status of the call that they failed
 struct Fn_Arg {
     const double value;
     const struct String name;
+    struct Parser *const parser;
+    const size_t node_idx;
+    enum Evaluation_Status *const status;
 };
 
-typedef double (*Function_Pointer)(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg);
+typedef double (*Function_Pointer)(struct Context *const ctx, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg);
 
 struct Function {
     const char *name;
     const char *description;
     const int arity;          // number of expected arguments (0, 1 or 2)
     const bool return_value;  // the function returns a value?
+    const bool lazy_arguments;  // the function evaluates it's arguments by itself?
     const Function_Pointer fn;
 };
 
@@ -59,9 +69,6 @@ extern const size_t functions_quantity;
 size_t search_function(const struct String name);
 void print_functions(void);
 
-// Defined on main.c
-double fn_exit(struct Variables *const vars, size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg)
-    __attribute__((nonnull));
 
 #endif  // __FUNCTIONS
 
@@ -35,18 +35,17 @@
 #include "platform.h"
 #include "printing.h"
 
-struct Input_Stream {
-    struct String_Buffer lines;
-};
-
-static struct Input_Stream input_stream = {0};
-
-void initialize_input_stream(void) {
-    input_stream.lines = create_string_buffer();
+struct Input_Stream create_input_stream(struct Diagnostics *const diagnostics) {
+    return (struct Input_Stream){
+        .lines = create_string_buffer(),
+        .terminal = (struct Terminal){0},
+        .diagnostics = diagnostics,
+        .is_interactive = true,
+    };
 }
 
-static inline String_Length jump_words_right(const String_Node_Index line_index, const String_Length position) {
-    const struct String_Node *const string = get_node_from_index(&input_stream.lines, line_index);
+static inline String_Length jump_words_right(struct Input_Stream *const input, const String_Node_Index line_index, const String_Length position) {
+    const struct String_Node *const string = get_node_from_index(&input->lines, line_index);
     const String_Length length = string->length;
     if (position == length) {
         return length;
@@ -64,11 +63,11 @@ static inline String_Length jump_words_right(const String_Node_Index line_index,
     return i;
 }
 
-static inline String_Length jump_words_left(const String_Node_Index line_index, const String_Length position) {
+static inline String_Length jump_words_left(struct Input_Stream *const input, const String_Node_Index line_index, const String_Length position) {
     if (position == 0) {
         return 0;
     }
-    const struct String_Node *const string = get_node_from_index(&input_stream.lines, line_index);
+    const struct String_Node *const string = get_node_from_index(&input->lines, line_index);
     String_Length i = position - 1;
     for (; i > 0; i--) {
         if (isspace(string->data[position])) {
@@ -82,9 +81,15 @@ static inline String_Length jump_words_left(const String_Node_Index line_index,
     return i;
 }
 
-struct String get_line_from_input(void) {
+struct String get_line_from_input(struct Input_Stream *const input) {
+    if (!input->is_interactive) {
+        print_error(input->diagnostics, "There is no terminal from which the input could be read!\n");
+        return create_string("");
+    }
     const struct String command = create_string("> ");
     print_string(command);
+    // The terminal stays in the non-canonical mode only while the line is read
+    configure_terminal_non_canonical(&input->terminal);
     // Local variable used to store the current position of the cursor
     String_Length position = 0;
     // Variables used to iterate over the linked list of strings in the buffer
@@ -92,16 +97,16 @@ struct String get_line_from_input(void) {
     // and also an extra index
     bool previous_direction = true;
     String_Node_Index auxiliar_index = INVALID_STRING_INDEX;
-    String_Node_Index line_index = input_stream.lines.current_index;
+    String_Node_Index line_index = input->lines.current_index;
     for (;;) {
         char c;
         const enum Keys key = read_key_without_echo(&c);
         switch (key) {
         case KEY_ARROW_UP: {
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             String_Node_Index previous_index;
             if (previous_direction) {
-                previous_index = get_previous_node(&input_stream.lines, line_index, auxiliar_index);
+                previous_index = get_previous_node(&input->lines, line_index, auxiliar_index);
             } else {
                 previous_index = auxiliar_index;
                 previous_direction = true;
@@ -110,11 +115,11 @@ struct String get_line_from_input(void) {
             if (previous_index >= 0) {
                 auxiliar_index = line_index;
                 line_index = previous_index;
-                position = get_node_from_index(&input_stream.lines, line_index)->length;
+                position = get_node_from_index(&input->lines, line_index)->length;
                 const int spaces = length - position;
                 // Print the line found
                 move_cursor_to_column(stdout, (command.length + 1));
-                print_string_at_index(&input_stream.lines, line_index);
+                print_string_at_index(&input->lines, line_index);
                 // Completes the line with spaces
                 printf("%*s", (spaces > 0 ? spaces : 0), "");
                 // Restores cursor position
@@ -122,24 +127,24 @@ struct String get_line_from_input(void) {
             }
         } break;
         case KEY_ARROW_DOWN: {
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             String_Node_Index next_index;
             if (!previous_direction) {
-                next_index = get_next_node(&input_stream.lines, line_index, auxiliar_index);
+                next_index = get_next_node(&input->lines, line_index, auxiliar_index);
             } else {
                 next_index = auxiliar_index;
                 previous_direction = false;
             }
             // If there is a next non-empty line
-            // const String_Node_Index next_index = get_next_node(&input_stream.lines, line_index, auxiliar_index);
+            // const String_Node_Index next_index = get_next_node(&input->lines, line_index, auxiliar_index);
             if (next_index >= 0) {
                 auxiliar_index = line_index;
                 line_index = next_index;
-                position = get_node_from_index(&input_stream.lines, line_index)->length;
+                position = get_node_from_index(&input->lines, line_index)->length;
                 const int spaces = length - position;
                 // Print the line found
                 move_cursor_to_column(stdout, (command.length + 1));
-                print_string_at_index(&input_stream.lines, line_index);
+                print_string_at_index(&input->lines, line_index);
                 // Completes the line with spaces
                 printf("%*s", (spaces > 0 ? spaces : 0), "");
                 // Restores cursor position
@@ -147,7 +152,7 @@ struct String get_line_from_input(void) {
             }
         } break;
         case KEY_ARROW_RIGHT: {
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             if (position < length) {
                 move_cursor_right(stdout, 1);
                 position++;
@@ -160,7 +165,7 @@ struct String get_line_from_input(void) {
             }
             break;
         case KEY_END: {
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             move_cursor_to_column(stdout, (int)(length + command.length + 1));
             position = length;
         } break;
@@ -169,60 +174,61 @@ struct String get_line_from_input(void) {
             position = 0;
             break;
         case KEY_CTRL_RIGHT:
-            position = jump_words_right(line_index, position);
+            position = jump_words_right(input, line_index, position);
             // Update the cursor position
             move_cursor_to_column(stdout, (int)(position + command.length + 1));
             break;
         case KEY_CTRL_LEFT:
-            position = jump_words_left(line_index, position);
+            position = jump_words_left(input, line_index, position);
             // Update the cursor position
             move_cursor_to_column(stdout, (int)(position + command.length + 1));
             break;
         case KEY_ENTER:
-            if (line_index != input_stream.lines.current_index) {
+            if (line_index != input->lines.current_index) {
                 // The user changed the line been displayed using the arrows
                 // In this case, we must copy the line shown to the current line buffer
                 // This way we don't lose the command history
-                copy_string_at_index(&input_stream.lines, line_index);
+                copy_string_at_index(&input->lines, line_index);
                 // The current line address may have changed when merging lines
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 // Reset auxiliar variables used to iterate over the linked list of strings
                 previous_direction = true;
                 auxiliar_index = INVALID_STRING_INDEX;
             }
             putchar('\n');
-            struct String_Node *const node = get_current_node(&input_stream.lines);
+            struct String_Node *const node = get_current_node(&input->lines);
             struct String str = get_string_from_node(node);
             if (!string_is_empty(&str)) {
-                update_current_string(&input_stream.lines);
+                update_current_string(&input->lines);
             }
+            restore_terminal(&input->terminal);
             return str;
         case KEY_TAB: {
-            if (line_index != input_stream.lines.current_index) {
+            if (line_index != input->lines.current_index) {
                 // The user changed the line been displayed using the arrows
                 // In this case, we must copy the line shown to the current line buffer
                 // This way we don't lose the command history
-                copy_string_at_index(&input_stream.lines, line_index);
+                copy_string_at_index(&input->lines, line_index);
                 // The current line address may have changed when merging lines
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 // Reset auxiliar variables used to iterate over the linked list of strings
                 previous_direction = true;
                 auxiliar_index = INVALID_STRING_INDEX;
             }
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             // We convert tab to four spaces, because it is easiear to handle
             unsigned int tab_to_spaces = 4;
             printf("%*s", tab_to_spaces, "");
             if (position < length) {
                 // Update line to the output
-                print_chars_at_index(&input_stream.lines, line_index, position);
+                print_chars_at_index(&input->lines, line_index, position);
                 // Restores cursor position
                 move_cursor_to_column(stdout, (int)(position + command.length + tab_to_spaces + 1));
             }
             while (tab_to_spaces--) {
-                if (add_char_at(&input_stream.lines, ' ', position)) {
+                if (add_char_at(&input->lines, ' ', position)) {
                     putchar('\n');
-                    print_error("You typed a expression that consumed all the input buffer! You may try again...\n\n");
+                    print_error(input->diagnostics, "You typed a expression that consumed all the input buffer! You may try again...\n\n");
                     print_string(command);
                     position = 0;
                 } else {
@@ -230,25 +236,25 @@ struct String get_line_from_input(void) {
                 }
             }
             // The current line address may have changed when merging lines
-            line_index = input_stream.lines.current_index;
+            line_index = input->lines.current_index;
         } break;
         case KEY_DEL: {
-            if (line_index != input_stream.lines.current_index) {
+            if (line_index != input->lines.current_index) {
                 // The user changed the line been displayed using the arrows
                 // In this case, we must copy the line shown to the current line buffer
                 // This way we don't lose the command history
-                copy_string_at_index(&input_stream.lines, line_index);
+                copy_string_at_index(&input->lines, line_index);
                 // The current line address may have changed when merging lines
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 // Reset auxiliar variables used to iterate over the linked list of strings
                 previous_direction = true;
                 auxiliar_index = INVALID_STRING_INDEX;
             }
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             if (position < length) {
-                remove_char_at(&input_stream.lines, position);
+                remove_char_at(&input->lines, position);
                 // Update line to the output
-                print_chars_at_index(&input_stream.lines, line_index, position);
+                print_chars_at_index(&input->lines, line_index, position);
                 // Override the last printed char with a space
                 putchar(' ');
                 // Restores cursor position
@@ -256,24 +262,24 @@ struct String get_line_from_input(void) {
             }
         } break;
         case KEY_BACKSPACE:
-            if (line_index != input_stream.lines.current_index) {
+            if (line_index != input->lines.current_index) {
                 // The user changed the line been displayed using the arrows
                 // In this case, we must copy the line shown to the current line buffer
                 // This way we don't lose the command history
-                copy_string_at_index(&input_stream.lines, line_index);
+                copy_string_at_index(&input->lines, line_index);
                 // The current line address may have changed when merging lines
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 // Reset auxiliar variables used to iterate over the linked list of strings
                 previous_direction = true;
                 auxiliar_index = INVALID_STRING_INDEX;
             }
             if (position > 0) {
                 position--;
-                remove_char_at(&input_stream.lines, position);
+                remove_char_at(&input->lines, position);
                 // Go left one position with the cursor
                 move_cursor_left(stdout, 1);
                 // Update line to the output
-                print_chars_at_index(&input_stream.lines, line_index, position);
+                print_chars_at_index(&input->lines, line_index, position);
                 // Override the last printed char with a space
                 putchar(' ');
                 // Restores cursor position
@@ -281,34 +287,34 @@ struct String get_line_from_input(void) {
             }
             break;
         case KEY_CHAR: {
-            if (line_index != input_stream.lines.current_index) {
+            if (line_index != input->lines.current_index) {
                 // The user changed the line been displayed using the arrows
                 // In this case, we must copy the line shown to the current line buffer
                 // This way we don't lose the command history
-                copy_string_at_index(&input_stream.lines, line_index);
+                copy_string_at_index(&input->lines, line_index);
                 // The current line address may have changed when merging lines
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 // Reset auxiliar variables used to iterate over the linked list of strings
                 previous_direction = true;
                 auxiliar_index = INVALID_STRING_INDEX;
             }
-            const String_Length length = get_node_from_index(&input_stream.lines, line_index)->length;
+            const String_Length length = get_node_from_index(&input->lines, line_index)->length;
             putchar(c);  // Echo character
             if (position < length) {
                 // Update line to the output
-                print_chars_at_index(&input_stream.lines, line_index, position);
+                print_chars_at_index(&input->lines, line_index, position);
                 // Restores cursor position
                 move_cursor_to_column(stdout, (int)(position + command.length + 2));
             }
-            if (add_char_at(&input_stream.lines, c, position)) {
+            if (add_char_at(&input->lines, c, position)) {
                 putchar('\n');
-                print_error("You typed a expression that consumed all the input buffer! You may try again...\n\n");
+                print_error(input->diagnostics, "You typed a expression that consumed all the input buffer! You may try again...\n\n");
                 print_string(command);
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 position = 0;
             } else {
                 // The current line address may have changed when merging lines
-                line_index = input_stream.lines.current_index;
+                line_index = input->lines.current_index;
                 position++;
             }
         } break;
@@ -316,9 +322,9 @@ struct String get_line_from_input(void) {
     }
 }
 
-void print_previous_lines(void) {
+void print_previous_lines(struct Input_Stream *const input) {
     printf("Previous typed lines:\n");
-    print_string_buffer(&input_stream.lines);
+    print_string_buffer(&input->lines);
     printf("\n");
 }
 
@@ -27,11 +27,32 @@
 #ifndef __INPUT_STREAM
 #define __INPUT_STREAM
 
+#include <stdbool.h>
+
 #include "data-structures/string_buffer.h"
+#include "platform.h"
+#include "printing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Lines typed by the user, which can be navigated with the arrow keys
+struct Input_Stream {
+    struct String_Buffer lines;
+    struct Terminal terminal;
+    struct Diagnostics *diagnostics;
+    // Contexts that aren't driven by a user (servers, libraries) never read the terminal
+    bool is_interactive;
+};
 
-void initialize_input_stream(void);
-struct String get_line_from_input(void);
-void print_previous_lines(void);
+struct Input_Stream create_input_stream(struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
+// The returned string is valid until the next call to this function
+struct String get_line_from_input(struct Input_Stream *const input)
+    __attribute__((nonnull));
+void print_previous_lines(struct Input_Stream *const input)
+    __attribute__((nonnull));
 
 #endif  // __INPUT_STREAM
 
@@ -0,0 +1,469 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "journal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "platform.h"
+#include "printing.h"
+#include "snapshot.h"
+#include "variables.h"
+
+#define JOURNAL_VERSION 1
+#define JOURNAL_BYTE_ORDER 0x01020304u
+// Size of the segment that triggers its compaction
+#define JOURNAL_COMPACTION_SIZE (8u * 1024u * 1024u)
+
+static const char journal_magic[8] = {'L', 'I', 'I', 'R', 'J', 'R', 'N', 'L'};
+
+struct Journal_File_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+};
+
+enum Journal_Record_Type {
+    JOURNAL_ASSIGNMENT = 'A',
+    JOURNAL_DELETION = 'D',
+    JOURNAL_CLEAR = 'C',
+};
+
+// Each record is followed by the name of the variable and,
+// for assignments, by its value. The checksum covers all of it
+struct Journal_Record_Header {
+    uint32_t checksum;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t name_length;
+};
+
+_Static_assert(sizeof(struct Journal_Record_Header) == 8, "The journal records must be packed");
+
+// FNV-1a hash, used to detect records partially written by a crash
+static uint32_t checksum(uint32_t hash, const void *const data, const size_t size) {
+    const uint8_t *const bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t record_checksum(const struct Journal_Record_Header *const header, const char *const name, const double *const value) {
+    uint32_t hash = 2166136261u;
+    hash = checksum(hash, &header->type, sizeof(header->type));
+    hash = checksum(hash, &header->name_length, sizeof(header->name_length));
+    hash = checksum(hash, name, header->name_length);
+    if (value != NULL) {
+        hash = checksum(hash, value, sizeof(*value));
+    }
+    return hash;
+}
+
+static char *concat_strings(const char *const first, const char *const second) {
+    const size_t first_length = strlen(first);
+    const size_t second_length = strlen(second);
+    char *const result = malloc(first_length + second_length + 1);
+    if (result == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the journal!\n");
+    }
+    memcpy(result, first, first_length);
+    memcpy(&result[first_length], second, second_length + 1);
+    return result;
+}
+
+static bool file_exists(const char *const file_name) {
+    FILE *const file = fopen(file_name, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+// Applies the records of a segment to the variables. Returns true if found an error
+static bool replay_segment(struct Variables *const vars, const char *const file_name) {
+    if (!file_exists(file_name)) {
+        return false;
+    }
+    size_t size = 0;
+    const uint8_t *const data = map_file(file_name, &size);
+    if (data == NULL) {
+        if (errno == EINVAL) {
+            // Empty segment
+            return false;
+        }
+        print_error(vars->diagnostics, "Couldn't read the journal \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    const struct Journal_File_Header *const file_header = (const struct Journal_File_Header *)data;
+    if ((size < sizeof(*file_header)) || (memcmp(file_header->magic, journal_magic, sizeof(journal_magic)) != 0)
+        || (file_header->version != JOURNAL_VERSION) || (file_header->byte_order != JOURNAL_BYTE_ORDER)) {
+        print_error(vars->diagnostics, "The file \"%s\" is not a valid journal!\n", file_name);
+        unmap_file(data, size);
+        return true;
+    }
+    size_t records = 0;
+    size_t offset = sizeof(*file_header);
+    while ((offset + sizeof(struct Journal_Record_Header)) <= size) {
+        struct Journal_Record_Header header;
+        memcpy(&header, &data[offset], sizeof(header));
+        const bool has_value = (header.type == JOURNAL_ASSIGNMENT);
+        const size_t record_size = sizeof(header) + header.name_length + (has_value ? sizeof(double) : 0);
+        if ((offset + record_size) > size) {
+            break;
+        }
+        const char *const name = (const char *)&data[offset + sizeof(header)];
+        double value = 0.0;
+        if (has_value) {
+            memcpy(&value, &name[header.name_length], sizeof(value));
+        }
+        if (record_checksum(&header, name, has_value ? &value : NULL) != header.checksum) {
+            break;
+        }
+        const struct String string_name = create_sized_string((char *)name, header.name_length);
+        switch (header.type) {
+        case JOURNAL_ASSIGNMENT:
+            assign_variable(vars, string_name, value);
+            break;
+        case JOURNAL_DELETION:
+            delete_variable(vars, string_name);
+            break;
+        case JOURNAL_CLEAR:
+            clear_variables(vars);
+            break;
+        }
+        records++;
+        offset += record_size;
+    }
+    if (offset != size) {
+        print_warning(vars->diagnostics, "Ignored %zu bytes of an incomplete record at the end of the journal \"%s\"\n", size - offset, file_name);
+    }
+    printf("Replayed %zu records from the journal \"%s\"\n", records, file_name);
+    unmap_file(data, size);
+    return false;
+}
+
+// Starts a new segment. Returns true if found an error
+static bool create_segment(struct Journal *const journal) {
+    journal->file = fopen(journal->file_name, "wb");
+    if (journal->file == NULL) {
+        print_error(journal->vars->diagnostics, "Couldn't create the journal \"%s\", because of the following error: %s\n", journal->file_name, strerror(errno));
+        return true;
+    }
+    // The records are buffered by the journal itself
+    setvbuf(journal->file, NULL, _IONBF, 0);
+    struct Journal_File_Header header = (struct Journal_File_Header){
+        .version = JOURNAL_VERSION,
+        .byte_order = JOURNAL_BYTE_ORDER,
+    };
+    memcpy(header.magic, journal_magic, sizeof(header.magic));
+    if ((fwrite(&header, sizeof(header), 1, journal->file) != 1) || !sync_file(journal->file)) {
+        print_error(journal->vars->diagnostics, "Couldn't write to the journal \"%s\"!\n", journal->file_name);
+        fclose(journal->file);
+        journal->file = NULL;
+        return true;
+    }
+    journal->segment_size = sizeof(header);
+    journal->last_flush = monotonic_time_ns();
+    return false;
+}
+
+bool open_journal(struct Journal *const journal, struct Variables *const vars, const char *const file_name) {
+    *journal = (struct Journal){
+        .vars = vars,
+    };
+    journal->file_name = concat_strings(file_name, "");
+    journal->old_segment_name = concat_strings(file_name, ".old");
+    journal->snapshot_name = concat_strings(file_name, ".snap");
+    const bool recover = file_exists(journal->snapshot_name) || file_exists(journal->old_segment_name) || file_exists(journal->file_name);
+    if (recover) {
+        if (file_exists(journal->snapshot_name) && restore_snapshot(vars, create_string(journal->snapshot_name))) {
+            return true;
+        }
+        if (replay_segment(vars, journal->old_segment_name) || replay_segment(vars, journal->file_name)) {
+            return true;
+        }
+        // Start over from a snapshot of the recovered state, so that the new records
+        // are never appended after an incomplete record left by a crash
+        if (save_snapshot(vars, create_string(journal->snapshot_name))) {
+            return true;
+        }
+        remove(journal->old_segment_name);
+    }
+    if (create_segment(journal)) {
+        return true;
+    }
+    vars->journal = journal;
+    return false;
+}
+
+// Writes the buffered records to the file. Returns true if found an error
+static bool write_records(struct Journal *const journal) {
+    if (journal->used == 0) {
+        return false;
+    }
+    const bool error = (fwrite(journal->buffer, sizeof(uint8_t), journal->used, journal->file) != journal->used);
+    journal->segment_size += journal->used;
+    journal->used = 0;
+    if (error) {
+        print_error(journal->vars->diagnostics, "Couldn't write to the journal \"%s\"!\n", journal->file_name);
+    }
+    return error;
+}
+
+void flush_journal(struct Journal *const journal) {
+    if ((journal->file == NULL) || (journal->pending_since == 0)) {
+        return;
+    }
+    if (!write_records(journal)) {
+        sync_file(journal->file);
+    }
+    journal->pending_since = 0;
+    journal->last_flush = monotonic_time_ns();
+}
+
+static void append_record(struct Journal *const journal, const enum Journal_Record_Type type, const struct String name, const double *const value) {
+    struct Journal_Record_Header header = (struct Journal_Record_Header){
+        .type = (uint8_t)type,
+        .name_length = name.length,
+    };
+    header.checksum = record_checksum(&header, name.data, value);
+    const size_t record_size = sizeof(header) + name.length + ((value != NULL) ? sizeof(*value) : 0);
+    if (journal->pending_since == 0) {
+        journal->pending_since = monotonic_time_ns();
+    }
+    if ((journal->used + record_size) > JOURNAL_BUFFER_SIZE) {
+        write_records(journal);
+    }
+    if (record_size > JOURNAL_BUFFER_SIZE) {
+        // Too large to be buffered
+        if ((journal->file != NULL)
+            && ((fwrite(&header, sizeof(header), 1, journal->file) != 1)
+                || (fwrite(name.data, sizeof(char), name.length, journal->file) != name.length)
+                || ((value != NULL) && (fwrite(value, sizeof(*value), 1, journal->file) != 1)))) {
+            print_error(journal->vars->diagnostics, "Couldn't write to the journal \"%s\"!\n", journal->file_name);
+        }
+        journal->segment_size += record_size;
+        return;
+    }
+    uint8_t *const destination = &journal->buffer[journal->used];
+    memcpy(destination, &header, sizeof(header));
+    memcpy(&destination[sizeof(header)], name.data, name.length);
+    if (value != NULL) {
+        memcpy(&destination[sizeof(header) + name.length], value, sizeof(*value));
+    }
+    journal->used += record_size;
+}
+
+void journal_assignment(struct Journal *const journal, const struct String name, const double value) {
+    append_record(journal, JOURNAL_ASSIGNMENT, name, &value);
+}
+
+void journal_deletion(struct Journal *const journal, const struct String name) {
+    append_record(journal, JOURNAL_DELETION, name, NULL);
+}
+
+void journal_clear(struct Journal *const journal) {
+    append_record(journal, JOURNAL_CLEAR, (struct String){0}, NULL);
+}
+
+static void *compaction_thread(void *const arg) {
+    struct Journal_Compaction *const compaction = arg;
+    compaction->error = save_snapshot(&compaction->vars, create_string(compaction->snapshot_name));
+    if (!compaction->error) {
+        // The records of the old segment are all in the snapshot now
+        remove(compaction->old_segment_name);
+    }
+    array_del(compaction->vars.list);
+    free(compaction->names);
+    atomic_store(&compaction->done, true);
+    return NULL;
+}
+
+static void wait_compaction(struct Journal *const journal) {
+    if (journal->compaction.running) {
+        pthread_join(journal->compaction.thread, NULL);
+        journal->compaction.running = false;
+        if (journal->compaction.error) {
+            // The old segment must be kept, so no other compaction can rotate the segments
+            print_warning(journal->vars->diagnostics, "The compaction of the journal failed, it will keep growing until the next session\n");
+            journal->compaction_failed = true;
+        }
+    }
+}
+
+// Copies the variables, so that the snapshot can be written while they keep changing
+static void freeze_variables(struct Journal_Compaction *const compaction, struct Variables *const vars) {
+    const size_t count = array_size(vars->list);
+    size_t names_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        names_size += vars->list[i].name.length;
+    }
+    compaction->diagnostics = create_diagnostics(stderr);
+    compaction->vars = (struct Variables){
+        .diagnostics = &compaction->diagnostics,
+    };
+    compaction->vars.list = array_new(sizeof(struct Variable), count + 1);
+    compaction->names = malloc(names_size + 1);
+    if ((compaction->vars.list == NULL) || (compaction->names == NULL)) {
+        print_crash_and_exit("Couldn't allocate memory for the compaction of the journal!\n");
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        const struct String name = vars->list[i].name;
+        memcpy(&compaction->names[offset], name.data, name.length);
+        compaction->vars.list[i] = (struct Variable){
+            .name = create_sized_string(&compaction->names[offset], name.length),
+            .value = vars->list[i].value,
+        };
+        offset += name.length;
+    }
+    array_size(compaction->vars.list) = count;
+}
+
+// Returns true if the compaction couldn't be started
+static bool compact_journal(struct Journal *const journal) {
+    if (journal->compaction_failed || (journal->file == NULL)) {
+        return true;
+    }
+    flush_journal(journal);
+    fclose(journal->file);
+    journal->file = NULL;
+    if (!replace_file(journal->file_name, journal->old_segment_name)) {
+        journal->compaction_failed = true;
+        // Keep appending to the current segment
+        journal->file = fopen(journal->file_name, "ab");
+        return true;
+    }
+    if (create_segment(journal)) {
+        journal->compaction_failed = true;
+        return true;
+    }
+    struct Journal_Compaction *const compaction = &journal->compaction;
+    freeze_variables(compaction, journal->vars);
+    compaction->snapshot_name = journal->snapshot_name;
+    compaction->old_segment_name = journal->old_segment_name;
+    compaction->error = false;
+    atomic_store(&compaction->done, false);
+    if (pthread_create(&compaction->thread, NULL, compaction_thread, compaction) != 0) {
+        // Do it in the foreground
+        compaction_thread(compaction);
+        compaction->running = false;
+        journal->compaction_failed = compaction->error;
+        return compaction->error;
+    }
+    compaction->running = true;
+    return false;
+}
+
+uint64_t journal_deadline(const struct Journal *const journal) {
+    if (journal->pending_since == 0) {
+        return UINT64_MAX;
+    }
+    // After a pause, the first records are written at once, and the ones that follow wait for the interval
+    const uint64_t next_flush = journal->last_flush + JOURNAL_COMMIT_INTERVAL_NS;
+    return (journal->pending_since > next_flush) ? journal->pending_since : next_flush;
+}
+
+void commit_journal(struct Journal *const journal) {
+    if ((journal->pending_since != 0) && (monotonic_time_ns() >= journal_deadline(journal))) {
+        flush_journal(journal);
+    }
+    if (journal->segment_size >= JOURNAL_COMPACTION_SIZE) {
+        if (journal->compaction.running) {
+            if (!atomic_load(&journal->compaction.done)) {
+                // Try again later
+                return;
+            }
+            wait_compaction(journal);
+        }
+        compact_journal(journal);
+    }
+}
+
+void checkpoint_journal(struct Journal *const journal) {
+    wait_compaction(journal);
+    if (compact_journal(journal)) {
+        // Fallback: record the current value of every variable
+        struct Variables *const vars = journal->vars;
+        for (size_t i = 0; i < array_size(vars->list); i++) {
+            journal_assignment(journal, vars->list[i].name, vars->list[i].value);
+        }
+        flush_journal(journal);
+    }
+}
+
+void close_journal(struct Journal *const journal) {
+    flush_journal(journal);
+    wait_compaction(journal);
+    if (journal->file != NULL) {
+        fclose(journal->file);
+        journal->file = NULL;
+    }
+    if (journal->vars != NULL) {
+        journal->vars->journal = NULL;
+        journal->vars = NULL;
+    }
+    free(journal->file_name);
+    free(journal->old_segment_name);
+    free(journal->snapshot_name);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,161 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __JOURNAL
+#define __JOURNAL
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "data-structures/sized_string.h"
+#include "variables.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Optional write-ahead journal of the changes made to the variables.
+// Every assignment, deletion and clear is appended to the current segment
+// of the journal as a small binary record. The records are buffered and
+// written together (group commit), so a burst of assignments costs a single
+// write and a single flush to the disk. When the segment grows too large,
+// it is compacted in background into a snapshot (see snapshot.h).
+// Files used, for a journal named "name":
+//   name       current segment, which receives the new records
+//   name.old   previous segment, only present while it is being compacted
+//   name.snap  snapshot on top of which the segments are replayed
+// Replaying a segment over a snapshot that already contains some of its
+// records is harmless, because the records are idempotent. Because of
+// this, a crash at any point of the compaction never loses data.
+// Durability: a change is written and flushed to the disk (fsync) by the
+// first commit_journal after its deadline, which is at most
+// JOURNAL_COMMIT_INTERVAL_NS after the change, or at once if the previous
+// flush is older than that. The modes that wait for input flush the
+// pending records before waiting: the REPL after each line, --coprocess
+// and --stream when a read drains their input, and --watch after each
+// update. --serve doesn't sleep past the deadline of the pending records,
+// so they are flushed even if no other request arrives. Every mode flushes
+// at exit. So a crash of the process, even by SIGKILL, loses at most the
+// changes of the last JOURNAL_COMMIT_INTERVAL_NS, whose replies may
+// already have been sent. A crash of the operating system may lose more
+// if the disk ignores fsync.
+
+#define JOURNAL_BUFFER_SIZE (64 * 1024)
+// Records produced during this interval after a flush are written together
+#define JOURNAL_COMMIT_INTERVAL_NS (10u * 1000u * 1000u)
+
+struct Journal_Compaction {
+    pthread_t thread;
+    bool running;
+    atomic_bool done;
+    bool error;
+    // Copy of the variables at the moment the segment was rotated
+    struct Variables vars;
+    char *names;
+    // The snapshot is written by another thread, so its errors can't be sent to the context
+    struct Diagnostics diagnostics;
+    char *snapshot_name;
+    char *old_segment_name;
+};
+
+struct Journal {
+    struct Variables *vars;
+    FILE *file;
+    char *file_name;
+    char *old_segment_name;
+    char *snapshot_name;
+    uint64_t last_flush;  // Monotonic time of the last flush
+    uint64_t pending_since;  // Monotonic time of the oldest record not yet flushed, or 0 if there are none
+    size_t segment_size;  // Bytes written to the current segment
+    bool compaction_failed;
+    struct Journal_Compaction compaction;
+    // Records not yet written to the file
+    size_t used;
+    uint8_t buffer[JOURNAL_BUFFER_SIZE];
+};
+
+// Recovers the state saved by a previous session (if any) and attaches
+// the journal to the variables. Returns true if found an error
+bool open_journal(struct Journal *const journal, struct Variables *const vars, const char *const file_name)
+    __attribute__((nonnull));
+// Writes the pending records, waits for the compaction and detaches the journal
+void close_journal(struct Journal *const journal)
+    __attribute__((nonnull));
+// Functions called by variables.c whenever a variable changes
+void journal_assignment(struct Journal *const journal, const struct String name, const double value)
+    __attribute__((nonnull));
+void journal_deletion(struct Journal *const journal, const struct String name)
+    __attribute__((nonnull));
+void journal_clear(struct Journal *const journal)
+    __attribute__((nonnull));
+// Should be called after each evaluated line. The pending records are written
+// if their deadline has passed, and the segment is compacted if needed
+void commit_journal(struct Journal *const journal)
+    __attribute__((nonnull));
+// Monotonic time after which commit_journal writes the pending records, or
+// UINT64_MAX if there are none. Used as the timeout of the modes that wait
+uint64_t journal_deadline(const struct Journal *const journal)
+    __attribute__((nonnull));
+// Writes the pending records and flushes them to the disk at once, called
+// before waiting for input, so that no change is held while idle
+void flush_journal(struct Journal *const journal)
+    __attribute__((nonnull));
+// Saves the whole state of the variables, used when they change without
+// going through the functions above (when restoring a snapshot, for instance)
+void checkpoint_journal(struct Journal *const journal)
+    __attribute__((nonnull));
+
+#endif  // __JOURNAL
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
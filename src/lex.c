@@ -41,8 +41,10 @@
 #define DYNAMIC_ARRAY_IMPLEMENTATION
 #include "data-structures/dynamic_array.h"
 
-struct Lexer create_lex(const size_t initial_size) {
-    struct Lexer lexer = (struct Lexer){0};
+struct Lexer create_lex(const size_t initial_size, struct Diagnostics *const diagnostics) {
+    struct Lexer lexer = (struct Lexer){
+        .diagnostics = diagnostics,
+    };
     lexer.tokens = array_new(sizeof(struct Token), initial_size);
     if (lexer.tokens == NULL) {
         print_crash_and_exit("Couldn't allocate memory for the lexer!\n");
@@ -123,8 +125,8 @@ bool lex(struct Lexer *const lexer, struct String line) {
                 break;
             }
             default: {
-                print_column(column);
-                print_error("Unrecognized character at lexical analysis: %c\n", c);
+                print_column(lexer->diagnostics, column);
+                print_error(lexer->diagnostics, "Unrecognized character at lexical analysis: %c\n", c);
                 return true;
             }
             }
@@ -134,8 +136,8 @@ bool lex(struct Lexer *const lexer, struct String line) {
             const struct Token last_token = array_last(lexer->tokens);
             if ((last_token.type == TOK_FUNCTION) && (functions[last_token.function_index].arity >= 1)) {
                 if ((tok.type == TOK_DELIMITER) && (tok.op != '(')) {
-                    print_column(last_token.column);
-                    print_error("Functions that accept one or more argument, must be followed by parentheses \'(\'!\n");
+                    print_column(lexer->diagnostics, last_token.column);
+                    print_error(lexer->diagnostics, "Functions that accept one or more argument, must be followed by parentheses \'(\'!\n");
                     return true;
                 }
             }
@@ -147,8 +149,8 @@ bool lex(struct Lexer *const lexer, struct String line) {
     if (array_size(lexer->tokens) > 0) {
         const struct Token last_token = array_last(lexer->tokens);
         if ((last_token.type == TOK_FUNCTION) && (functions[last_token.function_index].arity >= 1)) {
-            print_column(last_token.column);
-            print_error("Functions with one or more argument must be followed by parentheses \'(\'!\n");
+            print_column(lexer->diagnostics, last_token.column);
+            print_error(lexer->diagnostics, "Functions with one or more argument must be followed by parentheses \'(\'!\n");
             return true;
         }
     }
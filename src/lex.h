@@ -31,6 +31,7 @@
 #include <stdlib.h>
 
 #include "data-structures/sized_string.h"
+#include "printing.h"
 
 #if !defined(__GNUC__) && !defined(__attribute__)
 #define __attribute__(a)
@@ -59,9 +60,11 @@ struct Token {
 struct Lexer {
     // Dynamic array used to store the list of tokens
     struct Token *tokens;
+    struct Diagnostics *diagnostics;
 };
 
-struct Lexer create_lex(const size_t initial_size);
+struct Lexer create_lex(const size_t initial_size, struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
 void destroy_lex(struct Lexer *const lexer)
     __attribute__((nonnull));
 bool lex(struct Lexer *const lexer, const struct String line)
@@ -0,0 +1,171 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "liir.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/sized_string.h"
+#include "functions.h"
+#include "parser.h"
+#include "printing.h"
+#include "variables.h"
+
+struct Liir_Context {
+    struct Context context;
+    Liir_Diagnostic_Callback callback;
+    void *user_data;
+};
+
+struct Liir_Context *liir_ctx_create(void) {
+    struct Liir_Context *const ctx = malloc(sizeof(struct Liir_Context));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    create_context(&ctx->context, stderr);
+    // The built-in functions can't prompt the user for file names
+    ctx->context.input.is_interactive = false;
+    ctx->callback = NULL;
+    ctx->user_data = NULL;
+    return ctx;
+}
+
+void liir_ctx_destroy(struct Liir_Context *const ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    destroy_context(&ctx->context);
+    free(ctx);
+}
+
+// Translates the internal diagnostics to the public interface
+static void forward_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    struct Liir_Context *const ctx = user_data;
+    const enum Liir_Diagnostic_Level level = (diagnostic->level == DIAGNOSTIC_ERROR) ? Liir_Diagnostic_Error : Liir_Diagnostic_Warning;
+    const size_t column = diagnostic->column;
+    ctx->callback(ctx->user_data, level, (column == NO_DIAGNOSTIC_COLUMN) ? LIIR_NO_COLUMN : column, diagnostic->message);
+}
+
+void liir_set_diagnostic_callback(struct Liir_Context *const ctx, const Liir_Diagnostic_Callback callback, void *const user_data) {
+    if (ctx == NULL) {
+        return;
+    }
+    ctx->callback = callback;
+    ctx->user_data = user_data;
+    ctx->context.diagnostics.callback = (callback != NULL) ? forward_diagnostic : NULL;
+    ctx->context.diagnostics.user_data = ctx;
+    ctx->context.diagnostics.column = NO_DIAGNOSTIC_COLUMN;
+}
+
+enum Liir_Status liir_eval(struct Liir_Context *const ctx, const char *const str, const size_t length, double *const result) {
+    if ((ctx == NULL) || (str == NULL) || (length > UINT16_MAX)) {
+        return Liir_Error;
+    }
+    const struct String line = create_sized_string((char *)str, (String_Length)length);
+    double value = 0.0;
+    switch (evaluate_line(&ctx->context, line, &value)) {
+    case Eval_OK:
+        if (result != NULL) {
+            *result = value;
+        }
+        return Liir_OK;
+    case Eval_Dont_Print:
+        return Liir_No_Value;
+    case Eval_Error:
+        break;
+    }
+    return Liir_Error;
+}
+
+// Returns the name as a String, or an empty one if it isn't a valid variable name
+static struct String validate_name(const char *const name) {
+    const size_t length = strlen(name);
+    if ((length == 0) || (length > UINT16_MAX)) {
+        return (struct String){0};
+    }
+    const struct String str = create_sized_string((char *)name, (String_Length)length);
+    if ((parse_name(str).length != str.length) || (search_function(str) < functions_quantity)) {
+        return (struct String){0};
+    }
+    return str;
+}
+
+bool liir_set_variable(struct Liir_Context *const ctx, const char *const name, const double value) {
+    if ((ctx == NULL) || (name == NULL)) {
+        return true;
+    }
+    const struct String str = validate_name(name);
+    if (str.length == 0) {
+        print_error(&ctx->context.diagnostics, "\"%s\" is not a valid name!\n", name);
+        return true;
+    }
+    assign_variable(&ctx->context.vars, str, value);
+    return false;
+}
+
+bool liir_get_variable(struct Liir_Context *const ctx, const char *const name, double *const value) {
+    if ((ctx == NULL) || (name == NULL) || (value == NULL)) {
+        return true;
+    }
+    const struct String str = validate_name(name);
+    size_t index;
+    if ((str.length == 0) || (search_variable(&ctx->context.vars, str, &index) != EXIT_SUCCESS)) {
+        return true;
+    }
+    *value = get_variable_value(&ctx->context.vars, index);
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,113 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __LIIR
+#define __LIIR
+
+// Public interface of libliir, which allows the interpreter to be embedded
+// in other programs. The library is built by "make lib" and this is the only
+// header that must be distributed with it.
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The library is built with hidden visibility, so only these functions are exported
+#ifdef _WIN32
+    #define LIIR_API __declspec(dllexport)
+#else
+    #define LIIR_API __attribute__((visibility("default")))
+#endif
+
+// Holds the lexer, the parser and the variables of an interpreter. Contexts
+// share no mutable state, so each thread may use its own context without locks
+struct Liir_Context;
+
+enum Liir_Status {
+    Liir_OK = 0,
+    Liir_No_Value,  // The expression was valid but produced no value (e.g. an empty line or "clear")
+    Liir_Error,     // The diagnostics were sent to the diagnostic callback
+};
+
+enum Liir_Diagnostic_Level {
+    Liir_Diagnostic_Error,
+    Liir_Diagnostic_Warning,
+};
+
+// Column of the expression to which the diagnostic refers, if any
+#define LIIR_NO_COLUMN ((size_t)-1)
+
+// The message has no trailing new line, and is only valid during the call
+typedef void (*Liir_Diagnostic_Callback)(void *user_data, enum Liir_Diagnostic_Level level, size_t column, const char *message);
+
+// Returns NULL if couldn't allocate the context
+LIIR_API struct Liir_Context *liir_ctx_create(void);
+LIIR_API void liir_ctx_destroy(struct Liir_Context *const ctx);
+// By default, the diagnostics are printed to stderr. A NULL callback restores this behaviour
+LIIR_API void liir_set_diagnostic_callback(struct Liir_Context *const ctx, const Liir_Diagnostic_Callback callback, void *const user_data);
+
+// Evaluates the expression of length bytes pointed by str (it doesn't need to be null terminated).
+// Assignments update the variables of the context. The result is only written on Liir_OK
+LIIR_API enum Liir_Status liir_eval(struct Liir_Context *const ctx, const char *const str, const size_t length, double *const result);
+
+// The name must be a null terminated string. These functions return true if found an error
+LIIR_API bool liir_set_variable(struct Liir_Context *const ctx, const char *const name, const double value);
+LIIR_API bool liir_get_variable(struct Liir_Context *const ctx, const char *const name, double *const value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LIIR
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -24,28 +24,43 @@
 // SOURCE
 //------------------------------------------------------------------------------
 
+#include <errno.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "batch.h"
+#include "benchmark.h"
+#include "context.h"
+#include "coprocess.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
 #include "data-structures/sized_string.h"
+#include "evaluation_profile.h"
 #include "functions.h"
 #include "input_stream.h"
+#include "journal.h"
 #include "lex.h"
+#include "metrics.h"
 #include "parser.h"
+#include "perf_counters.h"
 #include "printing.h"
+#include "recording.h"
+#include "result_output.h"
+#include "sampling_profiler.h"
+#include "script.h"
+#include "server.h"
+#include "session.h"
+#include "slow_log.h"
+#include "snapshot.h"
+#include "stream.h"
+#include "timing.h"
+#include "trace.h"
 #include "variables.h"
-
-enum Actions {
-    ACTION_EXIT = 1,
-    ACTION_PRINT_TOKENS = 2,
-    ACTION_PRINT_TREE = 4,
-    ACTION_PRINT_GRAPH = 8,
-    ACTION_PRINT_VARIABLES = 16,
-    ACTION_PRINT_LINES = 32,
-};
+#include "watch.h"
 
 typedef void (*Arg_Function)(const char *const parameter);
 
@@ -61,41 +76,125 @@ static void arguments_usage(const char *const parameter);
 static void set_print_tokens(const char *const parameter);
 static void set_print_tree(const char *const parameter);
 static void set_print_graph(const char *const parameter);
+static void set_print_timing(const char *const parameter);
+static void set_perf_counters(const char *const parameter);
+static void set_explain_format(const char *const parameter);
+static void set_print_memory_stats(const char *const parameter);
+static void set_metrics_file(const char *const parameter);
+static void set_trace_file(const char *const parameter);
+static void set_trace_threshold(const char *const parameter);
+static void set_profile_file(const char *const parameter);
 static void set_print_variables(const char *const parameter);
 static void display_functions(const char *const parameter);
 static void set_print_lines(const char *const parameter);
 static void set_expression_to_evaluate(const char *const parameter);
 static void set_file_name_to_load(const char *const parameter);
+static void set_snapshot_to_restore(const char *const parameter);
+static void set_snapshot_to_save(const char *const parameter);
+static void set_journal_file(const char *const parameter);
+static void set_socket_to_serve(const char *const parameter);
+static void set_coprocess_mode(const char *const parameter);
+static void set_batch_file(const char *const parameter);
+static void set_script_file(const char *const parameter);
+static void set_output_file(const char *const parameter);
+static void set_file_to_watch(const char *const parameter);
+static void set_stream_file(const char *const parameter);
+static void set_window_size(const char *const parameter);
+static void set_diagnostics_format(const char *const parameter);
+static void set_recording_file(const char *const parameter);
+static void set_replay_file(const char *const parameter);
+static void set_expression_to_benchmark(const char *const parameter);
+static void set_iterations(const char *const parameter);
+static void set_slow_log_file(const char *const parameter);
+static void set_slow_log_threshold(const char *const parameter);
 static void display_version(const char *const parameter);
 
 static inline int find_argument(const char *const arg)
     __attribute__((nonnull));
 static bool parse_arguments(const int argc, const char *const argv[]);
 
-static void interpret(struct Parser *const parser, const struct String line)
-    __attribute__((nonnull));
-
 static const struct Arg_Cmd arg_list[] = {
     {"--help", arguments_usage, false, "Display this help message."},
     {"--token", set_print_tokens, false, "Display the list of tokens generated by lexical analysis."},
     {"--ast", set_print_tree, false, "Display the abstract syntax tree (AST) generated by the parser."},
     {"--graph", set_print_graph, false, "Display a graph representation of the abstract syntax tree (AST)."},
+    {"--timing", set_print_timing, false, "Display the time spent in each phase of each line, and a summary at exit."},
+    {"--perf-counters", set_perf_counters, false, "Display the hardware counters (cycles, instructions and misses) of each phase of each line, and a summary at exit (Linux only)."},
+    {"--trace", set_trace_file, true, "Write the phases of each line, the slow built-in calls and the file I/O to the specified file, in the trace event format of Chrome (see trace.h)."},
+    {"--trace-threshold", set_trace_threshold, true, "Minimum duration in nanoseconds of the built-in calls written by --trace (1000 by default)."},
+    {"--profile", set_profile_file, true, "Sample the line and the built-in function being executed every millisecond of CPU time, and write the samples to the specified file as folded stacks, for flame graphs (POSIX only)."},
     {"--memory", set_print_variables, false, "Display the variables names and values at each step."},
+    {"--memstats", set_print_memory_stats, false, "Display the heap memory used by the arrays, variable names and file buffers at exit."},
+    {"--metrics-file", set_metrics_file, true, "Write the number of lines, the errors and the latency of each phase to the specified file every 10 seconds and at exit, in the text format of Prometheus."},
     {"--function", display_functions, false, "Display the built-in functions."},
     {"--input", set_print_lines, false, "Display the previous typed lines at each step."},
     {"--expr", set_expression_to_evaluate, true, "Evaluate a single expression passed by command line."},
+    {"--explain", set_explain_format, true, "Display the abstract syntax tree annotated with the visits and time of each node, as a tree or graph, and the time of each built-in function at exit."},
     {"--load", set_file_name_to_load, true, "Load the variables from the specified file."},
+    {"--restore", set_snapshot_to_restore, true, "Restore the variables from the specified binary snapshot file."},
+    {"--snapshot", set_snapshot_to_save, true, "Save the variables to the specified binary snapshot file at exit."},
+    {"--journal", set_journal_file, true, "Record every change to the variables in the specified journal, and recover them from it."},
+    {"--serve", set_socket_to_serve, true, "Evaluate the expressions sent by clients to the specified Unix socket (Linux only)."},
+    {"--coprocess", set_coprocess_mode, false, "Answer the requests read from stdin with a framed protocol (see coprocess.h)."},
+    {"--batch", set_batch_file, true, "Evaluate each line of the specified file, parsing the lines in parallel."},
+    {"--parallel", set_script_file, true, "Evaluate each line of the specified file, running the lines that don't depend on each other in parallel."},
+    {"--output", set_output_file, true, "Write the results of --batch, --parallel or --stream to the specified file as binary float64 (see result_output.h)."},
+    {"--watch", set_file_to_watch, true, "Evaluate each line of the specified file again whenever it is saved (Linux only)."},
+    {"--stream", set_stream_file, true, "Evaluate the expression of --expr for each number read from the specified file or FIFO (- for stdin), see stream.h."},
+    {"--window", set_window_size, true, "Number of samples in the window of --stream (10 by default)."},
+    {"--diagnostics", set_diagnostics_format, true, "Format of the errors and warnings: text (default) or json, with one object per line."},
+    {"--record", set_recording_file, true, "Record the variables and every line typed, with its timing, in the specified file."},
+    {"--replay", set_replay_file, true, "Evaluate the lines of the specified recording as fast as possible and report the latency."},
+    {"--bench", set_expression_to_benchmark, true, "Evaluate the specified expression repeatedly and report the time taken by each evaluation."},
+    {"--iterations", set_iterations, true, "Number of evaluations made by --bench (1000000 by default)."},
+    {"--slow-log", set_slow_log_file, true, "Append the lines whose lexer, parser and evaluation take longer than --slow-log-threshold to the specified file, with their timing, tree size and deepest variable lookup."},
+    {"--slow-log-threshold", set_slow_log_threshold, true, "Minimum duration in nanoseconds of the lines written by --slow-log (10000000 by default)."},
     {"--version", display_version, false, "Display the version."},
 };
 static const int arg_num = (sizeof(arg_list) / sizeof(arg_list[0]));
 static const char *software = NULL;
+// Actions requested by the command line arguments, copied to the context
 static enum Actions actions = 0;
 static struct String command_line_expression = {0};
 static const char *file_name_to_load = NULL;
-
-unsigned int max_uint(const unsigned int a, const unsigned int b) {
-    return ((a > b) ? a : b);
-}
+static const char *snapshot_to_restore = NULL;
+static const char *snapshot_to_save = NULL;
+static const char *journal_file = NULL;
+static const char *socket_to_serve = NULL;
+static bool coprocess_mode = false;
+static const char *batch_file = NULL;
+static const char *script_file = NULL;
+static const char *output_file = NULL;
+static const char *file_to_watch = NULL;
+static const char *stream_file = NULL;
+static size_t window_size = STREAM_DEFAULT_WINDOW;
+static bool invalid_arguments = false;
+static enum Diagnostic_Format diagnostics_format = DIAGNOSTIC_FORMAT_TEXT;
+static const char *recording_file = NULL;
+static const char *replay_file = NULL;
+static struct String expression_to_benchmark = {0};
+static uint64_t iterations = BENCHMARK_DEFAULT_ITERATIONS;
+// Set while the session is recorded
+static struct Recording *recording = NULL;
+static bool timing_enabled = false;
+// Set by --timing
+static struct Timing timing;
+static bool perf_counters_enabled = false;
+// Set by --perf-counters
+static struct Perf_Counters perf_counters;
+static bool explain_enabled = false;
+static enum Explain_Format explain_format = EXPLAIN_TREE;
+// Set by --explain
+static struct Evaluation_Profile profile;
+static bool memory_stats_enabled = false;
+// Kept at all times, and shown by the built-in function stats
+static struct Metrics metrics;
+static const char *metrics_file = NULL;
+static const char *trace_file = NULL;
+static uint64_t trace_threshold = TRACE_DEFAULT_THRESHOLD_NS;
+static const char *profile_file = NULL;
+static const char *slow_log_file = NULL;
+static uint64_t slow_log_threshold = SLOW_LOG_DEFAULT_THRESHOLD_NS;
 
 static void arguments_usage(const char *const parameter) {
     (void)parameter;
@@ -106,7 +205,13 @@ static void arguments_usage(const char *const parameter) {
     }
     printf("[Options]:\n");
     for (int arg_idx = 0; arg_idx < arg_num; arg_idx++) {
-        printf("\t%-*s or -%c: %s\n", cmd_max_length, arg_list[arg_idx].cmd, arg_list[arg_idx].cmd[2], arg_list[arg_idx].usage);
+        // The alias belongs to the first option that begins with the same letter
+        const char alias[] = {'-', arg_list[arg_idx].cmd[2], '\0'};
+        if (find_argument(alias) == arg_idx) {
+            printf("\t%-*s or -%c: %s\n", cmd_max_length, arg_list[arg_idx].cmd, arg_list[arg_idx].cmd[2], arg_list[arg_idx].usage);
+        } else {
+            printf("\t%-*s      : %s\n", cmd_max_length, arg_list[arg_idx].cmd, arg_list[arg_idx].usage);
+        }
     }
     actions |= ACTION_EXIT;
 }
@@ -126,6 +231,72 @@ static void set_print_graph(const char *const parameter) {
     actions |= ACTION_PRINT_GRAPH;
 }
 
+static void set_print_timing(const char *const parameter) {
+    (void)parameter;
+    timing_enabled = true;
+}
+
+static void set_perf_counters(const char *const parameter) {
+    (void)parameter;
+    perf_counters_enabled = true;
+}
+
+static void set_explain_format(const char *const parameter) {
+    if (parameter == NULL) {
+        return;
+    }
+    if (!strcmp(parameter, "tree")) {
+        explain_format = EXPLAIN_TREE;
+    } else if (!strcmp(parameter, "graph")) {
+        explain_format = EXPLAIN_GRAPH;
+    } else {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        print_error(&diagnostics, "Invalid explain format: %s\n", parameter);
+        invalid_arguments = true;
+        return;
+    }
+    explain_enabled = true;
+}
+
+static void set_print_memory_stats(const char *const parameter) {
+    (void)parameter;
+    memory_stats_enabled = true;
+}
+
+static void set_metrics_file(const char *const parameter) {
+    if (parameter != NULL) {
+        metrics_file = parameter;
+    }
+}
+
+static void set_trace_file(const char *const parameter) {
+    if (parameter != NULL) {
+        trace_file = parameter;
+    }
+}
+
+static void set_trace_threshold(const char *const parameter) {
+    if (parameter == NULL) {
+        return;
+    }
+    char *end = NULL;
+    errno = 0;
+    const unsigned long long value = strtoull(parameter, &end, 10);
+    if ((parameter[0] == '-') || (errno != 0) || (end == parameter) || (*end != '\0')) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        print_error(&diagnostics, "Invalid trace threshold: %s\n", parameter);
+        invalid_arguments = true;
+        return;
+    }
+    trace_threshold = (uint64_t)value;
+}
+
+static void set_profile_file(const char *const parameter) {
+    if (parameter != NULL) {
+        profile_file = parameter;
+    }
+}
+
 static void set_print_variables(const char *const parameter) {
     (void)parameter;
     actions |= ACTION_PRINT_VARIABLES;
@@ -166,6 +337,152 @@ static void set_file_name_to_load(const char *const parameter) {
     }
 }
 
+static void set_snapshot_to_restore(const char *const parameter) {
+    if (parameter != NULL) {
+        snapshot_to_restore = parameter;
+    }
+}
+
+static void set_snapshot_to_save(const char *const parameter) {
+    if (parameter != NULL) {
+        snapshot_to_save = parameter;
+    }
+}
+
+static void set_journal_file(const char *const parameter) {
+    if (parameter != NULL) {
+        journal_file = parameter;
+    }
+}
+
+static void set_socket_to_serve(const char *const parameter) {
+    if (parameter != NULL) {
+        socket_to_serve = parameter;
+    }
+}
+
+static void set_coprocess_mode(const char *const parameter) {
+    (void)parameter;
+    coprocess_mode = true;
+}
+
+static void set_batch_file(const char *const parameter) {
+    if (parameter != NULL) {
+        batch_file = parameter;
+    }
+}
+
+static void set_script_file(const char *const parameter) {
+    if (parameter != NULL) {
+        script_file = parameter;
+    }
+}
+
+static void set_output_file(const char *const parameter) {
+    if (parameter != NULL) {
+        output_file = parameter;
+    }
+}
+
+static void set_file_to_watch(const char *const parameter) {
+    if (parameter != NULL) {
+        file_to_watch = parameter;
+    }
+}
+
+static void set_stream_file(const char *const parameter) {
+    if (parameter != NULL) {
+        stream_file = parameter;
+    }
+}
+
+static void set_window_size(const char *const parameter) {
+    if (parameter == NULL) {
+        return;
+    }
+    char *end = NULL;
+    errno = 0;
+    const unsigned long long size = strtoull(parameter, &end, 10);
+    if ((parameter[0] == '-') || (errno != 0) || (end == parameter) || (*end != '\0') || (size == 0) || (size > SIZE_MAX / sizeof(double))) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        print_error(&diagnostics, "Invalid window size: %s\n", parameter);
+        invalid_arguments = true;
+        return;
+    }
+    window_size = (size_t)size;
+}
+
+static void set_diagnostics_format(const char *const parameter) {
+    if (parameter == NULL) {
+        return;
+    }
+    if (!strcmp(parameter, "text")) {
+        diagnostics_format = DIAGNOSTIC_FORMAT_TEXT;
+    } else if (!strcmp(parameter, "json")) {
+        diagnostics_format = DIAGNOSTIC_FORMAT_JSON;
+    } else {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        print_error(&diagnostics, "Invalid diagnostics format: %s\n", parameter);
+        invalid_arguments = true;
+    }
+}
+
+static void set_recording_file(const char *const parameter) {
+    if (parameter != NULL) {
+        recording_file = parameter;
+    }
+}
+
+static void set_replay_file(const char *const parameter) {
+    if (parameter != NULL) {
+        replay_file = parameter;
+    }
+}
+
+static void set_expression_to_benchmark(const char *const parameter) {
+    if (parameter != NULL) {
+        expression_to_benchmark = create_string((char *)parameter);
+    }
+}
+
+static void set_iterations(const char *const parameter) {
+    if (parameter == NULL) {
+        return;
+    }
+    char *end = NULL;
+    errno = 0;
+    const unsigned long long value = strtoull(parameter, &end, 10);
+    if ((parameter[0] == '-') || (errno != 0) || (end == parameter) || (*end != '\0') || (value == 0)) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        print_error(&diagnostics, "Invalid number of iterations: %s\n", parameter);
+        invalid_arguments = true;
+        return;
+    }
+    iterations = (uint64_t)value;
+}
+
+static void set_slow_log_file(const char *const parameter) {
+    if (parameter != NULL) {
+        slow_log_file = parameter;
+    }
+}
+
+static void set_slow_log_threshold(const char *const parameter) {
+    if (parameter == NULL) {
+        return;
+    }
+    char *end = NULL;
+    errno = 0;
+    const unsigned long long value = strtoull(parameter, &end, 10);
+    if ((parameter[0] == '-') || (errno != 0) || (end == parameter) || (*end != '\0')) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        print_error(&diagnostics, "Invalid slow log threshold: %s\n", parameter);
+        invalid_arguments = true;
+        return;
+    }
+    slow_log_threshold = (uint64_t)value;
+}
+
 static inline int find_argument(const char *const arg) {
     const size_t alias_length = 2;
     const size_t length = strlen(arg);
@@ -186,7 +503,8 @@ static bool parse_arguments(const int argc, const char *const argv[]) {
     for (int i = 1; i < argc; i++) {
         const int arg_idx = find_argument(argv[i]);
         if (arg_idx < 0) {
-            print_error("Unrecognized command line argument: %s\n", argv[i]);
+            struct Diagnostics diagnostics = create_diagnostics(stderr);
+            print_error(&diagnostics, "Unrecognized command line argument: %s\n", argv[i]);
             arguments_usage(NULL);
             return true;
         }
@@ -199,41 +517,7 @@ static bool parse_arguments(const int argc, const char *const argv[]) {
             arg_list[arg_idx].function(NULL);
         }
     }
-    return false;
-}
-
-double fn_exit(struct Variables *const vars, const size_t column, const struct Fn_Arg first_arg, const struct Fn_Arg second_arg) {
-    (void)vars;
-    (void)column;
-    (void)first_arg;
-    (void)second_arg;
-    actions |= ACTION_EXIT;
-    return NAN;
-}
-
-static void interpret(struct Parser *const parser, const struct String line) {
-    if (!lex(parser->lexer, line)) {
-        // If didn't found an error while executing the lexer
-        const size_t head_idx = parse(parser);
-        enum Evaluation_Status status = Eval_OK;
-        const double result = evaluate(parser, head_idx, &status);
-        if (status == Eval_OK) {
-            printf("%lg\n", result);
-        }
-        printf("\n");
-        if (actions & ACTION_PRINT_TOKENS) {
-            print_tokens(parser->lexer);
-        }
-        if (actions & ACTION_PRINT_TREE) {
-            print_tree(parser, head_idx);
-        }
-        if (actions & ACTION_PRINT_GRAPH) {
-            print_graph(parser, head_idx);
-        }
-        if (actions & ACTION_PRINT_VARIABLES) {
-            print_variables(parser->vars);
-        }
-    }
+    return invalid_arguments;
 }
 
 //------------------------------------------------------------------------------
@@ -247,32 +531,177 @@ int main(const int argc, const char *const argv[]) {
     if ((actions & ACTION_EXIT) != 0) {
         return EXIT_SUCCESS;
     }
-    initialize_input_stream();
-    struct Lexer lexer = create_lex(64);
-    struct Variables vars = create_variables(64);
-    struct Parser parser = create_parser(&lexer, &vars, 1024);
+    if (trace_file != NULL) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        if (open_trace(&diagnostics, trace_file, trace_threshold)) {
+            return EXIT_FAILURE;
+        }
+    }
+    if (profile_file != NULL) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        if (start_sampling_profiler(&diagnostics, profile_file)) {
+            close_trace(&diagnostics);
+            return EXIT_FAILURE;
+        }
+    }
+    if (slow_log_file != NULL) {
+        struct Diagnostics diagnostics = create_diagnostics(stderr);
+        if (open_slow_log(&diagnostics, slow_log_file, slow_log_threshold)) {
+            stop_sampling_profiler(&diagnostics);
+            close_trace(&diagnostics);
+            return EXIT_FAILURE;
+        }
+    }
+    // In the coprocess mode, only the replies can be written to the standard output
+    FILE *const coprocess_output = coprocess_mode ? detach_stdout() : NULL;
+    if (coprocess_mode && (coprocess_output == NULL)) {
+        return EXIT_FAILURE;
+    }
+    struct Context ctx;
+    create_context(&ctx, stderr);
+    ctx.actions = actions;
+    init_metrics(&metrics);
+    metrics.file_name = metrics_file;
+    ctx.metrics = &metrics;
+    if (timing_enabled) {
+        init_timing(&timing);
+        ctx.timing = &timing;
+    }
+    if (perf_counters_enabled) {
+        if (open_perf_counters(&perf_counters)) {
+            print_warning(&ctx.diagnostics, "The hardware performance counters aren't available, because of the following error: %s\n", strerror(perf_counters.error));
+        } else {
+            ctx.perf_counters = &perf_counters;
+        }
+    }
+    if (explain_enabled) {
+        profile = create_evaluation_profile(explain_format);
+        ctx.parser.profile = &profile;
+    }
+    // The diagnostics of the context are written once per evaluation
+    struct Diagnostic_Sink sink = create_diagnostic_sink(stderr, diagnostics_format);
+    ctx.diagnostics.sink = &sink;
+    struct Journal journal;
+    if (journal_file != NULL) {
+        if (open_journal(&journal, &ctx.vars, journal_file)) {
+            close_journal(&journal);
+            destroy_diagnostic_sink(&sink);
+            return EXIT_FAILURE;
+        }
+        putchar('\n');
+    }
+    if (snapshot_to_restore != NULL) {
+        restore_snapshot(&ctx.vars, create_string((char *)snapshot_to_restore));
+        putchar('\n');
+    }
     if (file_name_to_load != NULL) {
         printf("Attempting to load variables from file \"%s\"\n", file_name_to_load);
-        load_variables_from_file(&vars, create_string((char *)file_name_to_load));
+        load_variables_from_file(&ctx.vars, create_string((char *)file_name_to_load));
         putchar('\n');
     }
-    if (command_line_expression.length > 0) {
+    flush_diagnostics(&ctx.diagnostics);
+    int exit_status = EXIT_SUCCESS;
+    // The recording starts with the variables loaded above
+    struct Recording session_recording;
+    if (recording_file != NULL) {
+        recording = open_recording(&session_recording, &ctx, recording_file) ? NULL : &session_recording;
+    }
+    if ((recording_file != NULL) && (recording == NULL)) {
+        exit_status = EXIT_FAILURE;
+    } else if (replay_file != NULL) {
+        if (replay_recording(&ctx, replay_file)) {
+            exit_status = EXIT_FAILURE;
+        }
+    } else if (expression_to_benchmark.data != NULL) {
+        if (benchmark_expression(&ctx, expression_to_benchmark, iterations)) {
+            exit_status = EXIT_FAILURE;
+        }
+    } else if (socket_to_serve != NULL) {
+        if (serve_unix_socket(&ctx, socket_to_serve)) {
+            exit_status = EXIT_FAILURE;
+        }
+    } else if (coprocess_mode) {
+        if (run_coprocess(&ctx, coprocess_output)) {
+            exit_status = EXIT_FAILURE;
+        }
+    } else if (file_to_watch != NULL) {
+        if (watch_file(&ctx, file_to_watch)) {
+            exit_status = EXIT_FAILURE;
+        }
+    } else if ((batch_file != NULL) || (script_file != NULL) || (stream_file != NULL)) {
+        struct Result_Output output;
+        if (open_result_output(&output, output_file, &ctx.diagnostics)) {
+            exit_status = EXIT_FAILURE;
+        } else {
+            bool error;
+            if (batch_file != NULL) {
+                error = run_batch(&ctx, batch_file, &output);
+            } else if (script_file != NULL) {
+                error = run_script(&ctx, script_file, &output);
+            } else {
+                error = run_stream(&ctx, stream_file, command_line_expression, window_size, &output);
+            }
+            if (close_result_output(&output) || error) {
+                exit_status = EXIT_FAILURE;
+            }
+        }
+    } else if (command_line_expression.length > 0) {
         // If an expression was passed through the command line, then evaluate it and exit
         printf("> %.*s\n", command_line_expression.length, command_line_expression.data);
-        interpret(&parser, command_line_expression);
+        struct Session session = create_session(&ctx, recording);
+        interpret_line(&session, command_line_expression);
     } else {
-        while ((actions & ACTION_EXIT) == 0) {
-            const struct String line = get_line_from_input();
-            interpret(&parser, line);
-            if (actions & ACTION_PRINT_LINES) {
-                print_previous_lines();
-            }
+        struct Session session = create_session(&ctx, recording);
+        while ((ctx.actions & ACTION_EXIT) == 0) {
+            interpret_session_line(&session, get_line_from_input(&ctx.input));
+        }
+    }
+    if ((recording != NULL) && close_recording(recording)) {
+        exit_status = EXIT_FAILURE;
+    }
+    // The summary goes to stderr, because the standard output may hold the results of a batch
+    if ((ctx.timing != NULL) && (timing.lines > 0)) {
+        print_timing_summary(stderr, &timing);
+    }
+    if (ctx.perf_counters != NULL) {
+        if (perf_counters.lines > 0) {
+            print_perf_summary(stderr, &perf_counters);
         }
+        close_perf_counters(&perf_counters);
+    }
+    if (ctx.parser.profile != NULL) {
+        print_function_profile(stderr, &profile);
+        destroy_evaluation_profile(&profile);
+    }
+    if (memory_stats_enabled) {
+        print_memory_stats(stderr);
+    }
+    if ((metrics.file_name != NULL) && write_metrics_file(&ctx.diagnostics, &metrics, array_size(ctx.vars.list))) {
+        exit_status = EXIT_FAILURE;
+    }
+    if (close_slow_log(&ctx.diagnostics)) {
+        exit_status = EXIT_FAILURE;
+    }
+    if (stop_sampling_profiler(&ctx.diagnostics)) {
+        exit_status = EXIT_FAILURE;
+    }
+    if (close_trace(&ctx.diagnostics)) {
+        exit_status = EXIT_FAILURE;
+    }
+    if (snapshot_to_save != NULL) {
+        if (save_snapshot(&ctx.vars, create_string((char *)snapshot_to_save))) {
+            exit_status = EXIT_FAILURE;
+        }
+    }
+    if (ctx.vars.journal != NULL) {
+        close_journal(ctx.vars.journal);
+    }
+    destroy_context(&ctx);
+    destroy_diagnostic_sink(&sink);
+    if (coprocess_output != NULL) {
+        fclose(coprocess_output);
     }
-    destroy_lex(&lexer);
-    destroy_variables(&vars);
-    destroy_parser(&parser);
-    return EXIT_SUCCESS;
+    return exit_status;
 }
 
 //------------------------------------------------------------------------------
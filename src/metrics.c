@@ -0,0 +1,185 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "metrics.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "data-structures/histogram.h"
+#include "platform.h"
+#include "printing.h"
+#include "timing.h"
+
+#define METRICS_MAX_FILE_NAME 4096
+
+static const char *const outcome_names[LINE_OUTCOMES] = {
+    [LINE_OK] = "ok",
+    [LINE_EMPTY] = "empty",
+    [LINE_LEX_ERROR] = "lex error",
+    [LINE_PARSE_ERROR] = "parse error",
+    [LINE_EVALUATION_ERROR] = "evaluation error",
+};
+
+// Phase of the errors, as labeled in the Prometheus metrics
+static const char *const error_phases[LINE_OUTCOMES] = {
+    [LINE_LEX_ERROR] = "lex",
+    [LINE_PARSE_ERROR] = "parse",
+    [LINE_EVALUATION_ERROR] = "evaluate",
+};
+
+static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void init_metrics(struct Metrics *const metrics) {
+    memset(metrics->lines, 0, sizeof(metrics->lines));
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        init_histogram(&metrics->latency[phase]);
+    }
+    metrics->file_name = NULL;
+    metrics->next_write_ns = 0;
+}
+
+void record_line_outcome(struct Metrics *const metrics, const enum Line_Outcome outcome) {
+    metrics->lines[outcome]++;
+}
+
+static uint64_t lines_evaluated(const struct Metrics *const metrics) {
+    uint64_t total = 0;
+    for (size_t outcome = 0; outcome < LINE_OUTCOMES; outcome++) {
+        total += metrics->lines[outcome];
+    }
+    return total;
+}
+
+void print_metrics(FILE *const file, const struct Metrics *const metrics, const size_t variables) {
+    fprintf(file, "Lines evaluated: %" PRIu64 " (", lines_evaluated(metrics));
+    for (size_t outcome = 0; outcome < LINE_OUTCOMES; outcome++) {
+        fprintf(file, "%s%" PRIu64 " %s", (outcome == 0) ? "" : ", ", metrics->lines[outcome], outcome_names[outcome]);
+    }
+    fprintf(file, ")\n");
+    fprintf(file, "Variables: %zu\n", variables);
+    fprintf(file, "Latency in nanoseconds:\n");
+    fprintf(file, "%-9s %10s %10s %10s %10s %10s %10s\n", "phase", "count", "mean", "p50", "p99", "p99.9", "max");
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        const struct Histogram *const histogram = &metrics->latency[phase];
+        fprintf(file, "%-9s %10" PRIu64 " %10.0lf %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+                timing_phase_names[phase], histogram->count, histogram_mean(histogram), histogram_percentile(histogram, 50.0),
+                histogram_percentile(histogram, 99.0), histogram_percentile(histogram, 99.9), histogram->max);
+    }
+}
+
+static void write_prometheus_metrics(FILE *const file, const struct Metrics *const metrics, const size_t variables) {
+    fprintf(file, "# HELP liir_lines_total Lines evaluated, including the empty ones and the ones with errors.\n");
+    fprintf(file, "# TYPE liir_lines_total counter\n");
+    fprintf(file, "liir_lines_total %" PRIu64 "\n", lines_evaluated(metrics));
+    fprintf(file, "# HELP liir_errors_total Lines with errors, by the phase in which the error was found.\n");
+    fprintf(file, "# TYPE liir_errors_total counter\n");
+    for (size_t outcome = 0; outcome < LINE_OUTCOMES; outcome++) {
+        if (error_phases[outcome] != NULL) {
+            fprintf(file, "liir_errors_total{phase=\"%s\"} %" PRIu64 "\n", error_phases[outcome], metrics->lines[outcome]);
+        }
+    }
+    fprintf(file, "# HELP liir_variables Variables currently defined.\n");
+    fprintf(file, "# TYPE liir_variables gauge\n");
+    fprintf(file, "liir_variables %zu\n", variables);
+    fprintf(file, "# HELP liir_phase_latency_seconds Time spent in each phase of the lines.\n");
+    fprintf(file, "# TYPE liir_phase_latency_seconds summary\n");
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        const struct Histogram *const histogram = &metrics->latency[phase];
+        for (size_t i = 0; i < (sizeof(quantiles) / sizeof(quantiles[0])); i++) {
+            fprintf(file, "liir_phase_latency_seconds{phase=\"%s\",quantile=\"%g\"} %.9lf\n", timing_phase_names[phase], quantiles[i],
+                    (double)histogram_percentile(histogram, 100.0 * quantiles[i]) * 1e-9);
+        }
+        fprintf(file, "liir_phase_latency_seconds_sum{phase=\"%s\"} %.9lf\n", timing_phase_names[phase], (double)histogram->sum * 1e-9);
+        fprintf(file, "liir_phase_latency_seconds_count{phase=\"%s\"} %" PRIu64 "\n", timing_phase_names[phase], histogram->count);
+    }
+}
+
+bool write_metrics_file(struct Diagnostics *const diagnostics, struct Metrics *const metrics, const size_t variables) {
+    metrics->next_write_ns = monotonic_time_ns() + METRICS_WRITE_INTERVAL_NS;
+    // The metrics are written to a temporary file, which then replaces the previous one
+    char temporary_name[METRICS_MAX_FILE_NAME];
+    const int length = snprintf(temporary_name, sizeof(temporary_name), "%s.tmp", metrics->file_name);
+    if ((length < 0) || ((size_t)length >= sizeof(temporary_name))) {
+        print_error(diagnostics, "The name of the metrics file \"%s\" is too long!\n", metrics->file_name);
+        return true;
+    }
+    FILE *const file = fopen(temporary_name, "wb");
+    if (file == NULL) {
+        print_error(diagnostics, "Couldn't write the metrics to the file \"%s\", because of the following error: %s\n", temporary_name, strerror(errno));
+        return true;
+    }
+    write_prometheus_metrics(file, metrics, variables);
+    const bool error = (ferror(file) != 0);
+    if ((fclose(file) != 0) || error) {
+        print_error(diagnostics, "Couldn't write the metrics to the file \"%s\", because of the following error: %s\n", temporary_name, strerror(errno));
+        remove(temporary_name);
+        return true;
+    }
+    // Unlike rename, it also replaces an existing file on Windows
+    if (!replace_file(temporary_name, metrics->file_name)) {
+        print_error(diagnostics, "Couldn't replace the metrics file \"%s\"!\n", metrics->file_name);
+        remove(temporary_name);
+        return true;
+    }
+    return false;
+}
+
+void write_metrics_periodically(struct Diagnostics *const diagnostics, struct Metrics *const metrics, const size_t variables) {
+    if ((metrics->file_name != NULL) && (monotonic_time_ns() >= metrics->next_write_ns)) {
+        write_metrics_file(diagnostics, metrics, variables);
+    }
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,121 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __METRICS
+#define __METRICS
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "data-structures/histogram.h"
+#include "timing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Counters and latency histograms of the lines interpreted, kept at all
+// times by the command line interpreter, shown by the built-in function
+// stats and written by --metrics-file in the text format of Prometheus.
+// They are only updated by the thread that evaluates the lines
+
+// Reading the clock costs about as much as the lexer of a short line, so the
+// batches only measure the latency of one line in each METRICS_SAMPLING_INTERVAL.
+// Every line is counted, nevertheless
+#define METRICS_SAMPLING_INTERVAL 16
+
+// Interval between the writings of --metrics-file, checked after each line
+#define METRICS_WRITE_INTERVAL_NS UINT64_C(10000000000)
+
+// Defined on printing.h
+struct Diagnostics;
+
+enum Line_Outcome {
+    LINE_OK,
+    LINE_EMPTY,
+    LINE_LEX_ERROR,
+    LINE_PARSE_ERROR,
+    LINE_EVALUATION_ERROR,
+    LINE_OUTCOMES,
+};
+
+struct Metrics {
+    uint64_t lines[LINE_OUTCOMES];
+    // Latency of each phase, in nanoseconds
+    struct Histogram latency[TIMING_PHASES];
+    // Set by --metrics-file
+    const char *file_name;
+    uint64_t next_write_ns;
+};
+
+void init_metrics(struct Metrics *const metrics)
+    __attribute__((nonnull));
+void record_line_outcome(struct Metrics *const metrics, const enum Line_Outcome outcome)
+    __attribute__((nonnull));
+static inline void record_phase_latency(struct Metrics *const metrics, const enum Timing_Phase phase, const uint64_t ns) {
+    histogram_record(&metrics->latency[phase], ns);
+}
+// Prints the metrics in a table, with the number of variables given
+void print_metrics(FILE *const file, const struct Metrics *const metrics, const size_t variables)
+    __attribute__((nonnull));
+// Replaces the file atomically, so that the collector never reads a partial
+// file. Returns true if found an error
+bool write_metrics_file(struct Diagnostics *const diagnostics, struct Metrics *const metrics, const size_t variables)
+    __attribute__((nonnull));
+// Writes the file if METRICS_WRITE_INTERVAL_NS passed since the last time.
+// Called after each line, or after each chunk of a batch
+void write_metrics_periodically(struct Diagnostics *const diagnostics, struct Metrics *const metrics, const size_t variables)
+    __attribute__((nonnull));
+
+#endif  // __METRICS
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -30,20 +30,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "context.h"
 #include "data-structures/dynamic_array.h"
 #include "data-structures/sized_string.h"
+#include "evaluation_profile.h"
 #include "functions.h"
 #include "lex.h"
+#include "platform.h"
 #include "printing.h"
+#include "sampling_profiler.h"
+#include "trace.h"
 #include "variables.h"
 
 #define INVALID_PARSER_INDEX ((size_t)-1)
 
-struct Parser create_parser(struct Lexer *const lexer, struct Variables *const vars, const size_t initial_size) {
+struct Parser create_parser(struct Context *const ctx, const size_t initial_size) {
     struct Parser parser = (struct Parser){
-        .lexer = lexer,
-        .vars = vars,
+        .lexer = &ctx->lexer,
+        .vars = &ctx->vars,
+        .ctx = ctx,
         .nodes = array_new(sizeof(struct Token_Node), initial_size),
+        .profile = NULL,
     };
     if (parser.nodes == NULL) {
         print_crash_and_exit("Couldn't allocate memory for the parser!\n");
@@ -82,33 +89,33 @@ static inline bool check_parser_right_error(struct Parser *const parser, const s
     struct Token current_tok = parser->nodes[current_idx].tok;
     if ((previous_tok.type == TOK_NUMBER) || (previous_tok.type == TOK_NAME)) {
         if (current_tok.type == TOK_NUMBER) {
-            print_column(current_tok.column);
-            print_error("Unexpected number! Check for missing operator, missing or unbalanced delimiters, or other syntax error.\n");
+            print_column(&parser->ctx->diagnostics, current_tok.column);
+            print_error(&parser->ctx->diagnostics, "Unexpected number! Check for missing operator, missing or unbalanced delimiters, or other syntax error.\n");
             return true;
         }
         if (current_tok.type == TOK_NAME) {
-            print_column(current_tok.column);
-            print_error("Unexpected name! Check for missing operator, missing or unbalanced delimiters, or other syntax error.\n");
+            print_column(&parser->ctx->diagnostics, current_tok.column);
+            print_error(&parser->ctx->diagnostics, "Unexpected name! Check for missing operator, missing or unbalanced delimiters, or other syntax error.\n");
             return true;
         }
         if (current_tok.type == TOK_FUNCTION) {
-            print_column(current_tok.column);
-            print_error("Unexpected function! Check for missing operator, missing or unbalanced delimiters, or other syntax error.\n");
+            print_column(&parser->ctx->diagnostics, current_tok.column);
+            print_error(&parser->ctx->diagnostics, "Unexpected function! Check for missing operator, missing or unbalanced delimiters, or other syntax error.\n");
             return true;
         }
     }
     if (previous_tok.type == TOK_FUNCTION) {
         if (functions[previous_tok.function_index].arity == 0) {
             if ((current_tok.type == TOK_NUMBER) || (current_tok.type == TOK_NAME)) {
-                print_column(current_tok.column);
-                print_warning("The function \"%s\" accepts no argument!\n", functions[previous_tok.function_index].name);
+                print_column(&parser->ctx->diagnostics, current_tok.column);
+                print_warning(&parser->ctx->diagnostics, "The function \"%s\" accepts no argument!\n", functions[previous_tok.function_index].name);
             }
         }
     }
     if (previous_tok.type == TOK_OPERATOR) {
         if ((current_tok.type == TOK_FUNCTION) && (!functions[current_tok.function_index].return_value)) {
-            print_column(current_tok.column);
-            print_error("The function \"%s\" doesn't return a value, so it can't be used in a expression!\n", functions[current_tok.function_index].name);
+            print_column(&parser->ctx->diagnostics, current_tok.column);
+            print_error(&parser->ctx->diagnostics, "The function \"%s\" doesn't return a value, so it can't be used in a expression!\n", functions[current_tok.function_index].name);
             return true;
         }
     }
@@ -183,8 +190,8 @@ static inline bool parse_function(struct Parser *const parser, size_t *const tk_
     const struct Token parentheses_token = parser->lexer->tokens[*tk_idx];
     (*tk_idx)++;
     if (*tk_idx >= array_size(parser->lexer->tokens)) {
-        print_column(parentheses_token.column);
-        print_error("Didn't found the closing parentheses for the function declaration!\n");
+        print_column(&parser->ctx->diagnostics, parentheses_token.column);
+        print_error(&parser->ctx->diagnostics, "Didn't found the closing parentheses for the function declaration!\n");
         return true;
     }
     size_t argument_idx = INVALID_PARSER_INDEX;
@@ -192,8 +199,8 @@ static inline bool parse_function(struct Parser *const parser, size_t *const tk_
         return true;
     }
     if (array_index_is_invalid(parser->nodes, argument_idx)) {
-        print_column(function_token.column);
-        print_error("It was impossible to parse the first argument to this function!\n");
+        print_column(&parser->ctx->diagnostics, function_token.column);
+        print_error(&parser->ctx->diagnostics, "It was impossible to parse the first argument to this function!\n");
         return true;
     }
     // Insert first argument in the left
@@ -208,28 +215,28 @@ static inline bool parse_function(struct Parser *const parser, size_t *const tk_
                     return true;
                 }
                 if (array_index_is_invalid(parser->nodes, argument_idx)) {
-                    print_column(function_token.column);
-                    print_error("It was impossible to parse the second argument to this function!\n");
+                    print_column(&parser->ctx->diagnostics, function_token.column);
+                    print_error(&parser->ctx->diagnostics, "It was impossible to parse the second argument to this function!\n");
                     return true;
                 }
                 // Insert second argument to the right
                 parser->nodes[function_node_idx].right_idx = argument_idx;
             }
         } else {
-            print_column(function_token.column);
-            print_error("It was expected a second argument to the function!\n");
+            print_column(&parser->ctx->diagnostics, function_token.column);
+            print_error(&parser->ctx->diagnostics, "It was expected a second argument to the function!\n");
             return true;
         }
     }
     if (*tk_idx >= array_size(parser->lexer->tokens)) {
-        print_column(parentheses_token.column);
-        print_error("Didn't found the closing parentheses for the function declaration!\n");
+        print_column(&parser->ctx->diagnostics, parentheses_token.column);
+        print_error(&parser->ctx->diagnostics, "Didn't found the closing parentheses for the function declaration!\n");
         return true;
     }
     const struct Token last_token = parser->lexer->tokens[*tk_idx];
     if ((last_token.type != TOK_DELIMITER) || (last_token.op != ')')) {
-        print_column(last_token.column);
-        print_error("Expected a closing parentheses \")\"!\n");
+        print_column(&parser->ctx->diagnostics, last_token.column);
+        print_error(&parser->ctx->diagnostics, "Expected a closing parentheses \")\"!\n");
         return true;
     }
     return false;
@@ -246,22 +253,22 @@ static bool parse_expression(struct Parser *const parser, size_t *const tk_idx,
             case '(': {
                 (*tk_idx)++;
                 if (*tk_idx >= array_size(parser->lexer->tokens)) {
-                    print_column(current_token.column);
-                    print_error("Mismatched delimiters! Not all parentheses were closed!\n");
+                    print_column(&parser->ctx->diagnostics, current_token.column);
+                    print_error(&parser->ctx->diagnostics, "Mismatched delimiters! Not all parentheses were closed!\n");
                     return true;
                 }
                 if (parse_expression(parser, tk_idx, &last_parentheses_idx)) {
                     return true;
                 }
                 if (*tk_idx >= array_size(parser->lexer->tokens)) {
-                    print_column(current_token.column);
-                    print_error("Mismatched delimiters! Not all parentheses were closed!\n");
+                    print_column(&parser->ctx->diagnostics, current_token.column);
+                    print_error(&parser->ctx->diagnostics, "Mismatched delimiters! Not all parentheses were closed!\n");
                     return true;
                 }
                 const struct Token last_token = parser->lexer->tokens[*tk_idx];
                 if ((last_token.type != TOK_DELIMITER) || (last_token.op != ')')) {
-                    print_column(last_token.column);
-                    print_error("Expected a closing parentheses \")\"!\n");
+                    print_column(&parser->ctx->diagnostics, last_token.column);
+                    print_error(&parser->ctx->diagnostics, "Expected a closing parentheses \")\"!\n");
                     return true;
                 }
                 // If last_parentheses_idx is negative, there is no new node to insert
@@ -275,8 +282,8 @@ static bool parse_expression(struct Parser *const parser, size_t *const tk_idx,
             case ',':
                 return false;
             default:
-                print_column(current_token.column);
-                print_error("Unrecognized delimiter at parsing phase!\n");
+                print_column(&parser->ctx->diagnostics, current_token.column);
+                print_error(&parser->ctx->diagnostics, "Unrecognized delimiter at parsing phase!\n");
                 return true;
             }
         } else if (current_token.type == TOK_FUNCTION) {
@@ -299,10 +306,14 @@ static bool parse_expression(struct Parser *const parser, size_t *const tk_idx,
 }
 
 size_t parse(struct Parser *const parser) {
+    array_free_all(parser->nodes);
+    return parse_append(parser);
+}
+
+size_t parse_append(struct Parser *const parser) {
     if (array_size(parser->lexer->tokens) == 0) {
         return INVALID_PARSER_INDEX;
     }
-    array_free_all(parser->nodes);
     size_t tk_idx = 0;
     size_t head_idx = INVALID_PARSER_INDEX;
     if (parse_expression(parser, &tk_idx, &head_idx) || array_index_is_invalid(parser->nodes, head_idx)) {
@@ -311,19 +322,22 @@ size_t parse(struct Parser *const parser) {
     // Couldn't parse all the expression
     if (tk_idx < array_size(parser->lexer->tokens)) {
         const struct Token next_token = parser->lexer->tokens[tk_idx];
-        print_column(next_token.column);
-        print_error("Unexpected %s at parsing phase!\n", get_token_type(next_token.type));
+        print_column(&parser->ctx->diagnostics, next_token.column);
+        print_error(&parser->ctx->diagnostics, "Unexpected %s at parsing phase!\n", get_token_type(next_token.type));
         return INVALID_PARSER_INDEX;
     }
     return head_idx;
 }
 
-static struct Fn_Arg build_fn_arg(struct Parser *const parser, const size_t node_idx, enum Evaluation_Status *const status) {
+static struct Fn_Arg build_fn_arg(struct Parser *const parser, const size_t node_idx, const bool lazy, enum Evaluation_Status *const status) {
     struct Fn_Arg arg = (struct Fn_Arg){
-        .value = evaluate(parser, node_idx, status),
+        .value = lazy ? NAN : evaluate(parser, node_idx, status),
         // If the function argument is a name (possible a variable), pass it to the function to be used as a reference
         .name = (array_index_is_valid(parser->nodes, node_idx) && (parser->nodes[node_idx].tok.type == TOK_NAME)) ?
                 parser->nodes[node_idx].tok.name : (struct String){0},
+        .parser = parser,
+        .node_idx = node_idx,
+        .status = status,
     };
     return arg;
 }
@@ -331,98 +345,105 @@ static struct Fn_Arg build_fn_arg(struct Parser *const parser, const size_t node
 static inline double perform_function_call(struct Parser *const parser, const size_t node_idx, enum Evaluation_Status *const status) {
     const struct Function function = functions[parser->nodes[node_idx].tok.function_index];
     if (function.fn == NULL) {
-        print_column(parser->nodes[node_idx].tok.column);
-        print_error("The function \"%s\" was not properly initialized!\n", function.name);
+        print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+        print_error(&parser->ctx->diagnostics, "The function \"%s\" was not properly initialized!\n", function.name);
         *status = Eval_Error;
         return NAN;
     }
     const size_t left_idx = parser->nodes[node_idx].left_idx;
     if ((function.arity >= 1) && array_index_is_invalid(parser->nodes, left_idx)) {
-        print_column(parser->nodes[node_idx].tok.column);
-        print_warning("Did you forget to pass a argument to the function \"%s\"?\n", function.name);
+        print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+        print_warning(&parser->ctx->diagnostics, "Did you forget to pass a argument to the function \"%s\"?\n", function.name);
     }
     const size_t right_idx = parser->nodes[node_idx].right_idx;
     if ((function.arity >= 2) && array_index_is_invalid(parser->nodes, right_idx)) {
-        print_column(parser->nodes[node_idx].tok.column);
-        print_warning("Did you forget to pass the second argument to the function \"%s\"?\n", function.name);
+        print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+        print_warning(&parser->ctx->diagnostics, "Did you forget to pass the second argument to the function \"%s\"?\n", function.name);
     }
     if ((!function.return_value) && (*status != Eval_Error)) {
         *status = Eval_Dont_Print;
     }
-    struct Fn_Arg left_arg = (function.arity >= 1) ? build_fn_arg(parser, left_idx, status) : (struct Fn_Arg){ 0 };
+    struct Fn_Arg left_arg = (function.arity >= 1) ? build_fn_arg(parser, left_idx, function.lazy_arguments, status) : (struct Fn_Arg){ 0 };
     // If got error at evaluation, don't call the function
     if (*status == Eval_Error) {
         return NAN;
     }
-    struct Fn_Arg right_arg = (function.arity >= 2) ? build_fn_arg(parser, right_idx, status) : (struct Fn_Arg){ 0 };
+    struct Fn_Arg right_arg = (function.arity >= 2) ? build_fn_arg(parser, right_idx, function.lazy_arguments, status) : (struct Fn_Arg){ 0 };
     // If got error at evaluation, don't call the function
     if (*status == Eval_Error) {
         return NAN;
     }
-    return function.fn(parser->vars, parser->nodes[node_idx].tok.column, left_arg, right_arg);
+    enter_sampled_function(parser->nodes[node_idx].tok.function_index);
+    if ((parser->profile == NULL) && !tracing()) {
+        const double result = function.fn(parser->ctx, parser->nodes[node_idx].tok.column, left_arg, right_arg);
+        leave_sampled_function();
+        return result;
+    }
+    const uint64_t start = monotonic_time_ns();
+    const double result = function.fn(parser->ctx, parser->nodes[node_idx].tok.column, left_arg, right_arg);
+    const uint64_t elapsed = monotonic_time_ns() - start;
+    leave_sampled_function();
+    if (parser->profile != NULL) {
+        record_function_time(parser->profile, parser->nodes[node_idx].tok.function_index, elapsed);
+    }
+    trace_function_call(function.name, start, elapsed);
+    return result;
 }
 
-double evaluate(struct Parser *const parser, const size_t node_idx, enum Evaluation_Status *const status) {
-    if (*status == Eval_Error) {
-        return NAN;
-    }
-    if (array_index_is_invalid(parser->nodes, node_idx)) {
-        *status = Eval_Dont_Print;
-        return NAN;
-    }
+static double evaluate_node(struct Parser *const parser, const size_t node_idx, enum Evaluation_Status *const status) {
     switch (parser->nodes[node_idx].tok.type) {
         case TOK_OPERATOR:
             switch (parser->nodes[node_idx].tok.op) {
             case '+':
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].left_idx) || array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 return (evaluate(parser, parser->nodes[node_idx].left_idx, status) + evaluate(parser, parser->nodes[node_idx].right_idx, status));
             case '-':
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].left_idx) || array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 return (evaluate(parser, parser->nodes[node_idx].left_idx, status) - evaluate(parser, parser->nodes[node_idx].right_idx, status));
             case '*':
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].left_idx) || array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 return (evaluate(parser, parser->nodes[node_idx].left_idx, status) * evaluate(parser, parser->nodes[node_idx].right_idx, status));
             case '/':
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].left_idx) || array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 return (evaluate(parser, parser->nodes[node_idx].left_idx, status) / evaluate(parser, parser->nodes[node_idx].right_idx, status));
             case '^':
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].left_idx) || array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 return pow(evaluate(parser, parser->nodes[node_idx].left_idx, status), evaluate(parser, parser->nodes[node_idx].right_idx, status));
             case '=': {
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].left_idx) || array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 if (parser->nodes[parser->nodes[node_idx].left_idx].tok.type == TOK_FUNCTION) {
-                    print_column(parser->nodes[parser->nodes[node_idx].left_idx].tok.column);
-                    print_error("Cannot create a variable named \"%s\", because already exists a function with this name!\n", functions[parser->nodes[parser->nodes[node_idx].left_idx].tok.function_index].name);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[parser->nodes[node_idx].left_idx].tok.column);
+                    print_error(&parser->ctx->diagnostics, "Cannot create a variable named \"%s\", because already exists a function with this name!\n", functions[parser->nodes[parser->nodes[node_idx].left_idx].tok.function_index].name);
                     *status = Eval_Error;
                     return NAN;
                 }
                 if (parser->nodes[parser->nodes[node_idx].left_idx].tok.type != TOK_NAME) {
-                    print_column(parser->nodes[parser->nodes[node_idx].left_idx].tok.column);
-                    print_error("Expected variable name for atribution!\n");
+                    print_column(&parser->ctx->diagnostics, parser->nodes[parser->nodes[node_idx].left_idx].tok.column);
+                    print_error(&parser->ctx->diagnostics, "Expected variable name for atribution!\n");
                     *status = Eval_Error;
                     return NAN;
                 }
@@ -434,8 +455,8 @@ double evaluate(struct Parser *const parser, const size_t node_idx, enum Evaluat
                 }
             }
             default:
-                print_column(parser->nodes[node_idx].tok.column);
-                print_error("Invalid binary operator at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
+                print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                print_error(&parser->ctx->diagnostics, "Invalid binary operator at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
                 *status = Eval_Error;
                 return NAN;
             }
@@ -443,27 +464,27 @@ double evaluate(struct Parser *const parser, const size_t node_idx, enum Evaluat
             switch (parser->nodes[node_idx].tok.op) {
             case '-':
                 if (array_index_is_invalid(parser->nodes, parser->nodes[node_idx].right_idx)) {
-                    print_column(parser->nodes[node_idx].tok.column);
-                    print_warning("Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
+                    print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                    print_warning(&parser->ctx->diagnostics, "Did you forget to include a operand for the operator \"%c\"?\n", parser->nodes[node_idx].tok.op);
                     return NAN;
                 }
                 return (-evaluate(parser, parser->nodes[node_idx].right_idx, status));
             default:
-                print_column(parser->nodes[node_idx].tok.column);
-                print_error("Invalid unary operator at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
+                print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                print_error(&parser->ctx->diagnostics, "Invalid unary operator at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
                 *status = Eval_Error;
                 return NAN;
             }
         case TOK_NUMBER: {
             const size_t right_idx = parser->nodes[node_idx].right_idx;
             if (array_index_is_valid(parser->nodes, right_idx)) {
-                print_column(parser->nodes[right_idx].tok.column);
-                print_warning("Invalid %s at evaluation phase\n", get_token_type(parser->nodes[right_idx].tok.type));
+                print_column(&parser->ctx->diagnostics, parser->nodes[right_idx].tok.column);
+                print_warning(&parser->ctx->diagnostics, "Invalid %s at evaluation phase\n", get_token_type(parser->nodes[right_idx].tok.type));
             }
             const size_t left_idx = parser->nodes[node_idx].left_idx;
             if (array_index_is_valid(parser->nodes, left_idx)) {
-                print_column(parser->nodes[left_idx].tok.column);
-                print_warning("Invalid %s at evaluation phase\n", get_token_type(parser->nodes[left_idx].tok.type));
+                print_column(&parser->ctx->diagnostics, parser->nodes[left_idx].tok.column);
+                print_warning(&parser->ctx->diagnostics, "Invalid %s at evaluation phase\n", get_token_type(parser->nodes[left_idx].tok.type));
             }
             return parser->nodes[node_idx].tok.number;
         }
@@ -472,32 +493,32 @@ double evaluate(struct Parser *const parser, const size_t node_idx, enum Evaluat
         case TOK_NAME: {
             const size_t right_idx = parser->nodes[node_idx].right_idx;
             if (array_index_is_valid(parser->nodes, right_idx)) {
-                print_column(parser->nodes[right_idx].tok.column);
-                print_warning("Invalid %s at evaluation phase\n", get_token_type(parser->nodes[right_idx].tok.type));
+                print_column(&parser->ctx->diagnostics, parser->nodes[right_idx].tok.column);
+                print_warning(&parser->ctx->diagnostics, "Invalid %s at evaluation phase\n", get_token_type(parser->nodes[right_idx].tok.type));
             }
             const size_t left_idx = parser->nodes[node_idx].left_idx;
             if (array_index_is_valid(parser->nodes, left_idx)) {
-                print_column(parser->nodes[left_idx].tok.column);
-                print_warning("Invalid %s at evaluation phase\n", get_token_type(parser->nodes[left_idx].tok.type));
+                print_column(&parser->ctx->diagnostics, parser->nodes[left_idx].tok.column);
+                print_warning(&parser->ctx->diagnostics, "Invalid %s at evaluation phase\n", get_token_type(parser->nodes[left_idx].tok.type));
             }
             size_t index;
             const struct String name = parser->nodes[node_idx].tok.name;
             if (search_variable(parser->vars, name, &index) != EXIT_SUCCESS) {
-                print_column(parser->nodes[node_idx].tok.column);
-                print_error("Unrecognized name: \"%.*s\"!\n", name.length, name.data);
+                print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+                print_error(&parser->ctx->diagnostics, "Unrecognized name: \"%.*s\"!\n", name.length, name.data);
                 *status = Eval_Error;
                 return NAN;
             }
             return get_variable_value(parser->vars, index);
         }
         case TOK_DELIMITER:
-            print_column(parser->nodes[node_idx].tok.column);
-            print_error("Unexpected delimiter at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
+            print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+            print_error(&parser->ctx->diagnostics, "Unexpected delimiter at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
             *status = Eval_Error;
             return NAN;
         default:
-            print_column(parser->nodes[node_idx].tok.column);
-            print_error("Invalid token at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
+            print_column(&parser->ctx->diagnostics, parser->nodes[node_idx].tok.column);
+            print_error(&parser->ctx->diagnostics, "Invalid token at evaluation phase: %c\n", parser->nodes[node_idx].tok.op);
             *status = Eval_Error;
             return NAN;
     }
@@ -520,6 +541,23 @@ static void print_node(struct Parser *const parser, const size_t node_idx, const
     }
 }
 
+double evaluate(struct Parser *const parser, const size_t node_idx, enum Evaluation_Status *const status) {
+    if (*status == Eval_Error) {
+        return NAN;
+    }
+    if (array_index_is_invalid(parser->nodes, node_idx)) {
+        *status = Eval_Dont_Print;
+        return NAN;
+    }
+    if (parser->profile == NULL) {
+        return evaluate_node(parser, node_idx, status);
+    }
+    const uint64_t start = monotonic_time_ns();
+    const double result = evaluate_node(parser, node_idx, status);
+    record_node_time(parser->profile, node_idx, monotonic_time_ns() - start);
+    return result;
+}
+
 void print_tree(struct Parser *const parser, const size_t head_idx) {
     if (array_index_is_invalid(parser->nodes, head_idx)) {
         return;
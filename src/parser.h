@@ -41,11 +41,20 @@ struct Token_Node {
     size_t right_idx;
 };
 
+// Defined on context.h
+struct Context;
+// Defined on evaluation_profile.h
+struct Evaluation_Profile;
+
 struct Parser {
-    struct Lexer *const lexer;
-    struct Variables *const vars;
+    struct Lexer *lexer;
+    struct Variables *vars;
+    // Context passed to the built-in functions
+    struct Context *ctx;
     // Dynamic array used to store the nodes of the AST
     struct Token_Node *nodes;
+    // If not NULL, the evaluation of each node and function is measured
+    struct Evaluation_Profile *profile;
 };
 
 // Enumeration used to track the status of the evaluation phase
@@ -55,12 +64,16 @@ enum Evaluation_Status {
     Eval_Error,
 };
 
-struct Parser create_parser(struct Lexer *const lexer, struct Variables *const vars, const size_t initial_size)
+struct Parser create_parser(struct Context *const ctx, const size_t initial_size)
     __attribute__((nonnull));
 void destroy_parser(struct Parser *const parser)
     __attribute__((nonnull));
 size_t parse(struct Parser *const parser)
     __attribute__((nonnull));
+// Same as parse, but keeps the nodes of the previous trees, so that several
+// trees can be stored in the same array and evaluated later
+size_t parse_append(struct Parser *const parser)
+    __attribute__((nonnull));
 double evaluate(struct Parser *const parser, const size_t node_idx, enum Evaluation_Status *const status)
     __attribute__((nonnull));
 void print_tree(struct Parser *const parser, const size_t head_idx)
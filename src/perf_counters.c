@@ -0,0 +1,256 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#ifdef __linux__
+// Required for syscall when compiling with -std=c11
+#define _GNU_SOURCE
+#endif
+
+#include "perf_counters.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "timing.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *const counter_names[PERF_COUNTERS] = {
+    [PERF_CYCLES] = "cycles",
+    [PERF_INSTRUCTIONS] = "instructions",
+    [PERF_BRANCH_MISSES] = "branch-misses",
+    [PERF_L1D_MISSES] = "L1D-misses",
+    [PERF_LLC_MISSES] = "LLC-misses",
+};
+
+#ifdef __linux__
+
+#define CACHE_READ_MISSES(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[PERF_COUNTERS] = {
+    [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    [PERF_L1D_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_L1D)},
+    [PERF_LLC_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_LL)},
+};
+
+// Layout of a read of the group with PERF_FORMAT_GROUP and PERF_FORMAT_ID
+struct Group_Read {
+    uint64_t quantity;
+    struct {
+        uint64_t value;
+        uint64_t id;
+    } values[PERF_COUNTERS];
+};
+
+static int open_event(const size_t counter, const int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[counter].type;
+    attr.config = events[counter].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+    // The group is enabled at once, when all the counters were opened
+    attr.disabled = (group_fd == -1);
+    // Only the user space is counted, which is allowed by the default perf_event_paranoid
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+bool open_perf_counters(struct Perf_Counters *const perf) {
+    memset(perf, 0, sizeof(struct Perf_Counters));
+    perf->leader_fd = -1;
+    for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+        perf->fds[counter] = open_event(counter, perf->leader_fd);
+        if (perf->fds[counter] < 0) {
+            if (perf->error == 0) {
+                perf->error = errno;
+            }
+            continue;
+        }
+        if ((ioctl(perf->fds[counter], PERF_EVENT_IOC_ID, &perf->ids[counter]) != 0)) {
+            close(perf->fds[counter]);
+            perf->fds[counter] = -1;
+            continue;
+        }
+        perf->available[counter] = true;
+        if (perf->leader_fd < 0) {
+            perf->leader_fd = perf->fds[counter];
+        }
+    }
+    if (perf->leader_fd < 0) {
+        return true;
+    }
+    ioctl(perf->leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(perf->leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return false;
+}
+
+void close_perf_counters(struct Perf_Counters *const perf) {
+    for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+        if (perf->available[counter]) {
+            close(perf->fds[counter]);
+            perf->available[counter] = false;
+        }
+    }
+    perf->leader_fd = -1;
+}
+
+void read_perf_counters(const struct Perf_Counters *const perf, struct Perf_Sample *const sample) {
+    memset(sample, 0, sizeof(struct Perf_Sample));
+    struct Group_Read group;
+    if ((perf->leader_fd < 0) || (read(perf->leader_fd, &group, sizeof(group)) <= 0)) {
+        return;
+    }
+    for (size_t i = 0; (i < group.quantity) && (i < PERF_COUNTERS); i++) {
+        for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+            if (perf->available[counter] && (perf->ids[counter] == group.values[i].id)) {
+                sample->counts[counter] = group.values[i].value;
+            }
+        }
+    }
+}
+
+#else // Not Linux
+
+bool open_perf_counters(struct Perf_Counters *const perf) {
+    memset(perf, 0, sizeof(struct Perf_Counters));
+    perf->leader_fd = -1;
+    perf->error = ENOSYS;
+    return true;
+}
+
+void close_perf_counters(struct Perf_Counters *const perf) {
+    perf->leader_fd = -1;
+}
+
+void read_perf_counters(const struct Perf_Counters *const perf, struct Perf_Sample *const sample) {
+    (void)perf;
+    memset(sample, 0, sizeof(struct Perf_Sample));
+}
+
+#endif
+
+void add_phase_counters(struct Perf_Counters *const perf, const enum Timing_Phase phase, const struct Perf_Sample *const begin, const struct Perf_Sample *const end) {
+    for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+        const uint64_t count = end->counts[counter] - begin->counts[counter];
+        perf->line[phase].counts[counter] = count;
+        perf->totals[phase].counts[counter] += count;
+    }
+}
+
+void finish_line_counters(struct Perf_Counters *const perf) {
+    perf->lines++;
+}
+
+void merge_perf_counters(struct Perf_Counters *const perf, const struct Perf_Counters *const other) {
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+            perf->totals[phase].counts[counter] += other->totals[phase].counts[counter];
+        }
+    }
+}
+
+static void print_header(FILE *const file, const char *const title) {
+    fprintf(file, "%-9s", title);
+    for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+        fprintf(file, " %14s", counter_names[counter]);
+    }
+    fprintf(file, "\n");
+}
+
+static void print_phases(FILE *const file, const struct Perf_Counters *const perf, const struct Perf_Sample phases[TIMING_PHASES]) {
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        fprintf(file, "%-9s", timing_phase_names[phase]);
+        for (size_t counter = 0; counter < PERF_COUNTERS; counter++) {
+            if (perf->available[counter]) {
+                fprintf(file, " %14" PRIu64, phases[phase].counts[counter]);
+            } else {
+                fprintf(file, " %14s", "n/a");
+            }
+        }
+        fprintf(file, "\n");
+    }
+}
+
+void print_line_counters(FILE *const file, const struct Perf_Counters *const perf) {
+    print_header(file, "[Perf]");
+    print_phases(file, perf, perf->line);
+}
+
+void print_perf_summary(FILE *const file, const struct Perf_Counters *const perf) {
+    fprintf(file, "Hardware counters of %" PRIu64 " lines:\n", perf->lines);
+    print_header(file, "phase");
+    print_phases(file, perf, perf->totals);
+    if (perf->available[PERF_CYCLES] && perf->available[PERF_INSTRUCTIONS]) {
+        fprintf(file, "Instructions per cycle:");
+        for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+            const struct Perf_Sample *const total = &perf->totals[phase];
+            const double cycles = (double)total->counts[PERF_CYCLES];
+            fprintf(file, " %s %.2lf%s", timing_phase_names[phase], (cycles > 0.0) ? ((double)total->counts[PERF_INSTRUCTIONS] / cycles) : 0.0, (phase + 1 < TIMING_PHASES) ? "," : "\n");
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
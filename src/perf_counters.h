@@ -0,0 +1,120 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __PERF_COUNTERS
+#define __PERF_COUNTERS
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "timing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Hardware performance counters of the calling thread, read with
+// perf_event_open (Linux only), used by --perf-counters to split the
+// cycles, instructions and misses of each line in the phases of --timing.
+// The counters are opened as a group, so that all of them count the same
+// instructions. Counters unsupported by the processor are left out, and if
+// none can be opened (as when perf_event_paranoid forbids it), the caller
+// just reports the error and goes on without them
+
+enum Perf_Counter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_COUNTERS,
+};
+
+struct Perf_Sample {
+    uint64_t counts[PERF_COUNTERS];
+};
+
+struct Perf_Counters {
+    int leader_fd;
+    int fds[PERF_COUNTERS];
+    uint64_t ids[PERF_COUNTERS];
+    bool available[PERF_COUNTERS];
+    // Error of the first counter that couldn't be opened
+    int error;
+    uint64_t lines;
+    // Counts of each phase of the last line, and of all the lines
+    struct Perf_Sample line[TIMING_PHASES];
+    struct Perf_Sample totals[TIMING_PHASES];
+};
+
+// Returns true if no counter could be opened, leaving the reason in perf->error
+bool open_perf_counters(struct Perf_Counters *const perf)
+    __attribute__((nonnull));
+void close_perf_counters(struct Perf_Counters *const perf)
+    __attribute__((nonnull));
+void read_perf_counters(const struct Perf_Counters *const perf, struct Perf_Sample *const sample)
+    __attribute__((nonnull));
+// Adds the counts between the two samples to the phase of the current line
+void add_phase_counters(struct Perf_Counters *const perf, const enum Timing_Phase phase, const struct Perf_Sample *const begin, const struct Perf_Sample *const end)
+    __attribute__((nonnull));
+void finish_line_counters(struct Perf_Counters *const perf)
+    __attribute__((nonnull));
+// Adds the totals counted by another thread
+void merge_perf_counters(struct Perf_Counters *const perf, const struct Perf_Counters *const other)
+    __attribute__((nonnull));
+void print_line_counters(FILE *const file, const struct Perf_Counters *const perf)
+    __attribute__((nonnull));
+void print_perf_summary(FILE *const file, const struct Perf_Counters *const perf)
+    __attribute__((nonnull));
+
+#endif  // __PERF_COUNTERS
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
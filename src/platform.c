@@ -24,75 +24,78 @@
 // SOURCE
 //------------------------------------------------------------------------------
 
+#ifndef _WIN32
+// Required for clock_gettime, fileno and fsync when compiling with -std=c11
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "platform.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <errno.h>
 #include <io.h>
 #include <conio.h>
+#include <limits.h>
+#include <malloc.h>
+#include <string.h>
 #else // POSIX
 #include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 #endif
 
+void restore_terminal(struct Terminal *const terminal) {
 #ifndef _WIN32 // POSIX
-struct termios old_termios;
-bool terminal_is_configured = false;
-
-static void restore_terminal(void) {
-    if (terminal_is_configured) {
-        if (tcsetattr(STDIN_FILENO, TCSANOW, &old_termios) != EXIT_SUCCESS) {
+    if (terminal->is_configured) {
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &terminal->old_termios) != EXIT_SUCCESS) {
             fprintf(stderr, "Function \"tcsetattr()\" failed with error: %s\n", strerror(errno));
         }
-        terminal_is_configured = false;
     }
+#endif
+    terminal->is_configured = false;
 }
 
 // This fucntion configures the terminal in the non-canonical mode
-// The terminal configuration is automatically restored to the
-// default after the program ends its execution (nothing to worry there)
-static bool configure_terminal_non_canonical(void) {
-    if (!terminal_is_configured) {
+// On Windows, getch already reads the keys without echo, so there is nothing to do
+bool configure_terminal_non_canonical(struct Terminal *const terminal) {
+#ifndef _WIN32 // POSIX
+    if (!terminal->is_configured) {
         if (!isatty(STDIN_FILENO)) {
             fprintf(stderr, "The standard input must be a terminal!\n");
             return false;
         }
-        if (tcgetattr(STDIN_FILENO, &old_termios) != EXIT_SUCCESS) {
+        if (tcgetattr(STDIN_FILENO, &terminal->old_termios) != EXIT_SUCCESS) {
             fprintf(stderr, "Function \"tcgetattr()\" failed with error: %s\n", strerror(errno));
             return false;
         }
-        struct termios new_terminal = old_termios;
+        struct termios new_terminal = terminal->old_termios;
         new_terminal.c_lflag &= (tcflag_t) ~ICANON;  // Disable canonical mode
         new_terminal.c_lflag &= (tcflag_t) ~ECHO;    // Disable echo
         if (tcsetattr(STDIN_FILENO, TCSANOW, &new_terminal) != EXIT_SUCCESS) {
             fprintf(stderr, "Function \"tcsetattr()\" failed with error: %s\n", strerror(errno));
             return false;
         }
-        // If arrived here, it means that the terminal was successfully configured
-        terminal_is_configured = true;
-        // Even if the application crashes, the terminal must be restored
-        if (atexit(restore_terminal) != EXIT_SUCCESS) {
-            restore_terminal();
-            fprintf(stderr, "Function \"atexit()\" failed!\n");
-            return false;
-        }
     }
+#endif
+    // If arrived here, it means that the terminal was successfully configured
+    terminal->is_configured = true;
     return true;
 }
-#endif
 
 enum Keys read_key_without_echo(char *c) {
-#ifndef _WIN32 // POSIX
-    // Make sure that the terminal is in the non-canonical mode
-    configure_terminal_non_canonical();
-#endif
     while (true) { // Keep looping until we get a recognizable key
 #ifdef _WIN32
         const int ch = getch();
@@ -180,22 +183,39 @@ bool foreground_color(FILE *file, enum Foreground_Color color) {
         return false;
     }
 #else // POSIX
-    static const int values[] = {
-        [DEFAULT_FOREGROUND] = 0,
-        [BLACK_FOREGROUND] = 30,
-        [RED_FOREGROUND] = 31,
-        [GREEN_FOREGROUND] = 32,
-        [YELLOW_FOREGROUND] = 33,
-        [BLUE_FOREGROUND] = 34,
-        [MAGENTA_FOREGROUND] = 35,
-        [CYAN_FOREGROUND] = 36,
-        [WHITE_FOREGROUND] = 37,
-    };
-    fprintf(file, "\033[%dm", values[color]);
+    fputs(foreground_color_escape(color), file);
 #endif
     return true;
 }
 
+const char *foreground_color_escape(enum Foreground_Color color) {
+#ifdef _WIN32
+    (void)color;
+    return NULL;
+#else // POSIX
+    static const char *const escapes[] = {
+        [DEFAULT_FOREGROUND] = "\033[0m",
+        [BLACK_FOREGROUND] = "\033[30m",
+        [RED_FOREGROUND] = "\033[31m",
+        [GREEN_FOREGROUND] = "\033[32m",
+        [YELLOW_FOREGROUND] = "\033[33m",
+        [BLUE_FOREGROUND] = "\033[34m",
+        [MAGENTA_FOREGROUND] = "\033[35m",
+        [CYAN_FOREGROUND] = "\033[36m",
+        [WHITE_FOREGROUND] = "\033[37m",
+    };
+    return escapes[color];
+#endif
+}
+
+bool is_terminal(FILE *file) {
+#ifdef _WIN32
+    return _isatty(_fileno(file)) != 0;
+#else // POSIX
+    return isatty(fileno(file)) != 0;
+#endif
+}
+
 bool move_cursor_right(FILE *file, const int n) {
 #ifdef _WIN32
     const int file_fd = _fileno(file);
@@ -295,6 +315,204 @@ bool move_cursor_to_column(FILE *file, const int n) {
     return true;
 }
 
+const void *map_file(const char *const file_name, size_t *const size) {
+#ifdef _WIN32
+    const HANDLE hFile = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        errno = ENOENT;
+        return NULL;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(hFile, &file_size) || (file_size.QuadPart == 0)) {
+        CloseHandle(hFile);
+        errno = EINVAL;
+        return NULL;
+    }
+    const HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if (hMapping == NULL) {
+        errno = EIO;
+        return NULL;
+    }
+    // The view keeps a reference to the mapping object, so it can be closed right away
+    const void *const address = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (address == NULL) {
+        errno = EIO;
+        return NULL;
+    }
+    *size = (size_t)file_size.QuadPart;
+    return address;
+#else // POSIX
+    const int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return NULL;
+    }
+    if (file_stat.st_size <= 0) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    // The mapping remains valid after closing the file descriptor
+    void *const address = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)file_stat.st_size;
+    return address;
+#endif
+}
+
+void unmap_file(const void *const address, const size_t size) {
+    if (address == NULL) {
+        return;
+    }
+#ifdef _WIN32
+    (void)size;
+    if (!UnmapViewOfFile(address)) {
+        fprintf(stderr, "Failed to unmap the view of a file.\n");
+    }
+#else // POSIX
+    if (munmap((void *)address, size) != 0) {
+        fprintf(stderr, "Function \"munmap()\" failed with error: %s\n", strerror(errno));
+    }
+#endif
+}
+
+bool replace_file(const char *const old_name, const char *const new_name) {
+#ifdef _WIN32
+    if (!MoveFileExA(old_name, new_name, MOVEFILE_REPLACE_EXISTING)) {
+        fprintf(stderr, "Failed to replace the file \"%s\".\n", new_name);
+        return false;
+    }
+#else // POSIX
+    if (rename(old_name, new_name) != 0) {
+        fprintf(stderr, "Function \"rename()\" failed with error: %s\n", strerror(errno));
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool sync_file(FILE *file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    if (_commit(_fileno(file)) != 0) {
+        fprintf(stderr, "Failed to flush the file to the disk.\n");
+        return false;
+    }
+#else // POSIX
+    if (fsync(fileno(file)) != 0) {
+        fprintf(stderr, "Function \"fsync()\" failed with error: %s\n", strerror(errno));
+        return false;
+    }
+#endif
+    return true;
+}
+
+uint64_t monotonic_time_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    const uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000000u + (remainder * 1000000000u) / (uint64_t)frequency.QuadPart;
+#else // POSIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+size_t read_from_file(FILE *const file, void *const buffer, const size_t size) {
+    for (;;) {
+#ifdef _WIN32
+        const int count = _read(_fileno(file), buffer, (size > INT_MAX) ? INT_MAX : (unsigned int)size);
+#else // POSIX
+        const ssize_t count = read(fileno(file), buffer, size);
+#endif
+        if (count >= 0) {
+            return (size_t)count;
+        }
+        if (errno != EINTR) {
+            fprintf(stderr, "Couldn't read the %s: %s\n", (file == stdin) ? "standard input" : "input file", strerror(errno));
+            return 0;
+        }
+    }
+}
+
+size_t read_from_stdin(void *const buffer, const size_t size) {
+    return read_from_file(stdin, buffer, size);
+}
+
+FILE *detach_stdout(void) {
+    fflush(stdout);
+#ifdef _WIN32
+    const int fd = _dup(_fileno(stdout));
+    FILE *const file = (fd < 0) ? NULL : _fdopen(fd, "wb");
+    if ((file == NULL) || (_dup2(_fileno(stderr), _fileno(stdout)) != 0)) {
+#else // POSIX
+    const int fd = dup(STDOUT_FILENO);
+    FILE *const file = (fd < 0) ? NULL : fdopen(fd, "wb");
+    if ((file == NULL) || (dup2(STDERR_FILENO, STDOUT_FILENO) < 0)) {
+#endif
+        fprintf(stderr, "Couldn't detach the standard output: %s\n", strerror(errno));
+        if (file != NULL) {
+            fclose(file);
+        }
+        return NULL;
+    }
+    return file;
+}
+
+size_t number_of_processors(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (size_t)info.dwNumberOfProcessors : 1;
+#else // POSIX
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return (processors > 0) ? (size_t)processors : 1;
+#endif
+}
+
+void yield_processor(void) {
+#ifdef _WIN32
+    SwitchToThread();
+#else // POSIX
+    sched_yield();
+#endif
+}
+
+void *allocate_aligned(const size_t size, const size_t alignment) {
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else // POSIX
+    void *pointer = NULL;
+    return (posix_memalign(&pointer, alignment, size) == 0) ? pointer : NULL;
+#endif
+}
+
+void free_aligned(void *const pointer) {
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else // POSIX
+    free(pointer);
+#endif
+}
+
 //------------------------------------------------------------------------------
 // END
 //------------------------------------------------------------------------------
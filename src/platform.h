@@ -28,8 +28,14 @@
 #define __PLATFORM
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
+#ifndef _WIN32 // POSIX
+#include <termios.h>
+#endif
+
 #if !defined(__GNUC__) && !defined(__attribute__)
 #define __attribute__(a)
 #endif
@@ -67,10 +73,30 @@ enum Keys {
     KEY_BACKSPACE,
 };
 
+// Configuration of the terminal saved while it is in the non-canonical mode
+struct Terminal {
+    bool is_configured;
+#ifndef _WIN32 // POSIX
+    struct termios old_termios;
+#endif
+};
+
+// The terminal must be configured before reading keys, and should be
+// restored as soon as the line is read, so the process never leaves it changed
+bool configure_terminal_non_canonical(struct Terminal *const terminal)
+    __attribute__((nonnull));
+void restore_terminal(struct Terminal *const terminal)
+    __attribute__((nonnull));
 enum Keys read_key_without_echo(char *c)
     __attribute__((nonnull));
 bool foreground_color(FILE *file, enum Foreground_Color color)
     __attribute__((nonnull));
+// Returns the escape sequence that sets the color when written to a terminal,
+// or NULL if the color must be set by foreground_color (Windows console)
+const char *foreground_color_escape(enum Foreground_Color color);
+// Returns true if the file is a terminal, where colors can be used
+bool is_terminal(FILE *file)
+    __attribute__((nonnull));
 bool move_cursor_right(FILE *file, const int n)
     __attribute__((nonnull));
 bool move_cursor_left(FILE *file, const int n)
@@ -78,6 +104,40 @@ bool move_cursor_left(FILE *file, const int n)
 bool move_cursor_to_column(FILE *file, const int n)
     __attribute__((nonnull));
 
+// Maps the entire content of a file into memory in read-only mode.
+// Returns NULL on failure (with errno set), otherwise stores the size of the mapping in size
+const void *map_file(const char *const file_name, size_t *const size)
+    __attribute__((nonnull));
+void unmap_file(const void *const address, const size_t size);
+// Replaces the file new_name by old_name in a single step, so that readers
+// of new_name (including existing mappings of it) never see a partial file
+bool replace_file(const char *const old_name, const char *const new_name)
+    __attribute__((nonnull));
+// Flushes the buffers of the file and waits until its content reaches the disk
+bool sync_file(FILE *file)
+    __attribute__((nonnull));
+// Returns the time in nanoseconds of a clock that is not affected by changes to the system time
+uint64_t monotonic_time_ns(void);
+// Reads whatever is available from the file, waiting only if nothing is, so that
+// pipes and FIFOs are consumed as soon as the data arrives. The buffer of the
+// FILE is bypassed. Returns zero at the end of the input or on error
+size_t read_from_file(FILE *const file, void *const buffer, const size_t size)
+    __attribute__((nonnull));
+// Same as read_from_file, but for the standard input
+size_t read_from_stdin(void *const buffer, const size_t size)
+    __attribute__((nonnull));
+// Returns a file that writes to the original standard output, which is redirected
+// to the standard error, so that nothing else can write to it. Returns NULL on failure
+FILE *detach_stdout(void);
+// Returns the number of processors currently online, at least one
+size_t number_of_processors(void);
+// Gives the processor to other threads, used while waiting for them
+void yield_processor(void);
+// Memory returned by allocate_aligned must be released by free_aligned.
+// The alignment must be a power of two. Returns NULL on failure
+void *allocate_aligned(const size_t size, const size_t alignment);
+void free_aligned(void *const pointer);
+
 #endif  // __PLATFORM
 
 //------------------------------------------------------------------------------
@@ -26,16 +26,34 @@
 
 #include "printing.h"
 
+#include <inttypes.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "data-structures/sized_string.h"
 #include "platform.h"
 
+// Messages longer than this are truncated
+#define DIAGNOSTIC_MESSAGE_SIZE 1024
+// Enough for a message with its caret and location, longer ones take more than one write
+#define DIAGNOSTIC_LINE_SIZE (2 * DIAGNOSTIC_MESSAGE_SIZE)
+#define DIAGNOSTIC_SINK_INITIAL_SIZE 4096
+// The sink is written as soon as it holds more than this, even if it isn't flushed
+#define DIAGNOSTIC_SINK_LIMIT (64 * 1024)
+
 void print_crash_and_exit(const char *const msg, ...) {
-    foreground_color(stderr, RED_FOREGROUND);
+    const bool use_color = is_terminal(stderr);
+    if (use_color) {
+        foreground_color(stderr, RED_FOREGROUND);
+    }
     fprintf(stderr, "[Crash] ");
-    foreground_color(stderr, DEFAULT_FOREGROUND);
+    if (use_color) {
+        foreground_color(stderr, DEFAULT_FOREGROUND);
+    }
     va_list args;
     va_start(args, msg);
     vfprintf(stderr, msg, args);
@@ -43,28 +61,323 @@ void print_crash_and_exit(const char *const msg, ...) {
     exit(EXIT_FAILURE);
 }
 
-void print_error(const char *const msg, ...) {
-    foreground_color(stderr, RED_FOREGROUND);
-    fprintf(stderr, "[Error] ");
-    foreground_color(stderr, DEFAULT_FOREGROUND);
+struct Diagnostics create_diagnostics(FILE *const file) {
+    return (struct Diagnostics){
+        .file = file,
+        .sink = NULL,
+        .callback = NULL,
+        .user_data = NULL,
+        .use_color = is_terminal(file),
+        .column = NO_DIAGNOSTIC_COLUMN,
+    };
+}
+
+struct Diagnostic_Sink create_diagnostic_sink(FILE *const file, const enum Diagnostic_Format format) {
+    return (struct Diagnostic_Sink){
+        .file = file,
+        .format = format,
+        .use_color = (format == DIAGNOSTIC_FORMAT_TEXT) && is_terminal(file),
+        .text = NULL,
+        .used = 0,
+        .capacity = 0,
+    };
+}
+
+static void write_sink(struct Diagnostic_Sink *const sink) {
+    if (sink->used > 0) {
+        fwrite(sink->text, sizeof(char), sink->used, sink->file);
+        fflush(sink->file);
+        sink->used = 0;
+    }
+}
+
+void destroy_diagnostic_sink(struct Diagnostic_Sink *const sink) {
+    write_sink(sink);
+    free(sink->text);
+    sink->text = NULL;
+    sink->capacity = 0;
+}
+
+void flush_diagnostics(struct Diagnostics *const diagnostics) {
+    if (diagnostics->sink != NULL) {
+        write_sink(diagnostics->sink);
+    }
+}
+
+static void reserve_text(struct Diagnostic_Sink *const sink, const size_t size) {
+    if ((sink->capacity - sink->used) >= size) {
+        return;
+    }
+    size_t capacity = (sink->capacity == 0) ? DIAGNOSTIC_SINK_INITIAL_SIZE : sink->capacity;
+    while ((capacity - sink->used) < size) {
+        capacity *= 2;
+    }
+    char *const text = realloc(sink->text, capacity);
+    if (text == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the diagnostics!\n");
+    }
+    sink->text = text;
+    sink->capacity = capacity;
+}
+
+__attribute__((format(printf, 2, 3)))
+static void append_text(struct Diagnostic_Sink *const sink, const char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (length <= 0) {
+        return;
+    }
+    reserve_text(sink, (size_t)length + 1);
+    va_start(args, format);
+    vsnprintf(&sink->text[sink->used], sink->capacity - sink->used, format, args);
+    va_end(args);
+    sink->used += (size_t)length;
+}
+
+static void append_json_string(struct Diagnostic_Sink *const sink, const char *const string) {
+    static const char hex_digits[] = "0123456789abcdef";
+    const size_t length = strlen(string);
+    // Each character takes at most six characters once escaped
+    reserve_text(sink, 6 * length + 3);
+    char *text = &sink->text[sink->used];
+    *text++ = '"';
+    for (size_t i = 0; i < length; i++) {
+        const unsigned char c = (unsigned char)string[i];
+        if ((c == '"') || (c == '\\')) {
+            *text++ = '\\';
+            *text++ = (char)c;
+        } else if (c == '\n') {
+            *text++ = '\\';
+            *text++ = 'n';
+        } else if (c < 0x20) {
+            memcpy(text, "\\u00", 4);
+            text[4] = hex_digits[c >> 4];
+            text[5] = hex_digits[c & 0xF];
+            text += 6;
+        } else {
+            *text++ = (char)c;
+        }
+    }
+    *text++ = '"';
+    sink->used = (size_t)(text - sink->text);
+}
+
+static void append_color(struct Diagnostic_Sink *const sink, const enum Foreground_Color color) {
+    if (!sink->use_color) {
+        return;
+    }
+    const char *const escape = foreground_color_escape(color);
+    if (escape != NULL) {
+        append_text(sink, "%s", escape);
+    } else {
+        // The color of the console is set by a function call, so the text before it must be written first
+        write_sink(sink);
+        foreground_color(sink->file, color);
+    }
+}
+
+static void append_diagnostic(struct Diagnostic_Sink *const sink, const struct Diagnostic *const diagnostic) {
+    const bool is_error = (diagnostic->level == DIAGNOSTIC_ERROR);
+    if (sink->format == DIAGNOSTIC_FORMAT_JSON) {
+        append_text(sink, "{\"severity\":\"%s\",\"code\":\"%08" PRIx32 "\"", is_error ? "error" : "warning", diagnostic->code);
+        if (diagnostic->source != NULL) {
+            append_text(sink, ",\"source\":");
+            append_json_string(sink, diagnostic->source);
+            append_text(sink, ",\"line\":%zu", diagnostic->line);
+        }
+        if (diagnostic->column != NO_DIAGNOSTIC_COLUMN) {
+            append_text(sink, ",\"column\":%zu", diagnostic->column + 1);
+        }
+        append_text(sink, ",\"message\":");
+        append_json_string(sink, diagnostic->message);
+        append_text(sink, "}\n");
+        return;
+    }
+    if ((diagnostic->source == NULL) && (diagnostic->column != NO_DIAGNOSTIC_COLUMN)) {
+        append_text(sink, "%*s^\n", (int)(diagnostic->column + 2), "");
+    }
+    append_color(sink, is_error ? RED_FOREGROUND : YELLOW_FOREGROUND);
+    append_text(sink, is_error ? "[Error] " : "[Warning] ");
+    append_color(sink, DEFAULT_FOREGROUND);
+    if (diagnostic->source != NULL) {
+        if (diagnostic->column != NO_DIAGNOSTIC_COLUMN) {
+            append_text(sink, "%s:%zu:%zu: ", diagnostic->source, diagnostic->line, diagnostic->column + 1);
+        } else {
+            append_text(sink, "%s:%zu: ", diagnostic->source, diagnostic->line);
+        }
+    }
+    append_text(sink, "%s\n", diagnostic->message);
+}
+
+// Without a sink, each message is formatted on the stack, so it allocates no buffer
+struct Diagnostic_Line {
+    FILE *file;
+    size_t used;
+    char text[DIAGNOSTIC_LINE_SIZE];
+};
+
+static void write_line(struct Diagnostic_Line *const line) {
+    if (line->used > 0) {
+        fwrite(line->text, sizeof(char), line->used, line->file);
+        line->used = 0;
+    }
+}
+
+__attribute__((format(printf, 2, 3)))
+static void format_line(struct Diagnostic_Line *const line, const char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(&line->text[line->used], sizeof(line->text) - line->used, format, args);
+    va_end(args);
+    if (length <= 0) {
+        return;
+    }
+    if ((size_t)length < (sizeof(line->text) - line->used)) {
+        line->used += (size_t)length;
+        return;
+    }
+    // It doesn't fit, so the text before it is written first
+    write_line(line);
+    va_start(args, format);
+    if ((size_t)length < sizeof(line->text)) {
+        vsnprintf(line->text, sizeof(line->text), format, args);
+        line->used = (size_t)length;
+    } else {
+        vfprintf(line->file, format, args);
+    }
+    va_end(args);
+}
+
+static void pad_line(struct Diagnostic_Line *const line, size_t count) {
+    while (count > 0) {
+        if (line->used == sizeof(line->text)) {
+            write_line(line);
+        }
+        const size_t length = ((sizeof(line->text) - line->used) < count) ? (sizeof(line->text) - line->used) : count;
+        memset(&line->text[line->used], ' ', length);
+        line->used += length;
+        count -= length;
+    }
+}
+
+static void color_line(struct Diagnostic_Line *const line, const enum Foreground_Color color) {
+    const char *const escape = foreground_color_escape(color);
+    if (escape != NULL) {
+        format_line(line, "%s", escape);
+    } else {
+        // The color of the console is set by a function call, so the text before it must be written first
+        write_line(line);
+        foreground_color(line->file, color);
+    }
+}
+
+// The caret and the message are written with a single call, unless the console colors split them
+static void write_diagnostic(const struct Diagnostics *const diagnostics, const struct Diagnostic *const diagnostic) {
+    const bool is_error = (diagnostic->level == DIAGNOSTIC_ERROR);
+    struct Diagnostic_Line line;
+    line.file = diagnostics->file;
+    line.used = 0;
+    if ((diagnostic->source == NULL) && (diagnostic->column != NO_DIAGNOSTIC_COLUMN)) {
+        pad_line(&line, diagnostic->column + 2);
+        format_line(&line, "^\n");
+    }
+    if (diagnostics->use_color) {
+        color_line(&line, is_error ? RED_FOREGROUND : YELLOW_FOREGROUND);
+    }
+    format_line(&line, is_error ? "[Error] " : "[Warning] ");
+    if (diagnostics->use_color) {
+        color_line(&line, DEFAULT_FOREGROUND);
+    }
+    if (diagnostic->source != NULL) {
+        if (diagnostic->column != NO_DIAGNOSTIC_COLUMN) {
+            format_line(&line, "%s:%zu:%zu: ", diagnostic->source, diagnostic->line, diagnostic->column + 1);
+        } else {
+            format_line(&line, "%s:%zu: ", diagnostic->source, diagnostic->line);
+        }
+    }
+    format_line(&line, "%s\n", diagnostic->message);
+    write_line(&line);
+    fflush(diagnostics->file);
+}
+
+void emit_diagnostic(struct Diagnostics *const diagnostics, const struct Diagnostic *const diagnostic) {
+    if (diagnostics->callback != NULL) {
+        diagnostics->callback(diagnostics->user_data, diagnostic);
+    } else if (diagnostics->sink != NULL) {
+        append_diagnostic(diagnostics->sink, diagnostic);
+        if (diagnostics->sink->used > DIAGNOSTIC_SINK_LIMIT) {
+            write_sink(diagnostics->sink);
+        }
+    } else {
+        write_diagnostic(diagnostics, diagnostic);
+    }
+}
+
+void store_diagnostic(struct Stored_Diagnostic *const stored, const struct Diagnostic *const diagnostic) {
+    stored->level = diagnostic->level;
+    stored->code = diagnostic->code;
+    stored->column = diagnostic->column;
+    snprintf(stored->message, sizeof(stored->message), "%s", diagnostic->message);
+}
+
+struct Diagnostic stored_diagnostic(const struct Stored_Diagnostic *const stored) {
+    return (struct Diagnostic){
+        .level = stored->level,
+        .code = stored->code,
+        .column = stored->column,
+        .source = NULL,
+        .line = 0,
+        .message = stored->message,
+    };
+}
+
+// The code of a message is the hash of its format string, so it doesn't depend on the arguments
+static inline uint32_t diagnostic_code(const char *const msg) {
+    const uint64_t hash = hash_string(create_string((char *)msg));
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static void print_diagnostic(struct Diagnostics *const diagnostics, const enum Diagnostic_Level level, const char *const msg, va_list args) {
+    char message[DIAGNOSTIC_MESSAGE_SIZE];
+    const int length = vsnprintf(message, sizeof(message), msg, args);
+    if ((length > 0) && ((size_t)length < sizeof(message)) && (message[length - 1] == '\n')) {
+        message[length - 1] = '\0';
+    }
+    const struct Diagnostic diagnostic = {
+        .level = level,
+        .code = diagnostic_code(msg),
+        .column = diagnostics->column,
+        .source = NULL,
+        .line = 0,
+        .message = message,
+    };
+    diagnostics->column = NO_DIAGNOSTIC_COLUMN;
+    emit_diagnostic(diagnostics, &diagnostic);
+}
+
+void print_error(struct Diagnostics *const diagnostics, const char *const msg, ...) {
     va_list args;
     va_start(args, msg);
-    vfprintf(stderr, msg, args);
+    print_diagnostic(diagnostics, DIAGNOSTIC_ERROR, msg, args);
     va_end(args);
 }
 
-void print_warning(const char *const msg, ...) {
-    foreground_color(stderr, YELLOW_FOREGROUND);
-    fprintf(stderr, "[Warning] ");
-    foreground_color(stderr, DEFAULT_FOREGROUND);
+void print_warning(struct Diagnostics *const diagnostics, const char *const msg, ...) {
     va_list args;
     va_start(args, msg);
-    vfprintf(stderr, msg, args);
+    print_diagnostic(diagnostics, DIAGNOSTIC_WARNING, msg, args);
     va_end(args);
 }
 
-void print_column(const size_t column) {
-    fprintf(stderr, "%*s^\n", (int)(column + 2), "");
+void print_column(struct Diagnostics *const diagnostics, const size_t column) {
+    // The column is part of the next message, where the text format prints the caret
+    diagnostics->column = column;
+}
+
+unsigned int max_uint(const unsigned int a, const unsigned int b) {
+    return ((a > b) ? a : b);
 }
 
 //------------------------------------------------------------------------------
@@ -27,19 +27,114 @@
 #ifndef __PRINT_ERRORS
 #define __PRINT_ERRORS
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #if !defined(__GNUC__) && !defined(__attribute__)
 #define __attribute__(a)
 #endif
 
+enum Diagnostic_Level {
+    DIAGNOSTIC_ERROR,
+    DIAGNOSTIC_WARNING,
+};
+
+enum Diagnostic_Format {
+    DIAGNOSTIC_FORMAT_TEXT,
+    // One compact JSON object per line, with the keys "severity", "code",
+    // "source", "line", "column" and "message" (the absent ones are omitted)
+    DIAGNOSTIC_FORMAT_JSON,
+};
+
+// Used when a message doesn't refer to a column of the expression
+#define NO_DIAGNOSTIC_COLUMN ((size_t)-1)
+
+struct Diagnostic {
+    enum Diagnostic_Level level;
+    // Identifies the kind of message regardless of its arguments, since it is
+    // computed from the format string passed to print_error or print_warning
+    uint32_t code;
+    size_t column;
+    // File and line (starting at one) from which the expression was read, if any
+    const char *source;
+    size_t line;
+    // The message has no trailing new line
+    const char *message;
+};
+
+#define STORED_DIAGNOSTIC_MESSAGE_SIZE 256
+
+// Copy of a diagnostic, kept by the modes that report the diagnostics of a line
+// after the callback returns. Longer messages are truncated
+struct Stored_Diagnostic {
+    enum Diagnostic_Level level;
+    uint32_t code;
+    size_t column;
+    char message[STORED_DIAGNOSTIC_MESSAGE_SIZE];
+};
+
+// The diagnostic is only valid during the call
+typedef void (*Diagnostic_Callback)(void *const user_data, const struct Diagnostic *const diagnostic);
+
+// Collects the messages written to a file, so that the ones produced by an
+// evaluation are written at once by flush_diagnostics, instead of one write
+// per message. It also defines the format of the messages. A sink isn't
+// thread safe, so it must only be used by the thread that owns the context
+struct Diagnostic_Sink {
+    FILE *file;
+    enum Diagnostic_Format format;
+    bool use_color;
+    char *text;
+    size_t used;
+    size_t capacity;
+};
+
+// Destination of the errors and warnings of an interpreter context. If there is a
+// callback, the messages are passed to it, otherwise they are added to the sink,
+// if any, or printed to the file
+struct Diagnostics {
+    FILE *file;
+    struct Diagnostic_Sink *sink;
+    Diagnostic_Callback callback;
+    void *user_data;
+    // Colors are only used when the file is a terminal
+    bool use_color;
+    // Column set by print_column, which is reported with the next message
+    size_t column;
+};
+
+struct Diagnostics create_diagnostics(FILE *const file)
+    __attribute__((nonnull));
+struct Diagnostic_Sink create_diagnostic_sink(FILE *const file, const enum Diagnostic_Format format)
+    __attribute__((nonnull));
+// Writes the pending messages before releasing the sink
+void destroy_diagnostic_sink(struct Diagnostic_Sink *const sink)
+    __attribute__((nonnull));
+// Writes the messages collected by the sink of the diagnostics, if any
+void flush_diagnostics(struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
+// Crashes are reported to stderr, because the process is terminated
 void print_crash_and_exit(const char *const msg, ...)
     __attribute__((nonnull, __noreturn__, format(printf, 1, 2)));
-void print_error(const char *const msg, ...)
-    __attribute__((nonnull, format(printf, 1, 2)));
-void print_warning(const char *const msg, ...)
-    __attribute__((nonnull, format(printf, 1, 2)));
-void print_column(const size_t column);
+void print_error(struct Diagnostics *const diagnostics, const char *const msg, ...)
+    __attribute__((nonnull, format(printf, 2, 3)));
+void print_warning(struct Diagnostics *const diagnostics, const char *const msg, ...)
+    __attribute__((nonnull, format(printf, 2, 3)));
+void print_column(struct Diagnostics *const diagnostics, const size_t column)
+    __attribute__((nonnull));
+// Reports a diagnostic that was already formatted, usually collected by a callback,
+// keeping its code. Used to add the source and the line to the diagnostics
+void emit_diagnostic(struct Diagnostics *const diagnostics, const struct Diagnostic *const diagnostic)
+    __attribute__((nonnull));
+void store_diagnostic(struct Stored_Diagnostic *const stored, const struct Diagnostic *const diagnostic)
+    __attribute__((nonnull));
+// The diagnostic points to the message of the copy, and has no source nor line
+struct Diagnostic stored_diagnostic(const struct Stored_Diagnostic *const stored)
+    __attribute__((nonnull));
+// Used to compute the width of the columns of the tables printed
+unsigned int max_uint(const unsigned int a, const unsigned int b);
 
 #endif  // __PRINT_ERRORS
 
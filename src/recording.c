@@ -0,0 +1,335 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "recording.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "journal.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+#include "snapshot.h"
+
+#define RECORDING_VERSION 1
+#define RECORDING_BYTE_ORDER 0x01020304u
+// Size of the fields that precede the line in each entry
+#define RECORDING_ENTRY_SIZE (2 * sizeof(uint64_t) + sizeof(uint32_t))
+
+static const char recording_magic[8] = {'L', 'I', 'I', 'R', 'R', 'E', 'C', 'D'};
+
+struct Recording_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    // The snapshot starts right after the header, so that its values are aligned
+    // when the recording is mapped in memory, and the entries right after it
+    uint64_t snapshot_offset;
+    uint64_t snapshot_size;
+    uint64_t reserved[4];
+};
+
+_Static_assert(sizeof(struct Recording_Header) == 64, "The recording header must have 64 bytes");
+_Static_assert((sizeof(struct Recording_Header) % SNAPSHOT_ALIGNMENT) == 0, "The snapshot must be aligned");
+
+struct Replay_Line {
+    struct String text;
+    uint64_t duration;
+};
+
+bool open_recording(struct Recording *const recording, struct Context *const ctx, const char *const file_name) {
+    *recording = (struct Recording){
+        .file = fopen(file_name, "wb"),
+        .diagnostics = ctx->diagnostics,
+        .start = monotonic_time_ns(),
+        .has_error = false,
+    };
+    if (recording->file == NULL) {
+        print_error(&ctx->diagnostics, "Couldn't create the recording \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    struct Recording_Header header = {
+        .version = RECORDING_VERSION,
+        .byte_order = RECORDING_BYTE_ORDER,
+        .snapshot_offset = sizeof(struct Recording_Header),
+    };
+    memcpy(header.magic, recording_magic, sizeof(header.magic));
+    bool error = (fwrite(&header, sizeof(header), 1, recording->file) != 1);
+    error = error || write_snapshot(&ctx->vars, recording->file);
+    // The size of the snapshot is only known after it is written
+    const long end = error ? -1 : ftell(recording->file);
+    if (end < 0) {
+        error = true;
+    } else {
+        header.snapshot_size = (uint64_t)end - header.snapshot_offset;
+        error = (fseek(recording->file, 0, SEEK_SET) != 0)
+            || (fwrite(&header, sizeof(header), 1, recording->file) != 1)
+            || (fseek(recording->file, 0, SEEK_END) != 0)
+            || (fflush(recording->file) != 0);
+    }
+    if (error) {
+        print_error(&ctx->diagnostics, "Couldn't write the recording \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        fclose(recording->file);
+        recording->file = NULL;
+        remove(file_name);
+        return true;
+    }
+    return false;
+}
+
+void record_line(struct Recording *const recording, const struct String line, const uint64_t start, const uint64_t duration) {
+    if ((recording->file == NULL) || recording->has_error) {
+        return;
+    }
+    const uint64_t time = start - recording->start;
+    const uint32_t length = line.length;
+    // The lines are typed by a person, so they are flushed one by one, which keeps
+    // the recording complete even if the session doesn't end normally
+    if ((fwrite(&time, sizeof(time), 1, recording->file) != 1)
+        || (fwrite(&duration, sizeof(duration), 1, recording->file) != 1)
+        || (fwrite(&length, sizeof(length), 1, recording->file) != 1)
+        || (fwrite(line.data, sizeof(char), length, recording->file) != length)
+        || (fflush(recording->file) != 0)) {
+        print_error(&recording->diagnostics, "Couldn't write the recording, because of the following error: %s\n", strerror(errno));
+        recording->has_error = true;
+    }
+}
+
+bool close_recording(struct Recording *const recording) {
+    if (recording->file == NULL) {
+        return recording->has_error;
+    }
+    if (fclose(recording->file) != 0) {
+        print_error(&recording->diagnostics, "Couldn't write the recording, because of the following error: %s\n", strerror(errno));
+        recording->has_error = true;
+    }
+    recording->file = NULL;
+    return recording->has_error;
+}
+
+// Returns a description of the problem found, or NULL if the header is valid
+static const char *validate_header(const void *const mapping, const size_t size) {
+    if (size < sizeof(struct Recording_Header)) {
+        return "The file is too small to be a recording";
+    }
+    const struct Recording_Header *const header = mapping;
+    if (memcmp(header->magic, recording_magic, sizeof(recording_magic)) != 0) {
+        return "The file is not a recording";
+    }
+    if (header->version != RECORDING_VERSION) {
+        return "Unsupported recording version";
+    }
+    if (header->byte_order != RECORDING_BYTE_ORDER) {
+        return "The recording was saved by a machine with a different byte order";
+    }
+    if ((header->snapshot_offset != sizeof(struct Recording_Header)) || (header->snapshot_size > (size - header->snapshot_offset))) {
+        return "Invalid recording header";
+    }
+    return NULL;
+}
+
+// Returns NULL if found an error
+static struct Replay_Line *read_lines(struct Context *const ctx, const char *const file_name, const char *const data, const size_t size) {
+    struct Replay_Line *lines = array_new(sizeof(struct Replay_Line), 1024);
+    if (lines == NULL) {
+        print_crash_and_exit("Couldn't allocate memory to replay the recording!\n");
+    }
+    size_t offset = 0;
+    while (offset < size) {
+        uint64_t duration = 0;
+        uint32_t length = 0;
+        if ((size - offset) >= RECORDING_ENTRY_SIZE) {
+            memcpy(&duration, &data[offset + sizeof(uint64_t)], sizeof(duration));
+            memcpy(&length, &data[offset + 2 * sizeof(uint64_t)], sizeof(length));
+        }
+        if (((size - offset) < RECORDING_ENTRY_SIZE) || ((size - offset - RECORDING_ENTRY_SIZE) < length)) {
+            // The session may have been interrupted while writing the last line
+            print_warning(&ctx->diagnostics, "The recording \"%s\" is truncated, so its last line was ignored\n", file_name);
+            break;
+        }
+        if (length > UINT16_MAX) {
+            print_error(&ctx->diagnostics, "The recording \"%s\" has a line with %" PRIu32 " characters, which is too long!\n", file_name, length);
+            array_del(lines);
+            return NULL;
+        }
+        offset += RECORDING_ENTRY_SIZE;
+        const struct Replay_Line line = {
+            .text = create_sized_string((char *)&data[offset], (String_Length)length),
+            .duration = duration,
+        };
+        array_push(lines, line);
+        if (lines == NULL) {
+            print_crash_and_exit("Couldn't allocate memory to replay the recording!\n");
+        }
+        offset += length;
+    }
+    return lines;
+}
+
+static void ignore_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    (void)user_data;
+    (void)diagnostic;
+}
+
+// Returns the number of lines evaluated, which is smaller than the number of lines if one of them called exit
+static size_t evaluate_lines(struct Context *const ctx, const struct Replay_Line *const lines, uint64_t *const latencies, size_t *const errors) {
+    const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+    ctx->diagnostics.callback = ignore_diagnostic;
+    *errors = 0;
+    size_t evaluated = 0;
+    while ((evaluated < array_size(lines)) && ((ctx->actions & ACTION_EXIT) == 0)) {
+        const uint64_t start = monotonic_time_ns();
+        enum Evaluation_Status status = Eval_Error;
+        array_free_all(ctx->parser.nodes);
+        struct Parsed_Line parsed;
+        if (parse_string(ctx, &ctx->parser, lines[evaluated].text, &parsed, NULL, NULL) != PARSE_ERROR) {
+            status = Eval_OK;
+            evaluate(&ctx->parser, parsed.head_idx, &status);
+        }
+        latencies[evaluated] = monotonic_time_ns() - start;
+        if (status == Eval_Error) {
+            (*errors)++;
+        }
+        evaluated++;
+    }
+    ctx->diagnostics = previous_diagnostics;
+    if (ctx->vars.journal != NULL) {
+        commit_journal(ctx->vars.journal);
+    }
+    return evaluated;
+}
+
+static int compare_latencies(const void *const a, const void *const b) {
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank percentile, in microseconds, of the sorted latencies
+static double percentile(const uint64_t *const sorted, const size_t count, const double fraction) {
+    size_t rank = (size_t)ceil(fraction * (double)count);
+    rank = (rank == 0) ? 1 : rank;
+    return (double)sorted[rank - 1] / 1e3;
+}
+
+static void print_report(const char *const file_name, const struct Replay_Line *const lines, uint64_t *const latencies, const size_t evaluated, const size_t errors) {
+    uint64_t total = 0;
+    uint64_t recorded = 0;
+    for (size_t i = 0; i < evaluated; i++) {
+        total += latencies[i];
+        recorded += lines[i].duration;
+    }
+    qsort(latencies, evaluated, sizeof(uint64_t), compare_latencies);
+    const double total_ms = (double)total / 1e6;
+    printf("Replayed %zu lines of \"%s\" in %.3lf ms (%.0lf lines/s), %zu of them with errors\n",
+           evaluated, file_name, total_ms, (total > 0) ? ((double)evaluated * 1e9 / (double)total) : 0.0, errors);
+    if (evaluated == 0) {
+        return;
+    }
+    printf("Latency (us): min %.3lf, p50 %.3lf, p90 %.3lf, p99 %.3lf, p99.9 %.3lf, max %.3lf, mean %.3lf\n",
+           (double)latencies[0] / 1e3, percentile(latencies, evaluated, 0.5), percentile(latencies, evaluated, 0.9),
+           percentile(latencies, evaluated, 0.99), percentile(latencies, evaluated, 0.999),
+           (double)latencies[evaluated - 1] / 1e3, (double)total / (1e3 * (double)evaluated));
+    printf("The recorded session took %.3lf ms to evaluate the same lines", (double)recorded / 1e6);
+    if (total > 0) {
+        printf(" (%.2lfx the replay)", (double)recorded / (double)total);
+    }
+    printf("\n");
+}
+
+bool replay_recording(struct Context *const ctx, const char *const file_name) {
+    size_t size = 0;
+    const char *const mapping = map_file(file_name, &size);
+    if (mapping == NULL) {
+        print_error(&ctx->diagnostics, "Couldn't read the recording \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    const char *const problem = validate_header(mapping, size);
+    if (problem != NULL) {
+        print_error(&ctx->diagnostics, "Couldn't replay the recording \"%s\": %s!\n", file_name, problem);
+        unmap_file(mapping, size);
+        return true;
+    }
+    const struct Recording_Header *const header = (const struct Recording_Header *)mapping;
+    const size_t entries_offset = (size_t)(header->snapshot_offset + header->snapshot_size);
+    if (load_snapshot(&ctx->vars, &mapping[header->snapshot_offset], (size_t)header->snapshot_size, file_name)) {
+        unmap_file(mapping, size);
+        return true;
+    }
+    struct Replay_Line *const lines = read_lines(ctx, file_name, &mapping[entries_offset], size - entries_offset);
+    if (lines == NULL) {
+        unmap_file(mapping, size);
+        return true;
+    }
+    uint64_t *const latencies = malloc((array_size(lines) + 1) * sizeof(uint64_t));
+    if (latencies == NULL) {
+        print_crash_and_exit("Couldn't allocate memory to replay the recording!\n");
+    }
+    size_t errors = 0;
+    const size_t evaluated = evaluate_lines(ctx, lines, latencies, &errors);
+    print_report(file_name, lines, latencies, evaluated, errors);
+    free(latencies);
+    array_del(lines);
+    unmap_file(mapping, size);
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
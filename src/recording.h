@@ -0,0 +1,104 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __RECORDING
+#define __RECORDING
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "context.h"
+#include "data-structures/sized_string.h"
+#include "printing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Recording of an interactive session, which can be replayed as a benchmark.
+// All integers are stored in the byte order of the machine that wrote it.
+// File layout:
+//   struct Recording_Header  (64 bytes)
+//   snapshot of the variables when the recording started (see snapshot.h)
+//   entries until the end of the file, each one being:
+//     uint64_t time      (nanoseconds since the start of the recording)
+//     uint64_t duration  (nanoseconds spent lexing, parsing and evaluating the line)
+//     uint32_t length
+//     char line[length]  (not null terminated)
+
+struct Recording {
+    FILE *file;
+    // Copy of the diagnostics of the context, used to report write errors
+    struct Diagnostics diagnostics;
+    uint64_t start;
+    bool has_error;
+};
+
+// Writes the header and the current variables. Returns true if found an error
+bool open_recording(struct Recording *const recording, struct Context *const ctx, const char *const file_name)
+    __attribute__((nonnull));
+// The start is the time given by monotonic_time_ns when the line began to be interpreted
+void record_line(struct Recording *const recording, const struct String line, const uint64_t start, const uint64_t duration)
+    __attribute__((nonnull));
+// Returns true if found an error while writing any line
+bool close_recording(struct Recording *const recording)
+    __attribute__((nonnull));
+
+// Restores the variables of the recording, evaluates its lines as fast as
+// possible, without printing the results nor the diagnostics, and reports
+// the throughput and the percentiles of the latency of the lines.
+// Returns true if found an error
+bool replay_recording(struct Context *const ctx, const char *const file_name)
+    __attribute__((nonnull));
+
+#endif  // __RECORDING
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
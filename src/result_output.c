@@ -0,0 +1,210 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "result_output.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+
+// Number of results per block, whose status fills whole bytes
+#define RESULT_BLOCK_LENGTH (128 * 1024)
+#define RESULT_BUFFER_ALIGNMENT 4096
+#define RESULT_STATUS_ERROR 1
+#define RESULT_STATUS_NO_VALUE 2
+// The header is rewritten with the final shape, so its size can't change
+#define NPY_HEADER_SIZE 128
+#define NPY_PREAMBLE_SIZE 10
+
+static void report_write_error(struct Result_Output *const output) {
+    if (!output->has_error) {
+        print_error(&output->diagnostics, "Couldn't write the results, because of the following error: %s\n", strerror(errno));
+        output->has_error = true;
+    }
+}
+
+static bool write_npy_header(struct Result_Output *const output) {
+    char header[NPY_HEADER_SIZE + 1];
+    memcpy(header, "\x93NUMPY\x01\x00", 8);
+    header[8] = (char)(NPY_HEADER_SIZE - NPY_PREAMBLE_SIZE);
+    header[9] = 0;
+    const int length = snprintf(&header[NPY_PREAMBLE_SIZE], sizeof(header) - NPY_PREAMBLE_SIZE,
+        "{'descr': '<f8', 'fortran_order': False, 'shape': (%llu,), }", (unsigned long long)output->count);
+    // The header is padded with spaces and ends with a new line
+    memset(&header[NPY_PREAMBLE_SIZE + length], ' ', (size_t)(NPY_HEADER_SIZE - NPY_PREAMBLE_SIZE - length));
+    header[NPY_HEADER_SIZE - 1] = '\n';
+    return (fwrite(header, sizeof(char), NPY_HEADER_SIZE, output->file) != NPY_HEADER_SIZE);
+}
+
+static FILE *open_unbuffered(const char *const file_name) {
+    FILE *const file = fopen(file_name, "wb");
+    if (file != NULL) {
+        // The buffers of this module are already large
+        setvbuf(file, NULL, _IONBF, 0);
+    }
+    return file;
+}
+
+bool open_result_output(struct Result_Output *const output, const char *const file_name, struct Diagnostics *const diagnostics) {
+    *output = (struct Result_Output){
+        .format = RESULT_FORMAT_TEXT,
+        .diagnostics = *diagnostics,
+    };
+    if (file_name == NULL) {
+        return false;
+    }
+    const size_t length = strlen(file_name);
+    output->format = ((length >= 4) && (strcmp(&file_name[length - 4], ".npy") == 0)) ? RESULT_FORMAT_NPY : RESULT_FORMAT_RAW;
+    output->values = allocate_aligned(RESULT_BLOCK_LENGTH * sizeof(double), RESULT_BUFFER_ALIGNMENT);
+    output->status = allocate_aligned(RESULT_BLOCK_LENGTH / 4, RESULT_BUFFER_ALIGNMENT);
+    if ((output->values == NULL) || (output->status == NULL)) {
+        print_crash_and_exit("Couldn't allocate memory for the results!\n");
+    }
+    memset(output->status, 0, RESULT_BLOCK_LENGTH / 4);
+    char status_name[length + sizeof(".status")];
+    snprintf(status_name, sizeof(status_name), "%s.status", file_name);
+    output->file = open_unbuffered(file_name);
+    if (output->file == NULL) {
+        print_error(diagnostics, "Couldn't open the file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        close_result_output(output);
+        return true;
+    }
+    output->status_file = open_unbuffered(status_name);
+    if (output->status_file == NULL) {
+        print_error(diagnostics, "Couldn't open the file \"%s\", because of the following error: %s\n", status_name, strerror(errno));
+        close_result_output(output);
+        return true;
+    }
+    if ((output->format == RESULT_FORMAT_NPY) && write_npy_header(output)) {
+        report_write_error(output);
+        close_result_output(output);
+        return true;
+    }
+    return false;
+}
+
+static void flush_results(struct Result_Output *const output) {
+    if (output->used == 0) {
+        return;
+    }
+    const size_t status_size = (2 * output->used + 7) / 8;
+    if ((fwrite(output->values, sizeof(double), output->used, output->file) != output->used)
+        || (fwrite(output->status, sizeof(uint8_t), status_size, output->status_file) != status_size)) {
+        report_write_error(output);
+    }
+    memset(output->status, 0, status_size);
+    output->used = 0;
+}
+
+static inline void store_little_endian(uint8_t *const destination, const double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (size_t i = 0; i < sizeof(bits); i++) {
+        destination[i] = (uint8_t)(bits >> (8 * i));
+    }
+}
+
+void write_result(struct Result_Output *const output, const enum Evaluation_Status status, const double value) {
+    if (output->format == RESULT_FORMAT_TEXT) {
+        if (status == Eval_OK) {
+            printf("%lg\n", value);
+        }
+        return;
+    }
+    store_little_endian(&output->values[output->used * sizeof(double)], (status == Eval_OK) ? value : NAN);
+    uint8_t bits = 0;
+    switch (status) {
+    case Eval_OK:
+        break;
+    case Eval_Error:
+        bits = RESULT_STATUS_ERROR;
+        break;
+    case Eval_Dont_Print:
+        bits = RESULT_STATUS_NO_VALUE;
+        break;
+    }
+    output->status[output->used / 4] |= (uint8_t)(bits << (2 * (output->used % 4)));
+    output->used++;
+    output->count++;
+    if (output->used == RESULT_BLOCK_LENGTH) {
+        flush_results(output);
+    }
+}
+
+bool close_result_output(struct Result_Output *const output) {
+    if (output->format != RESULT_FORMAT_TEXT) {
+        if ((output->file != NULL) && (output->status_file != NULL)) {
+            flush_results(output);
+            if ((output->format == RESULT_FORMAT_NPY) && ((fseek(output->file, 0, SEEK_SET) != 0) || write_npy_header(output))) {
+                report_write_error(output);
+            }
+        }
+        if ((output->file != NULL) && (fclose(output->file) != 0)) {
+            report_write_error(output);
+        }
+        if ((output->status_file != NULL) && (fclose(output->status_file) != 0)) {
+            report_write_error(output);
+        }
+        free_aligned(output->values);
+        free_aligned(output->status);
+    }
+    return output->has_error;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
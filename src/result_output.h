@@ -0,0 +1,109 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __RESULT_OUTPUT
+#define __RESULT_OUTPUT
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "parser.h"
+#include "printing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Destination of the results of the lines evaluated from a file.
+// In the text format, only the values are printed to the standard output.
+// The binary formats have one little-endian float64 per line, which is NaN
+// when the line produced no value, either raw, or as a one-dimensional NumPy
+// array (.npy). They are accompanied by a status bitmap, in the file with the
+// same name followed by ".status", with two bits per line, starting from the
+// least significant bit of each byte: the first bit is set if the line
+// produced Eval_Error, and the second one if it produced Eval_Dont_Print.
+// In NumPy: unpackbits(fromfile(name, uint8), bitorder='little').reshape(-1, 2)
+
+enum Result_Format {
+    RESULT_FORMAT_TEXT,
+    RESULT_FORMAT_RAW,
+    RESULT_FORMAT_NPY,
+};
+
+struct Result_Output {
+    enum Result_Format format;
+    // Copy of the diagnostics of the context, since the modes that write the
+    // results redirect the diagnostics of the context while evaluating
+    struct Diagnostics diagnostics;
+    FILE *file;
+    FILE *status_file;
+    // The results are written in large blocks, straight from these aligned buffers
+    uint8_t *values;
+    uint8_t *status;
+    size_t used;
+    uint64_t count;
+    bool has_error;
+};
+
+// The format is RESULT_FORMAT_TEXT if the file name is NULL, RESULT_FORMAT_NPY if it
+// ends with ".npy", and RESULT_FORMAT_RAW otherwise. Returns true if found an error
+bool open_result_output(struct Result_Output *const output, const char *const file_name, struct Diagnostics *const diagnostics)
+    __attribute__((nonnull(1, 3)));
+void write_result(struct Result_Output *const output, const enum Evaluation_Status status, const double value)
+    __attribute__((nonnull));
+// Returns true if found an error while writing any result
+bool close_result_output(struct Result_Output *const output)
+    __attribute__((nonnull));
+
+#endif  // __RESULT_OUTPUT
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,255 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#ifndef _WIN32
+// Required for sigaction and setitimer when compiling with -std=c11
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "sampling_profiler.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "functions.h"
+#include "printing.h"
+#include "timing.h"
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+_Thread_local struct Sampled_Position sampled_position = {
+    .line = 0,
+    .phase = TIMING_LEX,
+    .depth = 0,
+    .functions = {0},
+};
+
+#ifndef _WIN32
+
+// The signal handler can't allocate memory, so the samples are counted in a
+// fixed hash table, whose keys pack the position: the line, the functions
+// (8 bits each, enough for the table of functions) and the phase. The zero
+// key marks the empty entries, so the lowest bit of the keys is always set
+#define PROFILE_TABLE_SIZE (1 << 16)
+#define PROFILE_MAX_PROBES 64
+#define PROFILE_LINE_SHIFT 28
+#define PROFILE_FUNCTIONS_SHIFT 4
+#define PROFILE_FUNCTION_BITS 8
+#define PROFILE_PHASE_SHIFT 1
+#define PROFILE_PHASE_MASK 0x7
+
+struct Profile_Entry {
+    uint64_t key;
+    uint64_t count;
+};
+
+static _Atomic uint64_t sample_keys[PROFILE_TABLE_SIZE];
+static _Atomic uint64_t sample_counts[PROFILE_TABLE_SIZE];
+// Samples that didn't fit in the table
+static _Atomic uint64_t lost_samples;
+static FILE *profile_file = NULL;
+static struct sigaction previous_action;
+
+static uint64_t position_key(void) {
+    uint64_t functions_bits = 0;
+    const size_t depth = sampled_position.depth;
+    for (size_t i = 0; (i < depth) && (i < PROFILE_MAX_FRAMES); i++) {
+        functions_bits |= (uint64_t)sampled_position.functions[i] << (i * PROFILE_FUNCTION_BITS);
+    }
+    // Outside the lines, the phase is the one of the previous line, so it isn't part of the key
+    const uint64_t phase = (sampled_position.line == 0) ? 0 : ((uint64_t)sampled_position.phase & PROFILE_PHASE_MASK);
+    return ((uint64_t)sampled_position.line << PROFILE_LINE_SHIFT) | (functions_bits << PROFILE_FUNCTIONS_SHIFT) |
+           (phase << PROFILE_PHASE_SHIFT) | 1;
+}
+
+static void count_sample(const int signal) {
+    (void)signal;
+    const int saved_errno = errno;
+    const uint64_t key = position_key();
+    // Fibonacci hashing spreads the consecutive lines over the table
+    size_t index = (size_t)((key * UINT64_C(11400714819323198485)) >> 48) & (PROFILE_TABLE_SIZE - 1);
+    for (size_t probe = 0; probe < PROFILE_MAX_PROBES; probe++, index = (index + 1) & (PROFILE_TABLE_SIZE - 1)) {
+        uint64_t found = atomic_load_explicit(&sample_keys[index], memory_order_relaxed);
+        if ((found == 0) && atomic_compare_exchange_strong_explicit(&sample_keys[index], &found, key, memory_order_relaxed, memory_order_relaxed)) {
+            found = key;
+        }
+        if (found == key) {
+            atomic_fetch_add_explicit(&sample_counts[index], 1, memory_order_relaxed);
+            errno = saved_errno;
+            return;
+        }
+    }
+    atomic_fetch_add_explicit(&lost_samples, 1, memory_order_relaxed);
+    errno = saved_errno;
+}
+
+bool start_sampling_profiler(struct Diagnostics *const diagnostics, const char *const file_name) {
+    profile_file = fopen(file_name, "wb");
+    if (profile_file == NULL) {
+        print_error(diagnostics, "Couldn't open the profile file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = count_sample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    const struct itimerval timer = {
+        .it_interval = {.tv_sec = 0, .tv_usec = PROFILE_INTERVAL_US},
+        .it_value = {.tv_sec = 0, .tv_usec = PROFILE_INTERVAL_US},
+    };
+    if ((sigaction(SIGPROF, &action, &previous_action) != 0) || (setitimer(ITIMER_PROF, &timer, NULL) != 0)) {
+        print_error(diagnostics, "Couldn't start the profiler, because of the following error: %s\n", strerror(errno));
+        fclose(profile_file);
+        profile_file = NULL;
+        return true;
+    }
+    return false;
+}
+
+bool sampling_profiler_running(void) {
+    return profile_file != NULL;
+}
+
+static int compare_entries(const void *const a, const void *const b) {
+    const uint64_t x = ((const struct Profile_Entry *)a)->key;
+    const uint64_t y = ((const struct Profile_Entry *)b)->key;
+    return (x > y) - (x < y);
+}
+
+static void write_entry(const struct Profile_Entry *const entry) {
+    const size_t line = (size_t)(entry->key >> PROFILE_LINE_SHIFT);
+    const size_t phase = (size_t)((entry->key >> PROFILE_PHASE_SHIFT) & PROFILE_PHASE_MASK);
+    if (line == 0) {
+        fprintf(profile_file, "(outside lines)");
+    } else {
+        fprintf(profile_file, "line %zu;%s", line, (phase < TIMING_PHASES) ? timing_phase_names[phase] : "?");
+    }
+    for (size_t i = 0; i < PROFILE_MAX_FRAMES; i++) {
+        const size_t function = (size_t)(entry->key >> (PROFILE_FUNCTIONS_SHIFT + i * PROFILE_FUNCTION_BITS)) & 0xFF;
+        if ((function > 0) && (function <= functions_quantity)) {
+            fprintf(profile_file, ";%s", functions[function - 1].name);
+        }
+    }
+    fprintf(profile_file, " %" PRIu64 "\n", entry->count);
+}
+
+bool stop_sampling_profiler(struct Diagnostics *const diagnostics) {
+    if (profile_file == NULL) {
+        return false;
+    }
+    const struct itimerval stop = {0};
+    setitimer(ITIMER_PROF, &stop, NULL);
+    sigaction(SIGPROF, &previous_action, NULL);
+    struct Profile_Entry *const entries = malloc(PROFILE_TABLE_SIZE * sizeof(struct Profile_Entry));
+    if (entries == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the profile!\n");
+    }
+    size_t quantity = 0;
+    uint64_t samples = 0;
+    for (size_t i = 0; i < PROFILE_TABLE_SIZE; i++) {
+        const uint64_t key = atomic_load_explicit(&sample_keys[i], memory_order_relaxed);
+        const uint64_t count = atomic_load_explicit(&sample_counts[i], memory_order_relaxed);
+        if ((key != 0) && (count > 0)) {
+            entries[quantity++] = (struct Profile_Entry){.key = key, .count = count};
+            samples += count;
+        }
+    }
+    // Sorted by line, so that the report can be read as it is
+    qsort(entries, quantity, sizeof(struct Profile_Entry), compare_entries);
+    for (size_t i = 0; i < quantity; i++) {
+        write_entry(&entries[i]);
+    }
+    free(entries);
+    const uint64_t lost = atomic_load_explicit(&lost_samples, memory_order_relaxed);
+    if (lost > 0) {
+        fprintf(profile_file, "(lost samples) %" PRIu64 "\n", lost);
+    }
+    const bool error = ferror(profile_file) != 0;
+    if ((fclose(profile_file) != 0) || error) {
+        print_error(diagnostics, "Couldn't write the profile file, because of the following error: %s\n", strerror(errno));
+        profile_file = NULL;
+        return true;
+    }
+    profile_file = NULL;
+    fprintf(stderr, "[Profile] %" PRIu64 " samples of %d us of CPU time\n", samples + lost, PROFILE_INTERVAL_US);
+    return false;
+}
+
+#else // Windows
+
+bool start_sampling_profiler(struct Diagnostics *const diagnostics, const char *const file_name) {
+    (void)file_name;
+    print_error(diagnostics, "The profiler is only available on POSIX systems!\n");
+    return true;
+}
+
+bool stop_sampling_profiler(struct Diagnostics *const diagnostics) {
+    (void)diagnostics;
+    return false;
+}
+
+bool sampling_profiler_running(void) {
+    return false;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
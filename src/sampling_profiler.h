@@ -0,0 +1,121 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __SAMPLING_PROFILER
+#define __SAMPLING_PROFILER
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "timing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Statistical profiler used by --profile (POSIX only). A SIGPROF timer
+// interrupts the process every PROFILE_INTERVAL_US of CPU time, and the
+// signal handler counts the position of the interrupted thread: the line
+// being interpreted, its phase, and the built-in function being executed.
+// The counts are written in the folded stacks format ("line 42;evaluate;sin 17"),
+// which is read by flame graph tools such as flamegraph.pl or speedscope.
+// The interpreter only stores its position in thread local variables, so
+// it costs almost nothing, even when the profiler isn't running
+
+#define PROFILE_INTERVAL_US 1000
+// Built-in functions called by others (as by bench) are sampled up to this depth
+#define PROFILE_MAX_FRAMES 3
+
+// Position of a thread, read by the signal handler of the same thread
+struct Sampled_Position {
+    volatile size_t line;  // Zero when outside a line
+    volatile size_t phase;  // One of enum Timing_Phase
+    volatile size_t depth;  // Built-in functions being executed
+    // Indexes in the table of functions plus one, from the outermost call
+    volatile uint8_t functions[PROFILE_MAX_FRAMES];
+};
+
+extern _Thread_local struct Sampled_Position sampled_position;
+
+// Defined on printing.h
+struct Diagnostics;
+
+// Returns true if found an error
+bool start_sampling_profiler(struct Diagnostics *const diagnostics, const char *const file_name)
+    __attribute__((nonnull));
+// Stops the timer and writes the samples. Returns true if found an error
+bool stop_sampling_profiler(struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
+bool sampling_profiler_running(void);
+
+static inline void sample_line_phase(const size_t line, const enum Timing_Phase phase) {
+    sampled_position.line = line;
+    sampled_position.phase = phase;
+}
+
+static inline void sample_outside_lines(void) {
+    sampled_position.line = 0;
+}
+
+static inline void enter_sampled_function(const size_t function_index) {
+    if (sampled_position.depth < PROFILE_MAX_FRAMES) {
+        sampled_position.functions[sampled_position.depth] = (uint8_t)(function_index + 1);
+    }
+    sampled_position.depth++;
+}
+
+static inline void leave_sampled_function(void) {
+    sampled_position.depth--;
+}
+
+#endif  // __SAMPLING_PROFILER
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
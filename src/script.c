@@ -0,0 +1,681 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "script.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
+#include "data-structures/sized_string.h"
+#include "dependencies.h"
+#include "journal.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+#include "result_output.h"
+#include "sampling_profiler.h"
+#include "trace.h"
+#include "variables.h"
+
+#define SCRIPT_MAX_WORKERS 16
+// Smaller groups of lines are evaluated sequentially, since starting the threads would cost more
+#define SCRIPT_MIN_PARALLEL_LINES 256
+// Attempts made to find a task before an idle worker sleeps
+#define SCRIPT_SPIN_TRIES 64
+#define SCRIPT_NONE SIZE_MAX
+
+// Variable used by the script. While a group of lines is evaluated in parallel,
+// the values live here, and are only assigned to the context at the end
+struct Script_Slot {
+    double value;
+    bool is_defined;
+    bool was_written;
+    // Group of lines in which the slot was last used
+    size_t group;
+    // Last line that wrote the slot, and the lines that read it since then
+    size_t last_writer;
+    size_t *readers;
+};
+
+struct Script_Edge {
+    size_t from;
+    size_t to;
+};
+
+struct Script_Line {
+    size_t head_idx;
+    bool has_error;
+    // Calls a built-in function with side effects
+    bool is_barrier;
+    enum Evaluation_Status status;
+    double result;
+    // Dynamic array, only allocated if the line has diagnostics
+    struct Stored_Diagnostic *diagnostics;
+    size_t first_access;
+    size_t accesses_count;
+    // Lines that depend on this one, in the successors array of the group
+    size_t first_successor;
+    size_t successors_count;
+};
+
+struct Script;
+
+struct Script_Worker {
+    pthread_t thread;
+    struct Script *script;
+    // Context whose variables hold the values used by the line being evaluated
+    struct Context ctx;
+    size_t line;
+    // Queue of lines ready to run. The owner uses the back, and the thieves the front
+    pthread_mutex_t mutex;
+    size_t *tasks;
+    size_t front;
+};
+
+struct Script {
+    const char *file_name;
+    const char *data;
+    size_t size;
+    struct Context *ctx;
+    struct Result_Output *output;
+    // Used to report the diagnostics with the location in the file
+    struct Diagnostics diagnostics;
+    // Line that receives the diagnostics of the context
+    size_t line;
+    struct Script_Line *lines;
+    size_t lines_quantity;
+    // The trees of all the lines are stored in the same array
+    struct Token_Node *nodes;
+    struct Access *accesses;
+    struct Name_Table names;
+    // One slot per name
+    struct Script_Slot *slots;
+    // Dependency graph of the group of lines being evaluated
+    size_t group;
+    size_t *touched_slots;
+    struct Script_Edge *edges;
+    size_t *successors;
+    atomic_size_t *dependencies;
+    atomic_size_t remaining;
+    // Idle workers sleep on the condition until a task is ready or the group is finished
+    pthread_mutex_t idle_mutex;
+    pthread_cond_t task_ready;
+    atomic_uint sleepers;
+    size_t workers_quantity;
+    struct Script_Worker workers[SCRIPT_MAX_WORKERS];
+};
+
+static void check_allocation(const void *const pointer) {
+    if (pointer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the script!\n");
+    }
+}
+
+static void add_diagnostic(struct Script_Line *const line, const struct Diagnostic *const found) {
+    if (line->diagnostics == NULL) {
+        line->diagnostics = array_new(sizeof(struct Stored_Diagnostic), 4);
+        check_allocation(line->diagnostics);
+    }
+    struct Stored_Diagnostic diagnostic;
+    store_diagnostic(&diagnostic, found);
+    array_push(line->diagnostics, diagnostic);
+    check_allocation(line->diagnostics);
+}
+
+static void collect_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    struct Script *const script = user_data;
+    add_diagnostic(&script->lines[script->line], diagnostic);
+}
+
+static void collect_worker_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    struct Script_Worker *const worker = user_data;
+    add_diagnostic(&worker->script->lines[worker->line], diagnostic);
+}
+
+static void parse_lines(struct Script *const script) {
+    struct Context *const ctx = script->ctx;
+    struct Parser parser = ctx->parser;
+    parser.nodes = script->nodes;
+    size_t offset = 0;
+    for (size_t i = 0; i < script->lines_quantity; i++) {
+        struct Script_Line *const line = &script->lines[i];
+        *line = (struct Script_Line){
+            .head_idx = SCRIPT_NONE,
+            .has_error = true,
+            .status = Eval_Dont_Print,
+            .first_access = array_size(script->accesses),
+        };
+        script->line = i;
+        struct Parsed_Line parsed;
+        const enum Parse_Status status = parse_line(ctx, &parser, script->data, script->size, &offset, &parsed, NULL, NULL);
+        if (parsed.is_lexed) {
+            line->head_idx = parsed.head_idx;
+            line->has_error = (status == PARSE_ERROR);
+            script->nodes = parser.nodes;
+            line->is_barrier = collect_accesses(&script->names, i, script->nodes, line->head_idx, &script->accesses);
+            line->accesses_count = array_size(script->accesses) - line->first_access;
+        }
+        if (line->has_error) {
+            line->status = Eval_Error;
+        }
+    }
+}
+
+static void evaluate_line_in_order(struct Script *const script, const size_t line_idx) {
+    struct Script_Line *const line = &script->lines[line_idx];
+    if (line->has_error || array_index_is_invalid(script->nodes, line->head_idx)) {
+        return;
+    }
+    script->line = line_idx;
+    struct Parser parser = script->ctx->parser;
+    parser.nodes = script->nodes;
+    line->status = Eval_OK;
+    sample_line_phase(line_idx + 1, TIMING_EVALUATE);
+    const uint64_t start = monotonic_time_ns();
+    line->result = evaluate(&parser, line->head_idx, &line->status);
+    trace_event("evaluate", "line", start, monotonic_time_ns() - start, line_idx + 1);
+    sample_outside_lines();
+}
+
+// The scratch variables of a worker only contain the variables used by the line
+static void clear_worker_variables(struct Variables *const vars) {
+    for (size_t i = 0; i < array_size(vars->list); i++) {
+        // The names copied from the slots point to the script, which is its mapping
+        if (!variable_name_is_mapped(vars, vars->list[i].name)) {
+            tracked_free(MEMORY_VARIABLE_NAMES, vars->list[i].name.data, vars->list[i].name.length);
+        }
+    }
+    array_free_all(vars->list);
+}
+
+static void evaluate_line_in_worker(struct Script_Worker *const worker, const size_t line_idx) {
+    struct Script *const script = worker->script;
+    struct Script_Line *const line = &script->lines[line_idx];
+    if (line->has_error || array_index_is_invalid(script->nodes, line->head_idx)) {
+        return;
+    }
+    struct Variables *const vars = &worker->ctx.vars;
+    clear_worker_variables(vars);
+    for (size_t i = line->first_access; i < line->first_access + line->accesses_count; i++) {
+        const struct Script_Slot *const slot = &script->slots[script->accesses[i].name];
+        const struct String name = script->names.names[script->accesses[i].name];
+        size_t index;
+        if (slot->is_defined && (search_variable(vars, name, &index) != EXIT_SUCCESS)) {
+            const struct Variable variable = {
+                .name = name,
+                .value = slot->value,
+            };
+            array_insert_at(vars->list, index, variable);
+            check_allocation(vars->list);
+        }
+    }
+    worker->line = line_idx;
+    struct Parser parser = worker->ctx.parser;
+    parser.nodes = script->nodes;
+    line->status = Eval_OK;
+    sample_line_phase(line_idx + 1, TIMING_EVALUATE);
+    const uint64_t start = monotonic_time_ns();
+    line->result = evaluate(&parser, line->head_idx, &line->status);
+    trace_event("evaluate", "line", start, monotonic_time_ns() - start, line_idx + 1);
+    sample_outside_lines();
+    for (size_t i = line->first_access; i < line->first_access + line->accesses_count; i++) {
+        struct Script_Slot *const slot = &script->slots[script->accesses[i].name];
+        size_t index;
+        if (script->accesses[i].is_write && (search_variable(vars, script->names.names[script->accesses[i].name], &index) == EXIT_SUCCESS)) {
+            slot->value = vars->list[index].value;
+            slot->is_defined = true;
+            slot->was_written = true;
+        }
+    }
+}
+
+// Returns the number of tasks in the queue of the worker
+static size_t push_task(struct Script_Worker *const worker, const size_t line_idx) {
+    pthread_mutex_lock(&worker->mutex);
+    array_push(worker->tasks, line_idx);
+    check_allocation(worker->tasks);
+    const size_t queued = array_size(worker->tasks) - worker->front;
+    pthread_mutex_unlock(&worker->mutex);
+    return queued;
+}
+
+static bool pop_task(struct Script_Worker *const worker, size_t *const line_idx) {
+    bool found = false;
+    pthread_mutex_lock(&worker->mutex);
+    if (array_size(worker->tasks) > worker->front) {
+        *line_idx = worker->tasks[--array_size(worker->tasks)];
+        found = true;
+    }
+    if (array_size(worker->tasks) == worker->front) {
+        array_free_all(worker->tasks);
+        worker->front = 0;
+    }
+    pthread_mutex_unlock(&worker->mutex);
+    return found;
+}
+
+static bool steal_task(struct Script_Worker *const victim, size_t *const line_idx) {
+    bool found = false;
+    pthread_mutex_lock(&victim->mutex);
+    if (array_size(victim->tasks) > victim->front) {
+        *line_idx = victim->tasks[victim->front++];
+        found = true;
+    }
+    if (array_size(victim->tasks) == victim->front) {
+        array_free_all(victim->tasks);
+        victim->front = 0;
+    }
+    pthread_mutex_unlock(&victim->mutex);
+    return found;
+}
+
+static bool find_task(struct Script_Worker *const worker, size_t *const line_idx) {
+    if (pop_task(worker, line_idx)) {
+        return true;
+    }
+    struct Script *const script = worker->script;
+    const size_t worker_idx = (size_t)(worker - script->workers);
+    for (size_t i = 1; i < script->workers_quantity; i++) {
+        if (steal_task(&script->workers[(worker_idx + i) % script->workers_quantity], line_idx)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void wake_workers(struct Script *const script) {
+    // Orders the new task or the end of the group before the read of the
+    // sleepers, paired with the fence in wait_task, so a wake up is never lost
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&script->sleepers, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&script->idle_mutex);
+        pthread_cond_broadcast(&script->task_ready);
+        pthread_mutex_unlock(&script->idle_mutex);
+    }
+}
+
+// Tries to find a task a few times, and then sleeps until one is ready.
+// Returns false when the group is finished
+static bool wait_task(struct Script_Worker *const worker, size_t *const line_idx) {
+    struct Script *const script = worker->script;
+    for (size_t i = 0; i < SCRIPT_SPIN_TRIES; i++) {
+        if (find_task(worker, line_idx)) {
+            return true;
+        }
+        if (atomic_load(&script->remaining) == 0) {
+            return false;
+        }
+        yield_processor();
+    }
+    pthread_mutex_lock(&script->idle_mutex);
+    atomic_fetch_add_explicit(&script->sleepers, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    bool found = false;
+    while (!(found = find_task(worker, line_idx)) && (atomic_load(&script->remaining) > 0)) {
+        pthread_cond_wait(&script->task_ready, &script->idle_mutex);
+    }
+    atomic_fetch_sub_explicit(&script->sleepers, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&script->idle_mutex);
+    return found;
+}
+
+static void *run_worker(void *const arg) {
+    struct Script_Worker *const worker = arg;
+    name_trace_thread("script worker");
+    struct Script *const script = worker->script;
+    size_t line_idx;
+    while (wait_task(worker, &line_idx)) {
+        evaluate_line_in_worker(worker, line_idx);
+        const struct Script_Line *const line = &script->lines[line_idx];
+        size_t queued = 0;
+        for (size_t i = line->first_successor; i < line->first_successor + line->successors_count; i++) {
+            const size_t successor = script->successors[i];
+            if (atomic_fetch_sub_explicit(&script->dependencies[successor], 1, memory_order_acq_rel) == 1) {
+                queued = push_task(worker, successor);
+            }
+        }
+        const bool finished = (atomic_fetch_sub(&script->remaining, 1) == 1);
+        // The worker takes the next task itself, so the others are only woken if there are more to steal
+        if ((queued > 1) || finished) {
+            wake_workers(script);
+        }
+    }
+    return NULL;
+}
+
+static void add_edge(struct Script *const script, const size_t from, const size_t to) {
+    if ((from == SCRIPT_NONE) || (from == to)) {
+        return;
+    }
+    const struct Script_Edge edge = {
+        .from = from,
+        .to = to,
+    };
+    array_push(script->edges, edge);
+    check_allocation(script->edges);
+}
+
+// The slots are prepared when first used by a group, since the barriers may change any variable
+static struct Script_Slot *touch_slot(struct Script *const script, const size_t slot_idx) {
+    struct Script_Slot *const slot = &script->slots[slot_idx];
+    if (slot->group != script->group) {
+        size_t index;
+        slot->group = script->group;
+        slot->is_defined = (search_variable(&script->ctx->vars, script->names.names[slot_idx], &index) == EXIT_SUCCESS);
+        slot->value = slot->is_defined ? get_variable_value(&script->ctx->vars, index) : 0.0;
+        slot->was_written = false;
+        slot->last_writer = SCRIPT_NONE;
+        if (slot->readers == NULL) {
+            slot->readers = array_new(sizeof(size_t), 8);
+            check_allocation(slot->readers);
+        }
+        array_free_all(slot->readers);
+        array_push(script->touched_slots, slot_idx);
+        check_allocation(script->touched_slots);
+    }
+    return slot;
+}
+
+// A line depends on the last line that wrote the slots it reads, and on the
+// last line that wrote or any line that read the slots it writes since then
+static void build_dependencies(struct Script *const script, const size_t begin, const size_t end) {
+    array_free_all(script->edges);
+    array_free_all(script->touched_slots);
+    for (size_t line_idx = begin; line_idx < end; line_idx++) {
+        const struct Script_Line *const line = &script->lines[line_idx];
+        for (size_t i = line->first_access; i < line->first_access + line->accesses_count; i++) {
+            const struct Access access = script->accesses[i];
+            struct Script_Slot *const slot = touch_slot(script, access.name);
+            if (access.is_read) {
+                add_edge(script, slot->last_writer, line_idx);
+                array_push(slot->readers, line_idx);
+                check_allocation(slot->readers);
+            }
+            if (access.is_write) {
+                add_edge(script, slot->last_writer, line_idx);
+                for (size_t j = 0; j < array_size(slot->readers); j++) {
+                    add_edge(script, slot->readers[j], line_idx);
+                }
+                array_free_all(slot->readers);
+                slot->last_writer = line_idx;
+            }
+        }
+    }
+    // Groups the edges by their origin
+    for (size_t line_idx = begin; line_idx < end; line_idx++) {
+        script->lines[line_idx].successors_count = 0;
+        atomic_init(&script->dependencies[line_idx], 0);
+    }
+    for (size_t i = 0; i < array_size(script->edges); i++) {
+        script->lines[script->edges[i].from].successors_count++;
+        atomic_fetch_add_explicit(&script->dependencies[script->edges[i].to], 1, memory_order_relaxed);
+    }
+    size_t first_successor = 0;
+    for (size_t line_idx = begin; line_idx < end; line_idx++) {
+        script->lines[line_idx].first_successor = first_successor;
+        first_successor += script->lines[line_idx].successors_count;
+        script->lines[line_idx].successors_count = 0;
+    }
+    free(script->successors);
+    script->successors = malloc((array_size(script->edges) + 1) * sizeof(size_t));
+    check_allocation(script->successors);
+    for (size_t i = 0; i < array_size(script->edges); i++) {
+        struct Script_Line *const line = &script->lines[script->edges[i].from];
+        script->successors[line->first_successor + line->successors_count++] = script->edges[i].to;
+    }
+}
+
+static void evaluate_group_in_parallel(struct Script *const script, const size_t begin, const size_t end) {
+    script->group++;
+    build_dependencies(script, begin, end);
+    size_t next_worker = 0;
+    for (size_t line_idx = begin; line_idx < end; line_idx++) {
+        if (atomic_load_explicit(&script->dependencies[line_idx], memory_order_relaxed) == 0) {
+            push_task(&script->workers[next_worker], line_idx);
+            next_worker = (next_worker + 1) % script->workers_quantity;
+        }
+    }
+    atomic_store(&script->remaining, end - begin);
+    size_t started = 1;
+    for (; started < script->workers_quantity; started++) {
+        if (pthread_create(&script->workers[started].thread, NULL, run_worker, &script->workers[started]) != 0) {
+            break;
+        }
+    }
+    // The lines of the workers that couldn't start are stolen by the others
+    run_worker(&script->workers[0]);
+    for (size_t i = 1; i < started; i++) {
+        pthread_join(script->workers[i].thread, NULL);
+    }
+    // The variables are updated in the order the script first used them
+    for (size_t i = 0; i < array_size(script->touched_slots); i++) {
+        const struct Script_Slot *const slot = &script->slots[script->touched_slots[i]];
+        if (slot->was_written) {
+            assign_variable(&script->ctx->vars, script->names.names[script->touched_slots[i]], slot->value);
+        }
+    }
+}
+
+static void print_lines(struct Script *const script, const size_t begin, const size_t end) {
+    for (size_t line_idx = begin; line_idx < end; line_idx++) {
+        const struct Script_Line *const line = &script->lines[line_idx];
+        for (size_t i = 0; (line->diagnostics != NULL) && (i < array_size(line->diagnostics)); i++) {
+            struct Diagnostic diagnostic = stored_diagnostic(&line->diagnostics[i]);
+            diagnostic.source = script->file_name;
+            diagnostic.line = line_idx + 1;
+            emit_diagnostic(&script->diagnostics, &diagnostic);
+        }
+        write_result(script->output, line->status, line->result);
+    }
+    if (script->ctx->vars.journal != NULL) {
+        commit_journal(script->ctx->vars.journal);
+    }
+    flush_diagnostics(&script->diagnostics);
+}
+
+static void evaluate_lines(struct Script *const script) {
+    struct Context *const ctx = script->ctx;
+    size_t begin = 0;
+    while ((begin < script->lines_quantity) && ((ctx->actions & ACTION_EXIT) == 0)) {
+        size_t end = begin;
+        while ((end < script->lines_quantity) && !script->lines[end].is_barrier) {
+            end++;
+        }
+        if ((script->workers_quantity > 1) && ((end - begin) >= SCRIPT_MIN_PARALLEL_LINES)) {
+            evaluate_group_in_parallel(script, begin, end);
+        } else {
+            for (size_t line_idx = begin; line_idx < end; line_idx++) {
+                evaluate_line_in_order(script, line_idx);
+            }
+        }
+        print_lines(script, begin, end);
+        // The barrier that ends the group
+        if (end < script->lines_quantity) {
+            evaluate_line_in_order(script, end);
+            print_lines(script, end, end + 1);
+            end++;
+        }
+        begin = end;
+    }
+}
+
+static void create_workers(struct Script *const script) {
+    script->workers_quantity = number_of_processors();
+    if (script->workers_quantity > SCRIPT_MAX_WORKERS) {
+        script->workers_quantity = SCRIPT_MAX_WORKERS;
+    }
+    pthread_mutex_init(&script->idle_mutex, NULL);
+    pthread_cond_init(&script->task_ready, NULL);
+    atomic_init(&script->sleepers, 0);
+    for (size_t i = 0; i < script->workers_quantity; i++) {
+        struct Script_Worker *const worker = &script->workers[i];
+        worker->script = script;
+        create_context(&worker->ctx, script->ctx->diagnostics.file);
+        worker->ctx.diagnostics.callback = collect_worker_diagnostic;
+        worker->ctx.diagnostics.user_data = worker;
+        worker->ctx.input.is_interactive = false;
+        // Lets the names of the variables point to the script
+        worker->ctx.vars.mapping = script->data;
+        worker->ctx.vars.mapping_size = script->size;
+        pthread_mutex_init(&worker->mutex, NULL);
+        worker->tasks = array_new(sizeof(size_t), 64);
+        check_allocation(worker->tasks);
+        worker->front = 0;
+    }
+}
+
+static void destroy_workers(struct Script *const script) {
+    for (size_t i = 0; i < script->workers_quantity; i++) {
+        struct Script_Worker *const worker = &script->workers[i];
+        clear_worker_variables(&worker->ctx.vars);
+        // The script is unmapped by its owner
+        worker->ctx.vars.mapping = NULL;
+        destroy_context(&worker->ctx);
+        pthread_mutex_destroy(&worker->mutex);
+        array_del(worker->tasks);
+    }
+    pthread_cond_destroy(&script->task_ready);
+    pthread_mutex_destroy(&script->idle_mutex);
+}
+
+static void destroy_script(struct Script *const script) {
+    for (size_t i = 0; i < script->lines_quantity; i++) {
+        if (script->lines[i].diagnostics != NULL) {
+            array_del(script->lines[i].diagnostics);
+        }
+    }
+    for (size_t i = 0; i < array_size(script->names.names); i++) {
+        if (script->slots[i].readers != NULL) {
+            array_del(script->slots[i].readers);
+        }
+    }
+    free(script->lines);
+    free(script->dependencies);
+    free(script->successors);
+    destroy_name_table(&script->names);
+    array_del(script->nodes);
+    array_del(script->accesses);
+    free(script->slots);
+    array_del(script->touched_slots);
+    array_del(script->edges);
+}
+
+bool run_script(struct Context *const ctx, const char *const file_name, struct Result_Output *const output) {
+    size_t size = 0;
+    const char *const data = map_file(file_name, &size);
+    if (data == NULL) {
+        if (errno == EINVAL) {
+            // Empty file
+            return false;
+        }
+        print_error(&ctx->diagnostics, "Couldn't read the file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    struct Script *const script = malloc(sizeof(struct Script));
+    check_allocation(script);
+    *script = (struct Script){
+        .file_name = file_name,
+        .data = data,
+        .size = size,
+        .ctx = ctx,
+        .output = output,
+        .diagnostics = ctx->diagnostics,
+        .nodes = array_new(sizeof(struct Token_Node), 4096),
+        .accesses = array_new(sizeof(struct Access), 1024),
+        .names = create_name_table(false),
+        .touched_slots = array_new(sizeof(size_t), 256),
+        .edges = array_new(sizeof(struct Script_Edge), 1024),
+    };
+    // The last line may not end with a new line
+    script->lines_quantity = (data[size - 1] == '\n') ? 0 : 1;
+    for (const char *c = data; (c = memchr(c, '\n', size - (size_t)(c - data))) != NULL; c++) {
+        script->lines_quantity++;
+    }
+    script->lines = malloc(script->lines_quantity * sizeof(struct Script_Line));
+    script->dependencies = malloc(script->lines_quantity * sizeof(atomic_size_t));
+    check_allocation(script->lines);
+    check_allocation(script->dependencies);
+    check_allocation(script->nodes);
+    check_allocation(script->accesses);
+    check_allocation(script->touched_slots);
+    check_allocation(script->edges);
+    const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+    ctx->diagnostics.callback = collect_diagnostic;
+    ctx->diagnostics.user_data = script;
+    ctx->input.is_interactive = false;
+    parse_lines(script);
+    script->slots = malloc((array_size(script->names.names) + 1) * sizeof(struct Script_Slot));
+    check_allocation(script->slots);
+    for (size_t i = 0; i < array_size(script->names.names); i++) {
+        script->slots[i] = (struct Script_Slot){
+            .group = SCRIPT_NONE,
+        };
+    }
+    create_workers(script);
+    evaluate_lines(script);
+    destroy_workers(script);
+    ctx->diagnostics = previous_diagnostics;
+    destroy_script(script);
+    free(script);
+    unmap_file(data, size);
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
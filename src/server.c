@@ -0,0 +1,507 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#ifdef __linux__
+// Required for accept4 and signalfd when compiling with -std=c11
+#define _GNU_SOURCE
+#endif
+
+#include "server.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "journal.h"
+#include "platform.h"
+#include "printing.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_MAX_EVENTS 64
+// Requests can't be longer than the longest String
+#define CLIENT_BUFFER_SIZE (UINT16_MAX + 1)
+#define REPLY_MAX_SIZE 512
+// A client stops being read while it has more replies than this waiting to
+// be sent, so one that never reads its socket can't exhaust the memory
+#define CLIENT_OUTPUT_LIMIT (1024 * 1024)
+
+struct Client {
+    int fd;
+    size_t index;  // Position in the list of clients of the server
+    uint32_t events;  // Events watched by the event loop
+    bool finished;  // Has the client shut down its side of the connection?
+    size_t used;
+    char input[CLIENT_BUFFER_SIZE];
+    // Dynamic array with the replies not yet sent
+    char *output;
+    size_t sent;
+};
+
+struct Server {
+    struct Context *ctx;
+    int epoll_fd;
+    int listen_fd;
+    // Only the socket created by the server is removed at exit
+    bool is_bound;
+    int signal_fd;
+    // Dynamic array with the connected clients
+    struct Client **clients;
+    // First error reported while evaluating the current request
+    bool has_error;
+    char error[REPLY_MAX_SIZE];
+};
+
+static void capture_diagnostic(void *const user_data, const struct Diagnostic *const diagnostic) {
+    struct Server *const server = user_data;
+    if ((diagnostic->level == DIAGNOSTIC_ERROR) && !server->has_error) {
+        snprintf(server->error, sizeof(server->error), "%s", diagnostic->message);
+        server->has_error = true;
+    }
+}
+
+// This function returns true if found an error
+static bool watch_fd(struct Server *const server, const int op, const int fd, const uint32_t events, void *const ptr) {
+    struct epoll_event event = {
+        .events = events,
+        .data.ptr = ptr,
+    };
+    if (epoll_ctl(server->epoll_fd, op, fd, &event) != 0) {
+        print_error(&server->ctx->diagnostics, "Function \"epoll_ctl()\" failed with error: %s\n", strerror(errno));
+        return true;
+    }
+    return false;
+}
+
+static void close_client(struct Server *const server, struct Client *const client) {
+    // Closing the file descriptor also removes it from the epoll set
+    close(client->fd);
+    // The last client takes the place of the removed one
+    struct Client *const last = array_last(server->clients);
+    last->index = client->index;
+    server->clients[client->index] = last;
+    array_size(server->clients)--;
+    array_del(client->output);
+    free(client);
+}
+
+static void accept_clients(struct Server *const server) {
+    for (;;) {
+        const int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                print_error(&server->ctx->diagnostics, "Function \"accept4()\" failed with error: %s\n", strerror(errno));
+            }
+            return;
+        }
+        struct Client *const client = malloc(sizeof(struct Client));
+        if (client == NULL) {
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->index = array_size(server->clients);
+        client->events = EPOLLIN | EPOLLRDHUP;
+        client->finished = false;
+        client->used = 0;
+        client->output = array_new(sizeof(char), REPLY_MAX_SIZE);
+        client->sent = 0;
+        array_push(server->clients, client);
+        if ((server->clients == NULL) || (client->output == NULL)) {
+            print_crash_and_exit("Couldn't allocate memory for the clients of the server!\n");
+        }
+        if (watch_fd(server, EPOLL_CTL_ADD, fd, client->events, client)) {
+            close_client(server, client);
+        }
+    }
+}
+
+static void append_reply(struct Client *const client, const char *const reply, const size_t length) {
+    const size_t size = array_size(client->output);
+    size_t capacity = array_capacity(client->output);
+    if ((size + length) > capacity) {
+        while ((size + length) > capacity) {
+            capacity *= 2;
+        }
+        client->output = array_resize(client->output, capacity);
+        if (client->output == NULL) {
+            print_crash_and_exit("Couldn't allocate memory for the replies of the server!\n");
+        }
+    }
+    memcpy(&client->output[size], reply, length);
+    array_size(client->output) = size + length;
+}
+
+static inline bool is_throttled(const struct Client *const client) {
+    return (array_size(client->output) - client->sent) >= CLIENT_OUTPUT_LIMIT;
+}
+
+static void evaluate_request(struct Server *const server, struct Client *const client, const char *const data, size_t length) {
+    if ((length > 0) && (data[length - 1] == '\r')) {
+        length--;
+    }
+    server->has_error = false;
+    double result = 0.0;
+    const enum Evaluation_Status status = evaluate_line(server->ctx, create_sized_string((char *)data, (String_Length)length), &result);
+    if (server->ctx->vars.journal != NULL) {
+        commit_journal(server->ctx->vars.journal);
+    }
+    char reply[REPLY_MAX_SIZE + 16];
+    int reply_length = 0;
+    switch (status) {
+    case Eval_OK:
+        reply_length = snprintf(reply, sizeof(reply), "OK %.17g\n", result);
+        break;
+    case Eval_Dont_Print:
+        reply_length = snprintf(reply, sizeof(reply), "NONE\n");
+        break;
+    case Eval_Error:
+        reply_length = snprintf(reply, sizeof(reply), "ERROR %s\n", server->has_error ? server->error : "Invalid expression");
+        break;
+    }
+    if (reply_length > 0) {
+        append_reply(client, reply, ((size_t)reply_length < sizeof(reply)) ? (size_t)reply_length : (sizeof(reply) - 1));
+    }
+}
+
+// Sends as much of the pending replies as possible.
+// This function returns true if the connection must be closed
+static bool flush_client(struct Server *const server, struct Client *const client) {
+    const size_t pending = array_size(client->output) - client->sent;
+    if (pending > 0) {
+        const ssize_t written = send(client->fd, &client->output[client->sent], pending, MSG_NOSIGNAL);
+        if (written < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                return true;
+            }
+        } else {
+            client->sent += (size_t)written;
+        }
+    }
+    const bool has_pending = (client->sent < array_size(client->output));
+    if (!has_pending) {
+        array_free_all(client->output);
+        client->sent = 0;
+    }
+    if (client->finished && !has_pending && (client->used == 0)) {
+        // Every reply was sent
+        return true;
+    }
+    // Only wait for EPOLLOUT while the socket buffer is full, and for new
+    // requests until the client finishes or has too many replies to send
+    const bool wants_input = !client->finished && !is_throttled(client);
+    const uint32_t events = (wants_input ? (EPOLLIN | EPOLLRDHUP) : 0) | (has_pending ? EPOLLOUT : 0);
+    if (events != client->events) {
+        client->events = events;
+        if (watch_fd(server, EPOLL_CTL_MOD, client->fd, events, client)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Evaluates the complete lines in the input buffer, stopping early if the
+// output limit is reached. The remaining data is kept for later
+static void evaluate_requests(struct Server *const server, struct Client *const client) {
+    size_t begin = 0;
+    const char *new_line = memchr(client->input, '\n', client->used);
+    while ((new_line != NULL) && !is_throttled(client)) {
+        const size_t end = (size_t)(new_line - client->input);
+        evaluate_request(server, client, &client->input[begin], end - begin);
+        begin = end + 1;
+        if ((server->ctx->actions & ACTION_EXIT) != 0) {
+            break;
+        }
+        new_line = memchr(&client->input[begin], '\n', client->used - begin);
+    }
+    client->used -= begin;
+    memmove(client->input, &client->input[begin], client->used);
+}
+
+// Reads all the available requests and evaluates the complete lines.
+// This function returns true if the connection must be closed
+static bool read_client(struct Server *const server, struct Client *const client) {
+    for (;;) {
+        // Requests held back by the output limit are evaluated before reading new ones
+        evaluate_requests(server, client);
+        if ((server->ctx->actions & ACTION_EXIT) != 0) {
+            break;
+        }
+        if (is_throttled(client)) {
+            // The replies are sent before evaluating more requests,
+            // and the rest waits for EPOLLOUT if the socket is full
+            if (flush_client(server, client)) {
+                return true;
+            }
+            if (is_throttled(client)) {
+                return false;
+            }
+            continue;
+        }
+        if (client->used == CLIENT_BUFFER_SIZE) {
+            const char *const reply = "ERROR The request is too long\n";
+            append_reply(client, reply, strlen(reply));
+            // The rest of the connection is ignored, but the replies are still sent
+            client->finished = true;
+        }
+        if (client->finished) {
+            // An incomplete last line is ignored
+            client->used = 0;
+            break;
+        }
+        const ssize_t received = recv(client->fd, &client->input[client->used], CLIENT_BUFFER_SIZE - client->used, 0);
+        if (received == 0) {
+            // The client won't send more requests, but still waits for the replies,
+            // so the connection is only closed once they were all sent
+            client->finished = true;
+            continue;
+        }
+        if (received < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return true;
+        }
+        client->used += (size_t)received;
+    }
+    // All the replies generated by this read are sent at once
+    return flush_client(server, client);
+}
+
+// Milliseconds the event loop may sleep without delaying the pending journal
+// records past their deadline, or -1 if there is nothing to write
+static int event_loop_timeout(const struct Server *const server) {
+    const struct Journal *const journal = server->ctx->vars.journal;
+    if (journal == NULL) {
+        return -1;
+    }
+    const uint64_t deadline = journal_deadline(journal);
+    if (deadline == UINT64_MAX) {
+        return -1;
+    }
+    const uint64_t now = monotonic_time_ns();
+    if (deadline <= now) {
+        return 0;
+    }
+    // Rounded up, so the loop doesn't wake up just before the deadline
+    const uint64_t timeout = (deadline - now + 999999u) / 1000000u;
+    return (timeout < INT32_MAX) ? (int)timeout : INT32_MAX;
+}
+
+// This function returns true if found an error
+static bool open_server(struct Server *const server, const char *const socket_path) {
+    struct sockaddr_un address = {
+        .sun_family = AF_UNIX,
+    };
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        print_error(&server->ctx->diagnostics, "The socket path \"%s\" is too long!\n", socket_path);
+        return true;
+    }
+    strcpy(address.sun_path, socket_path);
+    // A socket left by a previous server that didn't finish properly is
+    // replaced, but any other kind of file is kept
+    struct stat status;
+    if (lstat(socket_path, &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            print_error(&server->ctx->diagnostics, "The file \"%s\" already exists and isn't a socket!\n", socket_path);
+            return true;
+        }
+        unlink(socket_path);
+    }
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        print_error(&server->ctx->diagnostics, "Function \"socket()\" failed with error: %s\n", strerror(errno));
+        return true;
+    }
+    server->is_bound = (bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) == 0);
+    if (!server->is_bound || (listen(server->listen_fd, SOMAXCONN) != 0)) {
+        print_error(&server->ctx->diagnostics, "Couldn't listen on the socket \"%s\", because of the following error: %s\n", socket_path, strerror(errno));
+        return true;
+    }
+    // The signals are handled by the event loop, so the socket can be removed on termination
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    if (sigprocmask(SIG_BLOCK, &signals, NULL) != 0) {
+        print_error(&server->ctx->diagnostics, "Function \"sigprocmask()\" failed with error: %s\n", strerror(errno));
+        return true;
+    }
+    server->signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if ((server->signal_fd < 0) || (server->epoll_fd < 0)) {
+        print_error(&server->ctx->diagnostics, "Couldn't create the event loop, because of the following error: %s\n", strerror(errno));
+        return true;
+    }
+    // The listening socket and the signals are identified by the address of the server
+    if (watch_fd(server, EPOLL_CTL_ADD, server->listen_fd, EPOLLIN, &server->listen_fd)
+        || watch_fd(server, EPOLL_CTL_ADD, server->signal_fd, EPOLLIN, &server->signal_fd)) {
+        return true;
+    }
+    return false;
+}
+
+bool serve_unix_socket(struct Context *const ctx, const char *const socket_path) {
+    struct Server server = {
+        .ctx = ctx,
+        .epoll_fd = -1,
+        .listen_fd = -1,
+        .signal_fd = -1,
+        .clients = array_new(sizeof(struct Client *), 16),
+    };
+    if (server.clients == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the clients of the server!\n");
+    }
+    // The diagnostics are sent to the clients instead of the terminal
+    const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+    ctx->input.is_interactive = false;
+    const bool error = open_server(&server, socket_path);
+    if (!error) {
+        printf("Listening on \"%s\"\n", socket_path);
+        fflush(stdout);
+        ctx->diagnostics.callback = capture_diagnostic;
+        ctx->diagnostics.user_data = &server;
+    }
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!error && ((ctx->actions & ACTION_EXIT) == 0)) {
+        const int count = epoll_wait(server.epoll_fd, events, SERVER_MAX_EVENTS, event_loop_timeout(&server));
+        // The records of the last requests are written once their deadline
+        // passes, even if no other request arrives
+        if (ctx->vars.journal != NULL) {
+            commit_journal(ctx->vars.journal);
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            void *const ptr = events[i].data.ptr;
+            if (ptr == NULL) {
+                continue;
+            } else if (ptr == &server.listen_fd) {
+                accept_clients(&server);
+            } else if (ptr == &server.signal_fd) {
+                ctx->actions |= ACTION_EXIT;
+            } else {
+                struct Client *const client = ptr;
+                bool must_close = ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0);
+                if (!must_close && (events[i].events & EPOLLOUT)) {
+                    must_close = flush_client(&server, client);
+                    // Requests held back by the output limit are evaluated once their replies were sent
+                    if (!must_close && (client->used > 0) && !is_throttled(client)) {
+                        must_close = read_client(&server, client);
+                    }
+                }
+                if (!must_close && (events[i].events & (EPOLLIN | EPOLLRDHUP))) {
+                    must_close = read_client(&server, client);
+                }
+                if (must_close) {
+                    close_client(&server, client);
+                    // Later events of this batch may refer to the closed client
+                    for (int j = i + 1; j < count; j++) {
+                        if (events[j].data.ptr == client) {
+                            events[j].data.ptr = NULL;
+                            events[j].events = 0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    ctx->diagnostics = previous_diagnostics;
+    while (array_size(server.clients) > 0) {
+        close_client(&server, array_last(server.clients));
+    }
+    array_del(server.clients);
+    if (server.listen_fd >= 0) {
+        close(server.listen_fd);
+    }
+    if (server.is_bound) {
+        unlink(socket_path);
+    }
+    if (server.signal_fd >= 0) {
+        close(server.signal_fd);
+    }
+    if (server.epoll_fd >= 0) {
+        close(server.epoll_fd);
+    }
+    return error;
+}
+
+#else // Not Linux
+
+bool serve_unix_socket(struct Context *const ctx, const char *const socket_path) {
+    (void)socket_path;
+    print_error(&ctx->diagnostics, "The server mode is only supported on Linux!\n");
+    return true;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,263 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "session.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "evaluation_profile.h"
+#include "input_stream.h"
+#include "journal.h"
+#include "lex.h"
+#include "metrics.h"
+#include "parser.h"
+#include "perf_counters.h"
+#include "platform.h"
+#include "printing.h"
+#include "recording.h"
+#include "sampling_profiler.h"
+#include "slow_log.h"
+#include "timing.h"
+#include "trace.h"
+#include "variables.h"
+
+// Boundaries between the phases of a line, measured by the metrics, --timing, --perf-counters, --trace and --slow-log
+struct Phase_Marks {
+    uint64_t ns[TIMING_PHASES + 1];
+    struct Perf_Sample counters[TIMING_PHASES + 1];
+};
+
+// Marks the beginning of the phase, which is the end of the previous one
+static void mark_phase(const struct Context *const ctx, struct Phase_Marks *const marks, const size_t phase) {
+    marks->ns[phase] = monotonic_time_ns();
+    if (ctx->perf_counters != NULL) {
+        read_perf_counters(ctx->perf_counters, &marks->counters[phase]);
+    }
+}
+
+// The phases that didn't run because of an error take no time
+static void skip_phases(struct Phase_Marks *const marks, const size_t phase) {
+    for (size_t i = phase + 1; i <= TIMING_PHASES; i++) {
+        marks->ns[i] = marks->ns[phase];
+        marks->counters[i] = marks->counters[phase];
+    }
+}
+
+// Only the phases that ran are added to the latency of the metrics
+static void record_line_metrics(struct Context *const ctx, const struct Phase_Marks *const marks, const enum Line_Outcome outcome) {
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        const bool skipped = ((outcome == LINE_LEX_ERROR) && (phase != TIMING_LEX)) ||
+                             (((outcome == LINE_EMPTY) || (outcome == LINE_PARSE_ERROR)) && (phase == TIMING_EVALUATE));
+        if (!skipped) {
+            record_phase_latency(ctx->metrics, phase, marks->ns[phase + 1] - marks->ns[phase]);
+        }
+    }
+    record_line_outcome(ctx->metrics, outcome);
+    write_metrics_periodically(&ctx->diagnostics, ctx->metrics, array_size(ctx->vars.list));
+}
+
+static void report_phases(const struct Context *const ctx, const struct Phase_Marks *const marks, const size_t line_number) {
+    for (size_t phase = 0; (phase < TIMING_PHASES) && tracing(); phase++) {
+        trace_event(timing_phase_names[phase], "line", marks->ns[phase], marks->ns[phase + 1] - marks->ns[phase], line_number);
+    }
+    if (ctx->timing != NULL) {
+        uint64_t ns[TIMING_PHASES];
+        for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+            ns[phase] = marks->ns[phase + 1] - marks->ns[phase];
+        }
+        add_line_timing(ctx->timing, ns);
+        print_line_timing(stdout, ns);
+    }
+    if (ctx->perf_counters != NULL) {
+        for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+            add_phase_counters(ctx->perf_counters, phase, &marks->counters[phase], &marks->counters[phase + 1]);
+        }
+        finish_line_counters(ctx->perf_counters);
+        print_line_counters(stdout, ctx->perf_counters);
+    }
+}
+
+// Phases of the line being interpreted, marked by mark_lexed
+struct Line_Phases {
+    const struct Context *ctx;
+    bool measured;
+    size_t line_number;
+    struct Phase_Marks marks;
+};
+
+static void mark_lexed(void *const user_data) {
+    struct Line_Phases *const phases = user_data;
+    if (phases->measured) {
+        mark_phase(phases->ctx, &phases->marks, TIMING_PARSE);
+    }
+    sample_line_phase(phases->line_number, TIMING_PARSE);
+}
+
+struct Session create_session(struct Context *const ctx, struct Recording *const recording) {
+    return (struct Session){
+        .ctx = ctx,
+        .recording = recording,
+        .line_number = 0,
+    };
+}
+
+void interpret_line(struct Session *const session, const struct String line) {
+    struct Context *const ctx = session->ctx;
+    struct Recording *const recording = session->recording;
+    const size_t line_number = ++session->line_number;
+    sample_line_phase(line_number, TIMING_LEX);
+    // Without the metrics, --timing, --perf-counters, --trace and --slow-log, the phases aren't measured
+    const bool measured = (ctx->metrics != NULL) || (ctx->timing != NULL) || (ctx->perf_counters != NULL) || tracing() || slow_logging();
+    enum Line_Outcome outcome = LINE_LEX_ERROR;
+    struct Line_Phases phases = {
+        .ctx = ctx,
+        .measured = measured,
+        .line_number = line_number,
+    };
+    struct Phase_Marks *const marks = &phases.marks;
+    if (measured) {
+        mark_phase(ctx, marks, TIMING_LEX);
+    }
+    const uint64_t start = monotonic_time_ns();
+    array_free_all(ctx->parser.nodes);
+    struct Parsed_Line parsed;
+    const enum Parse_Status parse_status = parse_string(ctx, &ctx->parser, line, &parsed, mark_lexed, &phases);
+    const size_t head_idx = parsed.head_idx;
+    if (!parsed.is_lexed) {
+        if (measured) {
+            mark_phase(ctx, marks, TIMING_PARSE);
+            skip_phases(marks, TIMING_PARSE);
+        }
+        if (recording != NULL) {
+            record_line(recording, line, start, monotonic_time_ns() - start);
+        }
+    } else {
+        if (measured) {
+            mark_phase(ctx, marks, TIMING_EVALUATE);
+        }
+        sample_line_phase(line_number, TIMING_EVALUATE);
+        if (ctx->parser.profile != NULL) {
+            clear_node_stats(ctx->parser.profile);
+        }
+        enum Evaluation_Status status = Eval_OK;
+        const double result = evaluate(&ctx->parser, head_idx, &status);
+        if (measured) {
+            mark_phase(ctx, marks, TIMING_PRINT);
+        }
+        if (parse_status == PARSE_OK) {
+            outcome = (status == Eval_Error) ? LINE_EVALUATION_ERROR : LINE_OK;
+        } else {
+            outcome = (parse_status == PARSE_EMPTY) ? LINE_EMPTY : LINE_PARSE_ERROR;
+        }
+        sample_line_phase(line_number, TIMING_PRINT);
+        if (recording != NULL) {
+            record_line(recording, line, start, monotonic_time_ns() - start);
+        }
+        flush_diagnostics(&ctx->diagnostics);
+        if (status == Eval_OK) {
+            printf("%lg\n", result);
+        }
+        printf("\n");
+        if (ctx->actions & ACTION_PRINT_TOKENS) {
+            print_tokens(&ctx->lexer);
+        }
+        if (ctx->actions & ACTION_PRINT_TREE) {
+            print_tree(&ctx->parser, head_idx);
+        }
+        if (ctx->actions & ACTION_PRINT_GRAPH) {
+            print_graph(&ctx->parser, head_idx);
+        }
+        if (ctx->parser.profile != NULL) {
+            print_explained_tree(ctx->parser.profile, &ctx->parser, head_idx);
+        }
+        if (ctx->actions & ACTION_PRINT_VARIABLES) {
+            print_variables(&ctx->vars);
+        }
+        if (measured) {
+            mark_phase(ctx, marks, TIMING_PHASES);
+        }
+    }
+    sample_outside_lines();
+    if (measured) {
+        report_phases(ctx, marks, line_number);
+    }
+    if (ctx->metrics != NULL) {
+        record_line_metrics(ctx, marks, outcome);
+    }
+    if (slow_logging()) {
+        uint64_t ns[TIMING_PHASES];
+        for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+            ns[phase] = marks->ns[phase + 1] - marks->ns[phase];
+        }
+        log_slow_line(&ctx->parser, head_idx, line, line_number, ns);
+    }
+}
+
+void interpret_session_line(struct Session *const session, const struct String line) {
+    struct Context *const ctx = session->ctx;
+    interpret_line(session, line);
+    if (ctx->vars.journal != NULL) {
+        commit_journal(ctx->vars.journal);
+        // The REPL waits for the next line, so the changes aren't held until it comes
+        flush_journal(ctx->vars.journal);
+    }
+    if (ctx->actions & ACTION_PRINT_LINES) {
+        print_previous_lines(&ctx->input);
+    }
+    flush_diagnostics(&ctx->diagnostics);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
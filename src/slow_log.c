@@ -0,0 +1,273 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "slow_log.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+#include "timing.h"
+#include "variables.h"
+
+// Lines logged while the writer is busy with the previous ones
+#define SLOW_LOG_QUEUE 16
+
+struct Slow_Entry {
+    time_t time;
+    size_t line;
+    uint64_t ns[TIMING_PHASES];
+    size_t nodes;
+    size_t lookup_depth;
+    // Lines left out since the previous entry, because of the rate limit or a full queue
+    uint64_t suppressed;
+    size_t length;
+    char text[SLOW_LOG_MAX_TEXT];
+};
+
+struct Slow_Log {
+    FILE *file;
+    const char *file_name;
+    uint64_t threshold_ns;
+    pthread_t writer;
+    bool has_writer;
+    pthread_mutex_t mutex;
+    pthread_cond_t queued;
+    bool closing;
+    // Circular queue, filled by log_slow_line and emptied by the writer
+    size_t head;
+    size_t size;
+    struct Slow_Entry entries[SLOW_LOG_QUEUE];
+    // Only used by the thread that evaluates the lines
+    uint64_t tokens;
+    uint64_t last_refill_ns;
+    uint64_t suppressed;
+    // Only used by the writer
+    bool write_error;
+};
+
+static struct Slow_Log slow_log = {0};
+
+static void write_entry(FILE *const file, const struct Slow_Entry *const entry) {
+    char time_text[32] = "";
+    const struct tm *const utc = gmtime(&entry->time);
+    if (utc != NULL) {
+        strftime(time_text, sizeof(time_text), "%Y-%m-%dT%H:%M:%SZ", utc);
+    }
+    if (entry->suppressed > 0) {
+        fprintf(file, "%s %" PRIu64 " slow lines left out by the rate limit or a full queue\n", time_text, entry->suppressed);
+    }
+    fprintf(file, "%s", time_text);
+    if (entry->line > 0) {
+        fprintf(file, " line %zu", entry->line);
+    }
+    fprintf(file, ": lex %" PRIu64 " ns, parse %" PRIu64 " ns, evaluate %" PRIu64 " ns, %zu nodes, lookup depth %zu: %.*s%s\n",
+            entry->ns[TIMING_LEX], entry->ns[TIMING_PARSE], entry->ns[TIMING_EVALUATE], entry->nodes, entry->lookup_depth,
+            (int)((entry->length < SLOW_LOG_MAX_TEXT) ? entry->length : SLOW_LOG_MAX_TEXT), entry->text, (entry->length > SLOW_LOG_MAX_TEXT) ? "..." : "");
+}
+
+static void *write_entries(void *const arg) {
+    (void)arg;
+    struct Slow_Entry entry;
+    pthread_mutex_lock(&slow_log.mutex);
+    for (;;) {
+        while ((slow_log.size == 0) && !slow_log.closing) {
+            pthread_cond_wait(&slow_log.queued, &slow_log.mutex);
+        }
+        if (slow_log.size == 0) {
+            break;
+        }
+        entry = slow_log.entries[slow_log.head];
+        slow_log.head = (slow_log.head + 1) % SLOW_LOG_QUEUE;
+        slow_log.size--;
+        // The file is written without holding the lock
+        pthread_mutex_unlock(&slow_log.mutex);
+        write_entry(slow_log.file, &entry);
+        if ((fflush(slow_log.file) != 0) || ferror(slow_log.file)) {
+            slow_log.write_error = true;
+        }
+        pthread_mutex_lock(&slow_log.mutex);
+    }
+    pthread_mutex_unlock(&slow_log.mutex);
+    return NULL;
+}
+
+bool open_slow_log(struct Diagnostics *const diagnostics, const char *const file_name, const uint64_t threshold_ns) {
+    // The log is appended to, so it keeps the slow lines of every session
+    FILE *const file = fopen(file_name, "ab");
+    if (file == NULL) {
+        print_error(diagnostics, "Couldn't open the file \"%s\" for the slow lines, because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    slow_log = (struct Slow_Log){
+        .file = file,
+        .file_name = file_name,
+        .threshold_ns = threshold_ns,
+        .tokens = SLOW_LOG_MAX_PER_SECOND,
+        .last_refill_ns = monotonic_time_ns(),
+    };
+    pthread_mutex_init(&slow_log.mutex, NULL);
+    pthread_cond_init(&slow_log.queued, NULL);
+    slow_log.has_writer = (pthread_create(&slow_log.writer, NULL, write_entries, NULL) == 0);
+    return false;
+}
+
+bool close_slow_log(struct Diagnostics *const diagnostics) {
+    if (slow_log.file == NULL) {
+        return false;
+    }
+    if (slow_log.has_writer) {
+        pthread_mutex_lock(&slow_log.mutex);
+        slow_log.closing = true;
+        pthread_cond_signal(&slow_log.queued);
+        pthread_mutex_unlock(&slow_log.mutex);
+        pthread_join(slow_log.writer, NULL);
+    }
+    if (slow_log.suppressed > 0) {
+        fprintf(slow_log.file, "%" PRIu64 " slow lines left out by the rate limit or a full queue at exit\n", slow_log.suppressed);
+    }
+    pthread_cond_destroy(&slow_log.queued);
+    pthread_mutex_destroy(&slow_log.mutex);
+    const bool error = slow_log.write_error || ferror(slow_log.file);
+    const bool close_error = (fclose(slow_log.file) != 0);
+    slow_log.file = NULL;
+    if (error || close_error) {
+        print_error(diagnostics, "Couldn't write the slow lines to the file \"%s\"!\n", slow_log.file_name);
+        return true;
+    }
+    return false;
+}
+
+bool slow_logging(void) {
+    return (slow_log.file != NULL);
+}
+
+// Token bucket, refilled with SLOW_LOG_MAX_PER_SECOND tokens each second
+static bool take_token(void) {
+    const uint64_t now = monotonic_time_ns();
+    const uint64_t refill = ((now - slow_log.last_refill_ns) * SLOW_LOG_MAX_PER_SECOND) / UINT64_C(1000000000);
+    if ((slow_log.tokens + refill) >= SLOW_LOG_MAX_PER_SECOND) {
+        // A full bucket doesn't keep the time that it was idle
+        slow_log.tokens = SLOW_LOG_MAX_PER_SECOND;
+        slow_log.last_refill_ns = now;
+    } else if (refill > 0) {
+        // Only the time of the added tokens is consumed, so the fraction of the next one isn't lost
+        slow_log.tokens += refill;
+        slow_log.last_refill_ns += (refill * UINT64_C(1000000000)) / SLOW_LOG_MAX_PER_SECOND;
+    }
+    if (slow_log.tokens == 0) {
+        return false;
+    }
+    slow_log.tokens--;
+    return true;
+}
+
+static void measure_tree(struct Parser *const parser, const size_t node_idx, struct Slow_Entry *const entry) {
+    if (array_index_is_invalid(parser->nodes, node_idx)) {
+        return;
+    }
+    entry->nodes++;
+    const struct Token_Node *const node = &parser->nodes[node_idx];
+    if (node->tok.type == TOK_NAME) {
+        const size_t depth = variable_search_depth(parser->vars, node->tok.name);
+        if (depth > entry->lookup_depth) {
+            entry->lookup_depth = depth;
+        }
+    }
+    measure_tree(parser, node->left_idx, entry);
+    measure_tree(parser, node->right_idx, entry);
+}
+
+void log_slow_line(struct Parser *const parser, const size_t head_idx, const struct String text, const size_t line, const uint64_t ns[TIMING_PHASES]) {
+    if ((ns[TIMING_LEX] + ns[TIMING_PARSE] + ns[TIMING_EVALUATE]) <= slow_log.threshold_ns) {
+        return;
+    }
+    if (!take_token()) {
+        slow_log.suppressed++;
+        return;
+    }
+    struct Slow_Entry entry = {
+        .time = time(NULL),
+        .line = line,
+        .ns = {ns[TIMING_LEX], ns[TIMING_PARSE], ns[TIMING_EVALUATE], 0},
+        .suppressed = slow_log.suppressed,
+        .length = text.length,
+    };
+    memcpy(entry.text, text.data, (text.length < SLOW_LOG_MAX_TEXT) ? text.length : SLOW_LOG_MAX_TEXT);
+    measure_tree(parser, head_idx, &entry);
+    if (!slow_log.has_writer) {
+        // Couldn't start the writer, so the line is written in the foreground
+        write_entry(slow_log.file, &entry);
+        slow_log.suppressed = 0;
+        return;
+    }
+    pthread_mutex_lock(&slow_log.mutex);
+    const bool queued = (slow_log.size < SLOW_LOG_QUEUE);
+    if (queued) {
+        slow_log.entries[(slow_log.head + slow_log.size) % SLOW_LOG_QUEUE] = entry;
+        slow_log.size++;
+        pthread_cond_signal(&slow_log.queued);
+    }
+    pthread_mutex_unlock(&slow_log.mutex);
+    slow_log.suppressed = queued ? 0 : (slow_log.suppressed + 1);
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
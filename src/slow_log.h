@@ -0,0 +1,95 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __SLOW_LOG
+#define __SLOW_LOG
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "data-structures/sized_string.h"
+#include "parser.h"
+#include "timing.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Log of the lines whose lexer, parser and evaluation together took longer
+// than a threshold, written by --slow-log. The lines are copied to a small
+// queue and written by a background thread, so the interpreter never waits
+// for the file. At most SLOW_LOG_MAX_PER_SECOND lines are logged per second,
+// and the ones left out are counted and reported in the next entry
+
+#define SLOW_LOG_DEFAULT_THRESHOLD_NS UINT64_C(10000000)
+#define SLOW_LOG_MAX_PER_SECOND 10
+// Longer lines are truncated in the log
+#define SLOW_LOG_MAX_TEXT 256
+
+// Defined on printing.h
+struct Diagnostics;
+
+// Returns true if found an error
+bool open_slow_log(struct Diagnostics *const diagnostics, const char *const file_name, const uint64_t threshold_ns)
+    __attribute__((nonnull));
+// Writes the lines still queued and closes the file. Returns true if found an error
+bool close_slow_log(struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
+bool slow_logging(void);
+// Logs the line if it's slower than the threshold, with the size of its tree
+// and the largest number of comparisons made to look up one of its names.
+// The line number is omitted if zero. Only called by the thread that evaluates the lines
+void log_slow_line(struct Parser *const parser, const size_t head_idx, const struct String text, const size_t line, const uint64_t ns[TIMING_PHASES])
+    __attribute__((nonnull));
+
+#endif  // __SLOW_LOG
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
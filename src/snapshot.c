@@ -0,0 +1,328 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "snapshot.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
+#include "data-structures/sized_string.h"
+#include "journal.h"
+#include "platform.h"
+#include "printing.h"
+#include "variables.h"
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+// Size of the buffer used by the stdio functions when writting a snapshot
+#define SNAPSHOT_WRITE_BUFFER (1 << 20)
+
+static const char snapshot_magic[8] = {'L', 'I', 'I', 'R', 'S', 'N', 'A', 'P'};
+
+struct Snapshot_Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t count;
+    uint64_t names_offset;  // Offset of the name blob from the beginning of the file
+    uint64_t names_size;
+    uint64_t values_offset; // Offset of the array of values, aligned to SNAPSHOT_ALIGNMENT
+    uint64_t file_size;
+    uint64_t reserved;
+};
+
+_Static_assert(sizeof(struct Snapshot_Header) == 64, "The snapshot header must have 64 bytes");
+
+static inline uint64_t align_up(const uint64_t value, const uint64_t alignment) {
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+static struct Snapshot_Header build_header(struct Variables *const vars) {
+    const uint64_t count = array_size(vars->list);
+    uint64_t names_size = 0;
+    for (size_t i = 0; i < array_size(vars->list); i++) {
+        names_size += vars->list[i].name.length;
+    }
+    const uint64_t names_offset = sizeof(struct Snapshot_Header) + (count + 1) * sizeof(uint64_t);
+    const uint64_t values_offset = align_up(names_offset + names_size, SNAPSHOT_ALIGNMENT);
+    struct Snapshot_Header header = (struct Snapshot_Header){
+        .version = SNAPSHOT_VERSION,
+        .byte_order = SNAPSHOT_BYTE_ORDER,
+        .count = count,
+        .names_offset = names_offset,
+        .names_size = names_size,
+        .values_offset = values_offset,
+        .file_size = values_offset + count * sizeof(double),
+    };
+    memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    return header;
+}
+
+bool write_snapshot(struct Variables *const vars, FILE *const file) {
+    const struct Snapshot_Header header = build_header(vars);
+    bool error = (fwrite(&header, sizeof(header), 1, file) != 1);
+    uint64_t offset = 0;
+    for (size_t i = 0; (i < array_size(vars->list)) && !error; i++) {
+        error = (fwrite(&offset, sizeof(offset), 1, file) != 1);
+        offset += vars->list[i].name.length;
+    }
+    error = error || (fwrite(&offset, sizeof(offset), 1, file) != 1);
+    for (size_t i = 0; (i < array_size(vars->list)) && !error; i++) {
+        const struct String name = vars->list[i].name;
+        error = (fwrite(name.data, sizeof(char), name.length, file) != name.length);
+    }
+    const char padding[SNAPSHOT_ALIGNMENT] = {0};
+    const size_t padding_size = (size_t)(header.values_offset - (header.names_offset + header.names_size));
+    error = error || (fwrite(padding, sizeof(char), padding_size, file) != padding_size);
+    for (size_t i = 0; (i < array_size(vars->list)) && !error; i++) {
+        error = (fwrite(&vars->list[i].value, sizeof(double), 1, file) != 1);
+    }
+    return error;
+}
+
+bool save_snapshot(struct Variables *const vars, const struct String file_name) {
+    // The snapshot is written to a temporary file and then renamed, so
+    // a mapping of the previous snapshot is never overwritten while in use
+    const char *const suffix = ".tmp";
+    const size_t suffix_length = strlen(suffix);
+    char file_name_str[file_name.length + 1];
+    char temp_name_str[file_name.length + suffix_length + 1];
+    strncpy(file_name_str, file_name.data, file_name.length);
+    file_name_str[file_name.length] = '\0';
+    memcpy(temp_name_str, file_name_str, file_name.length);
+    memcpy(&temp_name_str[file_name.length], suffix, suffix_length + 1);
+    FILE *const file = fopen(temp_name_str, "wb");
+    if (file == NULL) {
+        print_error(vars->diagnostics, "Couldn't save the snapshot to the file \"%s\", because of the following error: %s\n",
+            file_name_str, strerror(errno));
+        return true;
+    }
+    setvbuf(file, NULL, _IOFBF, SNAPSHOT_WRITE_BUFFER);
+    bool error = write_snapshot(vars, file);
+    // Make sure the content is on the disk before it replaces the previous snapshot
+    error = error || !sync_file(file);
+    error = (fclose(file) != 0) || error;
+    if (error) {
+        print_error(vars->diagnostics, "Couldn't write the snapshot to the file \"%s\"!\n", temp_name_str);
+        remove(temp_name_str);
+        return true;
+    }
+    if (!replace_file(temp_name_str, file_name_str)) {
+        remove(temp_name_str);
+        return true;
+    }
+    return false;
+}
+
+// Returns a description of the problem found, or NULL if the snapshot is valid
+static const char *validate_snapshot(const void *const mapping, const size_t size) {
+    if (size < sizeof(struct Snapshot_Header)) {
+        return "The file is too small to be a snapshot";
+    }
+    const struct Snapshot_Header *const header = mapping;
+    if (memcmp(header->magic, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        return "The file is not a snapshot";
+    }
+    if (header->version != SNAPSHOT_VERSION) {
+        return "Unsupported snapshot version";
+    }
+    if (header->byte_order != SNAPSHOT_BYTE_ORDER) {
+        return "The snapshot was saved by a machine with a different byte order";
+    }
+    if (header->file_size != size) {
+        return "The snapshot is truncated";
+    }
+    // This bound guarantees that none of the following computations overflow
+    if ((header->count > (size / sizeof(uint64_t))) || (header->names_size > size)) {
+        return "Invalid snapshot header";
+    }
+    if ((header->names_offset != (sizeof(struct Snapshot_Header) + (header->count + 1) * sizeof(uint64_t)))
+        || (header->values_offset != align_up(header->names_offset + header->names_size, SNAPSHOT_ALIGNMENT))
+        || (header->file_size != (header->values_offset + header->count * sizeof(double)))) {
+        return "Invalid snapshot header";
+    }
+    const uint64_t *const offsets = (const uint64_t *)((const char *)mapping + sizeof(struct Snapshot_Header));
+    const char *const names = (const char *)mapping + header->names_offset;
+    if ((offsets[0] != 0) || (offsets[header->count] != header->names_size)) {
+        return "Invalid name table";
+    }
+    struct String previous = {0};
+    for (uint64_t i = 0; i < header->count; i++) {
+        if ((offsets[i + 1] <= offsets[i]) || ((offsets[i + 1] - offsets[i]) > UINT16_MAX)) {
+            return "Invalid name table";
+        }
+        const struct String name = create_sized_string((char *)&names[offsets[i]], (String_Length)(offsets[i + 1] - offsets[i]));
+        if (parse_name(name).length != name.length) {
+            return "The snapshot contains an invalid name";
+        }
+        // The binary search used by search_variable requires sorted and unique names
+        if ((i > 0) && (string_compare(previous, name) >= 0)) {
+            return "The names in the snapshot are not sorted";
+        }
+        previous = name;
+    }
+    return NULL;
+}
+
+// Uses the mapped snapshot as the backing store of an empty list of variables
+static void adopt_snapshot(struct Variables *const vars, const void *const mapping, const size_t size) {
+    const struct Snapshot_Header *const header = mapping;
+    const size_t count = (size_t)header->count;
+    const uint64_t *const offsets = (const uint64_t *)((const char *)mapping + sizeof(struct Snapshot_Header));
+    const char *const names = (const char *)mapping + header->names_offset;
+    const double *const values = (const double *)((const char *)mapping + header->values_offset);
+    // Reserve one extra element, because array_push grows the array before it gets full
+    if (array_capacity(vars->list) <= count) {
+        vars->list = array_resize(vars->list, count + 1);
+        if (vars->list == NULL) {
+            print_crash_and_exit("Couldn't allocate memory for the variables!\n");
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        vars->list[i] = (struct Variable){
+            .name = create_sized_string((char *)&names[offsets[i]], (String_Length)(offsets[i + 1] - offsets[i])),
+            .value = values[i],
+        };
+    }
+    array_size(vars->list) = count;
+    vars->mapping = mapping;
+    vars->mapping_size = size;
+}
+
+// Merges the snapshot with the current variables, in a single pass over both sorted lists
+static void merge_snapshot(struct Variables *const vars, const void *const mapping) {
+    const struct Snapshot_Header *const header = mapping;
+    const size_t count = (size_t)header->count;
+    const uint64_t *const offsets = (const uint64_t *)((const char *)mapping + sizeof(struct Snapshot_Header));
+    const char *const names = (const char *)mapping + header->names_offset;
+    const double *const values = (const double *)((const char *)mapping + header->values_offset);
+    const size_t current_size = array_size(vars->list);
+    struct Variable *list = array_new(sizeof(struct Variable), current_size + count + 1);
+    if (list == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the variables!\n");
+    }
+    size_t i = 0, j = 0;
+    while ((i < current_size) || (j < count)) {
+        int comp = -1;
+        struct String name = {0};
+        if (j < count) {
+            name = create_sized_string((char *)&names[offsets[j]], (String_Length)(offsets[j + 1] - offsets[j]));
+            comp = (i < current_size) ? string_compare(vars->list[i].name, name) : 1;
+        }
+        if (comp < 0) {
+            list[array_size(list)++] = vars->list[i++];
+        } else if (comp == 0) {
+            list[array_size(list)++] = (struct Variable){ .name = vars->list[i++].name, .value = values[j++] };
+        } else {
+            // The snapshot will be unmapped, so the name must be copied
+            char *const data = tracked_malloc(MEMORY_VARIABLE_NAMES, name.length * sizeof(char));
+            if (data == NULL) {
+                print_crash_and_exit("Couldn't allocate memory for the new variable!\n");
+            }
+            memcpy(data, name.data, name.length);
+            list[array_size(list)++] = (struct Variable){ .name = create_sized_string(data, name.length), .value = values[j++] };
+        }
+    }
+    array_del(vars->list);
+    vars->list = list;
+}
+
+bool load_snapshot(struct Variables *const vars, const void *const data, const size_t size, const char *const source) {
+    const char *const problem = validate_snapshot(data, size);
+    if (problem != NULL) {
+        print_error(vars->diagnostics, "Couldn't load the snapshot from \"%s\": %s!\n", source, problem);
+        return true;
+    }
+    merge_snapshot(vars, data);
+    if (vars->journal != NULL) {
+        checkpoint_journal(vars->journal);
+    }
+    return false;
+}
+
+bool restore_snapshot(struct Variables *const vars, const struct String file_name) {
+    // Convert the file name to a C-string
+    char file_name_str[file_name.length + 1];
+    strncpy(file_name_str, file_name.data, file_name.length);
+    file_name_str[file_name.length] = '\0';
+    size_t size = 0;
+    const void *const mapping = map_file(file_name_str, &size);
+    if (mapping == NULL) {
+        print_error(vars->diagnostics, "Couldn't read the snapshot from the file \"%s\", because of the following error: %s\n",
+            file_name_str, strerror(errno));
+        return true;
+    }
+    const char *const problem = validate_snapshot(mapping, size);
+    if (problem != NULL) {
+        print_error(vars->diagnostics, "Couldn't restore the snapshot \"%s\": %s!\n", file_name_str, problem);
+        unmap_file(mapping, size);
+        return true;
+    }
+    const size_t count = (size_t)((const struct Snapshot_Header *)mapping)->count;
+    if ((array_size(vars->list) == 0) && (vars->mapping == NULL)) {
+        adopt_snapshot(vars, mapping, size);
+    } else {
+        merge_snapshot(vars, mapping);
+        unmap_file(mapping, size);
+    }
+    printf("Restored %zu variables from the snapshot \"%s\"\n", count, file_name_str);
+    if (vars->journal != NULL) {
+        // The variables changed without passing through assign_variable
+        checkpoint_journal(vars->journal);
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
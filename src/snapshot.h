@@ -0,0 +1,93 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __SNAPSHOT
+#define __SNAPSHOT
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "data-structures/sized_string.h"
+#include "variables.h"
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Binary snapshot of the variables. Unlike the text files handled by
+// load_variables_from_file, a snapshot needs no parsing at all: it is mapped
+// in memory, validated, and its names are used in place by struct Variables.
+// All integers are stored in the byte order of the machine that wrote it.
+// File layout:
+//   struct Snapshot_Header            (64 bytes)
+//   uint64_t name_offsets[count + 1]  (offset of each name inside the name blob)
+//   char names[names_size]            (sorted names, not null terminated)
+//   padding up to SNAPSHOT_ALIGNMENT
+//   double values[count]
+
+#define SNAPSHOT_ALIGNMENT 64
+
+// The functions bellow return true if found an error
+bool write_snapshot(struct Variables *const vars, FILE *const file)
+    __attribute__((nonnull));
+bool save_snapshot(struct Variables *const vars, const struct String file_name)
+    __attribute__((nonnull));
+// If the list of variables is empty, the snapshot is adopted as its backing store.
+// Otherwise, the snapshot is merged with the current variables (overriding their values)
+bool restore_snapshot(struct Variables *const vars, const struct String file_name)
+    __attribute__((nonnull));
+// Merges a snapshot that is already in memory (aligned to 8 bytes), such as one embedded
+// in another file, with the current variables. The source is only used in the messages
+bool load_snapshot(struct Variables *const vars, const void *const data, const size_t size, const char *const source)
+    __attribute__((nonnull));
+
+#endif  // __SNAPSHOT
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,401 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "stream.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
+#include "data-structures/sized_string.h"
+#include "journal.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "printing.h"
+#include "result_output.h"
+#include "variables.h"
+
+#define STREAM_BUFFER_SIZE (64 * 1024)
+// Longer tokens can't be valid numbers, so they don't need to be kept whole
+#define STREAM_MAX_NUMBER_LENGTH 256
+
+// Sequence numbers of samples in the window, ordered from the oldest to the
+// newest, whose values are also ordered, so that the front is the extreme.
+// It is a ring with the capacity of the window, since every sample in it is
+// in the window
+struct Stream_Deque {
+    uint64_t *sequences;
+    size_t front;
+    size_t size;
+};
+
+struct Stream_Window {
+    // Ring buffer with the last samples, indexed by the sequence number
+    double *samples;
+    size_t capacity;
+    // Number of samples received so far
+    uint64_t count;
+    double mean;
+    // Sum of the squared differences from the mean
+    double m2;
+    struct Stream_Deque min;
+    struct Stream_Deque max;
+};
+
+enum Stream_Variable {
+    STREAM_SAMPLE,
+    STREAM_WINDOW_COUNT,
+    STREAM_WINDOW_MEAN,
+    STREAM_WINDOW_MIN,
+    STREAM_WINDOW_MAX,
+    STREAM_WINDOW_VARIANCE,
+    STREAM_VARIABLES_QUANTITY,
+};
+
+static const char *const variable_names[STREAM_VARIABLES_QUANTITY] = {
+    [STREAM_SAMPLE] = "sample",
+    [STREAM_WINDOW_COUNT] = "window_count",
+    [STREAM_WINDOW_MEAN] = "window_mean",
+    [STREAM_WINDOW_MIN] = "window_min",
+    [STREAM_WINDOW_MAX] = "window_max",
+    [STREAM_WINDOW_VARIANCE] = "window_variance",
+};
+
+struct Stream {
+    struct Context *ctx;
+    struct Result_Output *output;
+    const char *name;
+    // Diagnostics of the context, which are redirected while evaluating
+    struct Diagnostics diagnostics;
+    size_t head_idx;
+    struct String variables[STREAM_VARIABLES_QUANTITY];
+    struct Stream_Window window;
+    // Text read, starting with the incomplete number left by the previous read
+    char *buffer;
+    size_t used;
+    // Set while discarding a token that is too long to be a number
+    bool skipping;
+};
+
+static struct Stream_Window create_window(const size_t capacity) {
+    struct Stream_Window window = {
+        .samples = malloc(capacity * sizeof(double)),
+        .capacity = capacity,
+        .min.sequences = malloc(capacity * sizeof(uint64_t)),
+        .max.sequences = malloc(capacity * sizeof(uint64_t)),
+    };
+    if ((window.samples == NULL) || (window.min.sequences == NULL) || (window.max.sequences == NULL)) {
+        print_crash_and_exit("Couldn't allocate memory for the stream window!\n");
+    }
+    return window;
+}
+
+static void destroy_window(struct Stream_Window *const window) {
+    free(window->samples);
+    free(window->min.sequences);
+    free(window->max.sequences);
+}
+
+static inline double sample_at(const struct Stream_Window *const window, const uint64_t sequence) {
+    return window->samples[sequence % window->capacity];
+}
+
+static inline void pop_expired(struct Stream_Window *const window, struct Stream_Deque *const deque, const uint64_t expired) {
+    if ((deque->size > 0) && (deque->sequences[deque->front] == expired)) {
+        deque->front = (deque->front + 1) % window->capacity;
+        deque->size--;
+    }
+}
+
+// The samples that can never be the extreme again, because the new one is
+// newer and at least as extreme, are removed from the back before pushing it
+static inline void push_sample(struct Stream_Window *const window, struct Stream_Deque *const deque, const double value, const bool is_max) {
+    while (deque->size > 0) {
+        const double back = sample_at(window, deque->sequences[(deque->front + deque->size - 1) % window->capacity]);
+        if (is_max ? (back > value) : (back < value)) {
+            break;
+        }
+        deque->size--;
+    }
+    deque->sequences[(deque->front + deque->size) % window->capacity] = window->count;
+    deque->size++;
+}
+
+static void recompute_moments(struct Stream_Window *const window) {
+    double sum = 0.0;
+    for (size_t i = 0; i < window->capacity; i++) {
+        sum += window->samples[i];
+    }
+    window->mean = sum / (double)window->capacity;
+    window->m2 = 0.0;
+    for (size_t i = 0; i < window->capacity; i++) {
+        const double delta = window->samples[i] - window->mean;
+        window->m2 += delta * delta;
+    }
+}
+
+static void add_sample(struct Stream_Window *const window, const double value) {
+    const size_t position = (size_t)(window->count % window->capacity);
+    if (window->count < window->capacity) {
+        // Welford's algorithm, while the window is filling up
+        const double delta = value - window->mean;
+        window->mean += delta / (double)(window->count + 1);
+        window->m2 += delta * (value - window->mean);
+    } else {
+        // The oldest sample leaves the window while the new one enters
+        const double old = window->samples[position];
+        const double previous_mean = window->mean;
+        window->mean += (value - old) / (double)window->capacity;
+        window->m2 += (value - old) * ((value - window->mean) + (old - previous_mean));
+        const uint64_t expired = window->count - window->capacity;
+        pop_expired(window, &window->min, expired);
+        pop_expired(window, &window->max, expired);
+    }
+    window->samples[position] = value;
+    if (position == (window->capacity - 1)) {
+        // The rounding errors of the updates would accumulate forever, so the
+        // mean and the variance are computed again once per turn of the ring,
+        // which is still constant time per sample on average
+        recompute_moments(window);
+    }
+    push_sample(window, &window->min, value, false);
+    push_sample(window, &window->max, value, true);
+    window->count++;
+}
+
+static void report_evaluation_diagnostic(void *const user_data, const struct Diagnostic *const found) {
+    struct Stream *const stream = user_data;
+    // The line is the number of the sample, and the column refers to the expression
+    struct Diagnostic diagnostic = *found;
+    diagnostic.source = stream->name;
+    diagnostic.line = (size_t)stream->window.count;
+    emit_diagnostic(&stream->diagnostics, &diagnostic);
+}
+
+static void evaluate_sample(struct Stream *const stream, const double value) {
+    struct Stream_Window *const window = &stream->window;
+    add_sample(window, value);
+    const uint64_t count = (window->count < window->capacity) ? window->count : window->capacity;
+    const double values[STREAM_VARIABLES_QUANTITY] = {
+        [STREAM_SAMPLE] = value,
+        [STREAM_WINDOW_COUNT] = (double)count,
+        [STREAM_WINDOW_MEAN] = window->mean,
+        [STREAM_WINDOW_MIN] = sample_at(window, window->min.sequences[window->min.front]),
+        [STREAM_WINDOW_MAX] = sample_at(window, window->max.sequences[window->max.front]),
+        // Rounding errors may leave the sum slightly negative
+        [STREAM_WINDOW_VARIANCE] = (window->m2 > 0.0) ? (window->m2 / (double)count) : 0.0,
+    };
+    struct Context *const ctx = stream->ctx;
+    for (size_t i = 0; i < STREAM_VARIABLES_QUANTITY; i++) {
+        assign_variable(&ctx->vars, stream->variables[i], values[i]);
+    }
+    enum Evaluation_Status status = Eval_OK;
+    const double result = evaluate(&ctx->parser, stream->head_idx, &status);
+    write_result(stream->output, status, result);
+}
+
+static inline bool is_separator(const char c) {
+    return isspace((unsigned char)c) || (c == ',');
+}
+
+// Returns true if found an error
+static bool parse_sample(char *const text, const size_t length, double *const value) {
+    size_t index = 0;
+    const bool negative = (text[0] == '-');
+    if (negative || (text[0] == '+')) {
+        index++;
+    }
+    String_Length number_length = 0;
+    *value = string_to_double(create_sized_string(&text[index], (String_Length)(length - index)), &number_length);
+    if (negative) {
+        *value = -*value;
+    }
+    return (number_length == 0) || ((index + number_length) != length);
+}
+
+static void evaluate_number(struct Stream *const stream, char *const text, const size_t length) {
+    double value;
+    if (parse_sample(text, length, &value)) {
+        print_warning(&stream->diagnostics, "%s: Ignoring \"%.*s\" after sample %" PRIu64 ", because it isn't a number\n",
+                      stream->name, (int)length, text, stream->window.count);
+        return;
+    }
+    evaluate_sample(stream, value);
+}
+
+static void skip_long_token(struct Stream *const stream) {
+    if (!stream->skipping) {
+        print_warning(&stream->diagnostics, "%s: Ignoring a token after sample %" PRIu64 ", because it is too long to be a number\n",
+                      stream->name, stream->window.count);
+        stream->skipping = true;
+    }
+}
+
+// Evaluates the numbers in the buffer. Unless it is the end of the input,
+// the last token may be incomplete, so it is kept for the next read
+static void evaluate_buffer(struct Stream *const stream, const bool end_of_input) {
+    struct Context *const ctx = stream->ctx;
+    size_t begin = 0;
+    while ((begin < stream->used) && ((ctx->actions & ACTION_EXIT) == 0)) {
+        size_t end = begin;
+        while ((end < stream->used) && !is_separator(stream->buffer[end])) {
+            end++;
+        }
+        if ((end == stream->used) && !end_of_input) {
+            break;
+        }
+        if (stream->skipping) {
+            stream->skipping = (end == stream->used);
+        } else if ((end - begin) > STREAM_MAX_NUMBER_LENGTH) {
+            skip_long_token(stream);
+            stream->skipping = (end == stream->used);
+        } else if (end > begin) {
+            evaluate_number(stream, &stream->buffer[begin], end - begin);
+        }
+        begin = end + 1;
+    }
+    if (begin >= stream->used) {
+        stream->used = 0;
+    } else if (stream->skipping || ((stream->used - begin) > STREAM_MAX_NUMBER_LENGTH)) {
+        skip_long_token(stream);
+        stream->used = 0;
+    } else {
+        memmove(stream->buffer, &stream->buffer[begin], stream->used - begin);
+        stream->used -= begin;
+    }
+    if (stream->output->format == RESULT_FORMAT_TEXT) {
+        fflush(stdout);
+    }
+    // The journal is committed and the diagnostics are written once per read instead of once per sample
+    if (ctx->vars.journal != NULL) {
+        commit_journal(ctx->vars.journal);
+    }
+    flush_diagnostics(&stream->diagnostics);
+}
+
+static void read_samples(struct Stream *const stream, FILE *const file) {
+    struct Context *const ctx = stream->ctx;
+    while ((ctx->actions & ACTION_EXIT) == 0) {
+        const size_t capacity = STREAM_BUFFER_SIZE - stream->used;
+        const size_t received = read_from_file(file, &stream->buffer[stream->used], capacity);
+        stream->used += received;
+        evaluate_buffer(stream, received == 0);
+        // A short read drained the input, so the next one may wait for more samples
+        if ((received < capacity) && (ctx->vars.journal != NULL)) {
+            flush_journal(ctx->vars.journal);
+        }
+        if (received == 0) {
+            break;
+        }
+    }
+}
+
+// Returns true if found an error
+static bool parse_expression(struct Context *const ctx, const struct String expression, size_t *const head_idx) {
+    array_free_all(ctx->parser.nodes);
+    struct Parsed_Line parsed;
+    const enum Parse_Status status = parse_string(ctx, &ctx->parser, expression, &parsed, NULL, NULL);
+    if (status == PARSE_EMPTY) {
+        print_error(&ctx->diagnostics, "The stream mode needs an expression to evaluate for each sample!\n");
+    }
+    *head_idx = parsed.head_idx;
+    return (status != PARSE_OK);
+}
+
+bool run_stream(struct Context *const ctx, const char *const file_name, const struct String expression, const size_t window_size, struct Result_Output *const output) {
+    if (window_size == 0) {
+        print_error(&ctx->diagnostics, "The window of the stream must have at least one sample!\n");
+        return true;
+    }
+    const bool is_stdin = (strcmp(file_name, "-") == 0);
+    FILE *const file = is_stdin ? stdin : fopen(file_name, "rb");
+    if (file == NULL) {
+        print_error(&ctx->diagnostics, "Couldn't open the file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    struct Stream stream = {
+        .ctx = ctx,
+        .output = output,
+        .name = is_stdin ? "stdin" : file_name,
+        .diagnostics = ctx->diagnostics,
+        .window = create_window(window_size),
+        .buffer = tracked_malloc(MEMORY_FILE_BUFFERS, STREAM_BUFFER_SIZE),
+    };
+    if (stream.buffer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the stream!\n");
+    }
+    for (size_t i = 0; i < STREAM_VARIABLES_QUANTITY; i++) {
+        stream.variables[i] = create_string((char *)variable_names[i]);
+    }
+    const bool error = parse_expression(ctx, expression, &stream.head_idx);
+    if (!error) {
+        ctx->diagnostics.callback = report_evaluation_diagnostic;
+        ctx->diagnostics.user_data = &stream;
+        read_samples(&stream, file);
+        ctx->diagnostics = stream.diagnostics;
+    }
+    tracked_free(MEMORY_FILE_BUFFERS, stream.buffer, STREAM_BUFFER_SIZE);
+    destroy_window(&stream.window);
+    if (!is_stdin) {
+        fclose(file);
+    }
+    return error;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,100 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "timing.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "data-structures/histogram.h"
+
+const char *const timing_phase_names[TIMING_PHASES] = {
+    [TIMING_LEX] = "lex",
+    [TIMING_PARSE] = "parse",
+    [TIMING_EVALUATE] = "evaluate",
+    [TIMING_PRINT] = "print",
+};
+
+void init_timing(struct Timing *const timing) {
+    timing->lines = 0;
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        init_histogram(&timing->phases[phase]);
+    }
+}
+
+void add_line_timing(struct Timing *const timing, const uint64_t ns[TIMING_PHASES]) {
+    timing->lines++;
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        histogram_record(&timing->phases[phase], ns[phase]);
+    }
+}
+
+void print_line_timing(FILE *const file, const uint64_t ns[TIMING_PHASES]) {
+    fprintf(file, "[Timing]");
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        fprintf(file, "%s %s %" PRIu64 " ns", (phase == 0) ? "" : ",", timing_phase_names[phase], ns[phase]);
+    }
+    fprintf(file, "\n");
+}
+
+void print_timing_summary(FILE *const file, const struct Timing *const timing) {
+    fprintf(file, "Timing of %" PRIu64 " lines, in nanoseconds:\n", timing->lines);
+    fprintf(file, "%-9s %14s %10s %10s %10s %10s %10s %10s\n", "phase", "total", "mean", "min", "p50", "p90", "p99", "max");
+    for (size_t phase = 0; phase < TIMING_PHASES; phase++) {
+        const struct Histogram *const histogram = &timing->phases[phase];
+        fprintf(file, "%-9s %14" PRIu64 " %10.0lf %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+                timing_phase_names[phase], histogram->sum, histogram_mean(histogram), (histogram->count == 0) ? 0 : histogram->min,
+                histogram_percentile(histogram, 50.0), histogram_percentile(histogram, 90.0),
+                histogram_percentile(histogram, 99.0), histogram->max);
+    }
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
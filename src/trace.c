@@ -0,0 +1,223 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#include "trace.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "printing.h"
+
+#define TRACE_BLOCK_EVENTS 4096
+
+struct Trace_Event {
+    const char *name;
+    const char *category;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    size_t line;
+};
+
+// The events are stored in blocks, so that the recorded ones never move
+struct Trace_Block {
+    struct Trace_Block *next;
+    size_t size;
+    struct Trace_Event events[TRACE_BLOCK_EVENTS];
+};
+
+// Buffer of a thread, which only that thread writes to
+struct Trace_Buffer {
+    struct Trace_Buffer *next;
+    uint32_t tid;
+    const char *thread_name;
+    struct Trace_Block *first;
+    struct Trace_Block *last;
+};
+
+static FILE *trace_file = NULL;
+static uint64_t trace_start_ns = 0;
+static uint64_t trace_threshold_ns = TRACE_DEFAULT_THRESHOLD_NS;
+// All the buffers, pushed by their threads when they record the first event
+static _Atomic(struct Trace_Buffer *) trace_buffers = NULL;
+static atomic_uint_fast32_t next_tid = 1;
+static _Thread_local struct Trace_Buffer *thread_buffer = NULL;
+
+bool open_trace(struct Diagnostics *const diagnostics, const char *const file_name, const uint64_t function_threshold_ns) {
+    trace_file = fopen(file_name, "wb");
+    if (trace_file == NULL) {
+        print_error(diagnostics, "Couldn't open the trace file \"%s\", because of the following error: %s\n", file_name, strerror(errno));
+        return true;
+    }
+    trace_start_ns = monotonic_time_ns();
+    trace_threshold_ns = function_threshold_ns;
+    name_trace_thread("main");
+    return false;
+}
+
+bool tracing(void) {
+    return trace_file != NULL;
+}
+
+static struct Trace_Block *new_trace_block(void) {
+    struct Trace_Block *const block = malloc(sizeof(struct Trace_Block));
+    if (block == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the trace!\n");
+    }
+    block->next = NULL;
+    block->size = 0;
+    return block;
+}
+
+static struct Trace_Buffer *get_thread_buffer(void) {
+    if (thread_buffer != NULL) {
+        return thread_buffer;
+    }
+    struct Trace_Buffer *const buffer = malloc(sizeof(struct Trace_Buffer));
+    if (buffer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the trace!\n");
+    }
+    buffer->tid = (uint32_t)atomic_fetch_add_explicit(&next_tid, 1, memory_order_relaxed);
+    buffer->thread_name = NULL;
+    buffer->first = new_trace_block();
+    buffer->last = buffer->first;
+    buffer->next = atomic_load_explicit(&trace_buffers, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&trace_buffers, &buffer->next, buffer, memory_order_release, memory_order_relaxed)) {
+    }
+    thread_buffer = buffer;
+    return buffer;
+}
+
+void name_trace_thread(const char *const name) {
+    if (tracing()) {
+        get_thread_buffer()->thread_name = name;
+    }
+}
+
+void trace_event(const char *const name, const char *const category, const uint64_t start_ns, const uint64_t duration_ns, const size_t line) {
+    if (!tracing()) {
+        return;
+    }
+    struct Trace_Buffer *const buffer = get_thread_buffer();
+    if (buffer->last->size == TRACE_BLOCK_EVENTS) {
+        buffer->last->next = new_trace_block();
+        buffer->last = buffer->last->next;
+    }
+    buffer->last->events[buffer->last->size++] = (struct Trace_Event){
+        .name = name,
+        .category = category,
+        .start_ns = start_ns,
+        .duration_ns = duration_ns,
+        .line = line,
+    };
+}
+
+void trace_function_call(const char *const name, const uint64_t start_ns, const uint64_t duration_ns) {
+    if (duration_ns >= trace_threshold_ns) {
+        trace_event(name, "function", start_ns, duration_ns, 0);
+    }
+}
+
+static void write_trace_event(const struct Trace_Event *const event, const uint32_t tid) {
+    // The timestamps are in microseconds
+    const uint64_t start_ns = (event->start_ns > trace_start_ns) ? (event->start_ns - trace_start_ns) : 0;
+    fprintf(trace_file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64 ".%03" PRIu64 ",\"pid\":1,\"tid\":%" PRIu32,
+            event->name, event->category, start_ns / 1000, start_ns % 1000, event->duration_ns / 1000, event->duration_ns % 1000, tid);
+    if (event->line > 0) {
+        fprintf(trace_file, ",\"args\":{\"line\":%zu}", event->line);
+    }
+    fprintf(trace_file, "}");
+}
+
+bool close_trace(struct Diagnostics *const diagnostics) {
+    if (!tracing()) {
+        return false;
+    }
+    fprintf(trace_file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(trace_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"" PROJECT "\"}}");
+    struct Trace_Buffer *buffer = atomic_load_explicit(&trace_buffers, memory_order_acquire);
+    while (buffer != NULL) {
+        if (buffer->thread_name != NULL) {
+            fprintf(trace_file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}}", buffer->tid, buffer->thread_name);
+        }
+        struct Trace_Block *block = buffer->first;
+        while (block != NULL) {
+            for (size_t i = 0; i < block->size; i++) {
+                write_trace_event(&block->events[i], buffer->tid);
+            }
+            struct Trace_Block *const next_block = block->next;
+            free(block);
+            block = next_block;
+        }
+        struct Trace_Buffer *const next_buffer = buffer->next;
+        free(buffer);
+        buffer = next_buffer;
+    }
+    fprintf(trace_file, "\n]}\n");
+    atomic_store_explicit(&trace_buffers, NULL, memory_order_relaxed);
+    thread_buffer = NULL;
+    const bool error = ferror(trace_file) != 0;
+    if (fclose(trace_file) != 0 || error) {
+        print_error(diagnostics, "Couldn't write the trace file, because of the following error: %s\n", strerror(errno));
+        trace_file = NULL;
+        return true;
+    }
+    trace_file = NULL;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -0,0 +1,94 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// HEADER
+//------------------------------------------------------------------------------
+
+#ifndef __TRACE
+#define __TRACE
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(__GNUC__) && !defined(__attribute__)
+#define __attribute__(a)
+#endif
+
+// Defined on printing.h
+struct Diagnostics;
+
+// Recording of the events written by --trace, in the trace event format of
+// Chrome, which can be opened in https://ui.perfetto.dev or chrome://tracing.
+// Each thread appends its events to its own buffer, without any locking, and
+// all the buffers are written to the file by close_trace, when the other
+// threads have already finished
+
+// Calls to built-in functions faster than this aren't recorded by default
+#define TRACE_DEFAULT_THRESHOLD_NS 1000
+
+// Returns true if found an error
+bool open_trace(struct Diagnostics *const diagnostics, const char *const file_name, const uint64_t function_threshold_ns)
+    __attribute__((nonnull));
+// Writes the events recorded and releases the buffers. Returns true if found an error
+bool close_trace(struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
+bool tracing(void);
+// Name shown for the calling thread
+void name_trace_thread(const char *const name)
+    __attribute__((nonnull));
+// Records an event that began at start_ns (given by monotonic_time_ns). The
+// name and the category must outlive the trace. The line is omitted if zero
+void trace_event(const char *const name, const char *const category, const uint64_t start_ns, const uint64_t duration_ns, const size_t line)
+    __attribute__((nonnull));
+// Same as trace_event, but only if the call lasted more than the threshold
+void trace_function_call(const char *const name, const uint64_t start_ns, const uint64_t duration_ns)
+    __attribute__((nonnull));
+
+#endif  // __TRACE
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
@@ -27,6 +27,8 @@
 #include "variables.h"
 
 #include <math.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,11 +36,17 @@
 #include <ctype.h>
 
 #include "data-structures/dynamic_array.h"
+#include "data-structures/memory_stats.h"
 #include "data-structures/sized_string.h"
+#include "journal.h"
+#include "platform.h"
 #include "printing.h"
+#include "trace.h"
 
-struct Variables create_variables(const size_t initial_list_size) {
-    struct Variables vars = (struct Variables){ 0 };
+struct Variables create_variables(const size_t initial_list_size, struct Diagnostics *const diagnostics) {
+    struct Variables vars = (struct Variables){
+        .diagnostics = diagnostics,
+    };
     vars.list = array_new(sizeof(struct Variable), initial_list_size);
     if (vars.list == NULL) {
         print_crash_and_exit("Couldn't allocate memory for the variables!\n");
@@ -47,16 +55,27 @@ struct Variables create_variables(const size_t initial_list_size) {
 }
 
 void destroy_variables(struct Variables *const vars) {
+    // Releasing the memory is not a change to be recorded
+    vars->journal = NULL;
     clear_variables(vars);
     array_del(vars->list);
 }
 
 void clear_variables(struct Variables *const vars) {
+    if (vars->journal != NULL) {
+        journal_clear(vars->journal);
+    }
     // Deallocate the memory used to store the variable name
     for (size_t i = 0; i < array_size(vars->list); i++) {
-        free((void *)(vars->list[i].name.data));
+        if (!variable_name_is_mapped(vars, vars->list[i].name)) {
+            tracked_free(MEMORY_VARIABLE_NAMES, (void *)(vars->list[i].name.data), vars->list[i].name.length);
+        }
     }
     array_free_all(vars->list);
+    // No variable references the snapshot anymore
+    unmap_file(vars->mapping, vars->mapping_size);
+    vars->mapping = NULL;
+    vars->mapping_size = 0;
 }
 
 // This function returns EXIT_SUCCESS if found the variable in the list
@@ -82,9 +101,29 @@ int search_variable(struct Variables *const vars, const struct String name, size
     return EXIT_FAILURE;
 }
 
+// Same binary search as search_variable, only counting its steps
+size_t variable_search_depth(const struct Variables *const vars, const struct String name) {
+    size_t depth = 0;
+    size_t low = 0;
+    size_t high = array_size(vars->list) - 1;
+    while ((low <= high) && array_index_is_valid(vars->list, high)) {
+        const size_t middle = (low + high) / 2;
+        const int comp = string_compare(name, vars->list[middle].name);
+        depth++;
+        if (comp < 0) {
+            high = middle - 1;
+        } else if (comp > 0) {
+            low = middle + 1;
+        } else {
+            break;
+        }
+    }
+    return depth;
+}
+
 void new_variable(struct Variables *const vars, const size_t index, const struct String name, const double value) {
     struct Variable new_var = (struct Variable){ 0 };
-    new_var.name.data = malloc(name.length*sizeof(char));
+    new_var.name.data = tracked_malloc(MEMORY_VARIABLE_NAMES, name.length*sizeof(char));
     if (new_var.name.data == NULL) {
         print_crash_and_exit("Couldn't allocate memory for the new variable!\n");
     }
@@ -100,13 +139,21 @@ int delete_variable(struct Variables *const vars, const struct String name) {
         // Didn't found the variable in the list
         return EXIT_FAILURE;
     }
+    if (vars->journal != NULL) {
+        journal_deletion(vars->journal, name);
+    }
     // Deallocate the memory used to store the variable name
-    free((void *)(vars->list[index].name.data));
+    if (!variable_name_is_mapped(vars, vars->list[index].name)) {
+        tracked_free(MEMORY_VARIABLE_NAMES, (void *)(vars->list[index].name.data), vars->list[index].name.length);
+    }
     array_remove_at(vars->list, index);
     return EXIT_SUCCESS;
 }
 
 double assign_variable(struct Variables *const vars, const struct String name, const double value) {
+    if (vars->journal != NULL) {
+        journal_assignment(vars->journal, name, value);
+    }
     size_t index;
     if (search_variable(vars, name, &index) != EXIT_SUCCESS) {
         // Insert new variable in alphabetical order
@@ -125,9 +172,6 @@ double get_variable_value(struct Variables *const vars, const size_t index) {
     return vars->list[index].value;
 }
 
-// Defined on main.c
-extern unsigned int max_uint(const unsigned int a, const unsigned int b);
-
 static inline unsigned int longest_variable_name(struct Variables *const vars) {
     unsigned int length = 0;
     for (size_t i = 0; i < array_size(vars->list); i++) {
@@ -158,6 +202,15 @@ bool variable_list_is_empty(struct Variables *const vars) {
     return (array_size(vars->list) == 0);
 }
 
+bool variable_name_is_mapped(struct Variables *const vars, const struct String name) {
+    if (vars->mapping == NULL) {
+        return false;
+    }
+    const uintptr_t begin = (uintptr_t)vars->mapping;
+    const uintptr_t address = (uintptr_t)name.data;
+    return ((address >= begin) && (address < (begin + vars->mapping_size)));
+}
+
 // This function was developed during some testing, but is currently unused
 // I leave it here because it may be useful in the future
 // Remember to free the memory allocated for the returned string
@@ -186,64 +239,341 @@ char *get_content_from_file(const char *const file_name) {
 	return buffer;
 }
 
-// Remove leading and trailing whitespace from a string
-void remove_whitespaces(char **str) {
-    while (isspace((unsigned char) **str)) {
-        (*str)++;
+// Files bigger than this are split in chunks parsed by several threads
+#define LOAD_CHUNK_MIN_SIZE (1024 * 1024)
+#define LOAD_MAX_THREADS 64
+// Only the first errors found in each chunk are reported
+#define LOAD_MAX_REPORTED_ERRORS 8
+
+struct Load_Error {
+    size_t line;  // Line number, relative to the beginning of the chunk
+    struct String text;
+    bool invalid_name;
+};
+
+struct Load_Chunk {
+    pthread_t thread;
+    const char *begin;
+    const char *end;
+    size_t lines;
+    // Dynamic array with the variables found in this chunk (names point to the file)
+    struct Variable *list;
+    size_t errors;
+    struct Load_Error reported[LOAD_MAX_REPORTED_ERRORS];
+};
+
+static inline struct String trim_string(struct String str) {
+    while ((str.length > 0) && isspace((unsigned char)str.data[0])) {
+        str.data++;
+        str.length--;
     }
-    char *end = *str + strlen(*str) - 1;
-    while (end > *str && isspace((unsigned char) *end)) {
-        end--;
+    while ((str.length > 0) && isspace((unsigned char)str.data[str.length - 1])) {
+        str.length--;
     }
-    end[1] = '\0';
+    return str;
 }
 
-void load_variables_from_file(struct Variables *const vars, const struct String file_name) {
+static void report_load_error(struct Load_Chunk *const chunk, const struct String text, const bool invalid_name) {
+    if (chunk->errors < LOAD_MAX_REPORTED_ERRORS) {
+        chunk->reported[chunk->errors] = (struct Load_Error){
+            .line = chunk->lines,
+            .text = text,
+            .invalid_name = invalid_name,
+        };
+    }
+    chunk->errors++;
+}
+
+// Parses a line with the structure "key = value". Lines without '=' are ignored
+static void parse_line(struct Load_Chunk *const chunk, const char *const begin, const char *const end) {
+    const char *separator = begin;
+    while ((separator < end) && (*separator != '=')) {
+        separator++;
+    }
+    if (separator == end) {
+        return;
+    }
+    // As in the previous versions of this file format, the value ends at the next '='
+    const char *value_end = separator + 1;
+    while ((value_end < end) && (*value_end != '=')) {
+        value_end++;
+    }
+    const struct String key = trim_string(create_sized_string((char *)begin, (String_Length)(separator - begin)));
+    if ((key.length == 0) || (parse_name(key).length != key.length)) {
+        report_load_error(chunk, key, true);
+        return;
+    }
+    const struct String value = trim_string(create_sized_string((char *)(separator + 1), (String_Length)(value_end - separator - 1)));
+    if (value.length == 0) {
+        return;
+    }
+    // save_variables_to_file writes negative values, so the sign must be accepted here
+    const bool negative = (value.data[0] == '-');
+    const String_Length sign_length = ((value.data[0] == '-') || (value.data[0] == '+')) ? 1 : 0;
+    const struct String digits = create_sized_string(value.data + sign_length, value.length - sign_length);
+    String_Length length = 0;
+    const double number = parse_number(digits, &length);
+    if ((digits.length == 0) || (length != digits.length)) {
+        report_load_error(chunk, value, false);
+        return;
+    }
+    const struct Variable var = (struct Variable){
+        .name = key,
+        .value = negative ? -number : number,
+    };
+    array_push(chunk->list, var);
+    if (chunk->list == NULL) {
+        print_crash_and_exit("Couldn't allocate memory to load the variables!\n");
+    }
+}
+
+// Merges two sorted lists of variables without repeated names.
+// If a name is present in both lists, the variable from the second list is kept
+static size_t merge_variables(const struct Variable *const first, const size_t first_size,
+                              const struct Variable *const second, const size_t second_size,
+                              struct Variable *const result) {
+    size_t i = 0, j = 0, k = 0;
+    while ((i < first_size) && (j < second_size)) {
+        const int comp = string_compare(first[i].name, second[j].name);
+        if (comp < 0) {
+            result[k++] = first[i++];
+        } else if (comp > 0) {
+            result[k++] = second[j++];
+        } else {
+            result[k++] = second[j++];
+            i++;
+        }
+    }
+    while (i < first_size) {
+        result[k++] = first[i++];
+    }
+    while (j < second_size) {
+        result[k++] = second[j++];
+    }
+    return k;
+}
+
+// Stable merge sort of the list, followed by the removal of repeated names,
+// keeping the last occurrence of each one (the last line of the file wins).
+// Returns the new size of the list
+static size_t sort_variables(struct Variable *const list, const size_t size) {
+    struct Variable *buffer = malloc(size * sizeof(struct Variable) + 1);
+    if (buffer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory to load the variables!\n");
+    }
+    struct Variable *source = list;
+    struct Variable *destination = buffer;
+    for (size_t width = 1; width < size; width *= 2) {
+        for (size_t begin = 0; begin < size; begin += 2 * width) {
+            const size_t middle = (begin + width < size) ? (begin + width) : size;
+            const size_t end = (begin + 2 * width < size) ? (begin + 2 * width) : size;
+            size_t i = begin, j = middle, k = begin;
+            while ((i < middle) && (j < end)) {
+                // Taking from the left on ties keeps the sort stable
+                if (string_compare(source[j].name, source[i].name) < 0) {
+                    destination[k++] = source[j++];
+                } else {
+                    destination[k++] = source[i++];
+                }
+            }
+            while (i < middle) {
+                destination[k++] = source[i++];
+            }
+            while (j < end) {
+                destination[k++] = source[j++];
+            }
+        }
+        struct Variable *const temp = source;
+        source = destination;
+        destination = temp;
+    }
+    size_t unique = 0;
+    for (size_t i = 0; i < size; i++) {
+        if ((i + 1 < size) && (string_compare(source[i].name, source[i + 1].name) == 0)) {
+            continue;
+        }
+        list[unique++] = source[i];
+    }
+    free(buffer);
+    return unique;
+}
+
+static void *load_chunk(void *const arg) {
+    struct Load_Chunk *const chunk = arg;
+    const char *line = chunk->begin;
+    while (line < chunk->end) {
+        const char *line_end = memchr(line, '\n', (size_t)(chunk->end - line));
+        if (line_end == NULL) {
+            line_end = chunk->end;
+        }
+        // A String can't represent longer lines, which are too big for a variable name anyway
+        if ((line_end - line) <= UINT16_MAX) {
+            parse_line(chunk, line, line_end);
+        } else {
+            report_load_error(chunk, create_sized_string((char *)line, 16), true);
+        }
+        chunk->lines++;
+        line = line_end + 1;
+    }
+    array_size(chunk->list) = sort_variables(chunk->list, array_size(chunk->list));
+    return NULL;
+}
+
+static size_t split_in_chunks(struct Load_Chunk *const chunks, const char *const data, const size_t size) {
+    size_t chunks_quantity = size / LOAD_CHUNK_MIN_SIZE;
+    const size_t processors = number_of_processors();
+    if (chunks_quantity > processors) {
+        chunks_quantity = processors;
+    }
+    if (chunks_quantity > LOAD_MAX_THREADS) {
+        chunks_quantity = LOAD_MAX_THREADS;
+    }
+    if (chunks_quantity == 0) {
+        chunks_quantity = 1;
+    }
+    const char *begin = data;
+    const char *const end = data + size;
+    size_t quantity = 0;
+    for (size_t i = 0; (i < chunks_quantity) && (begin < end); i++) {
+        // Each chunk ends right after a new line
+        const char *chunk_end = (i + 1 == chunks_quantity) ? end : (data + (size / chunks_quantity) * (i + 1));
+        if (chunk_end < begin) {
+            chunk_end = begin;
+        }
+        const char *const new_line = memchr(chunk_end, '\n', (size_t)(end - chunk_end));
+        chunk_end = (new_line == NULL) ? end : (new_line + 1);
+        chunks[quantity] = (struct Load_Chunk){
+            .begin = begin,
+            .end = chunk_end,
+            .list = array_new(sizeof(struct Variable), 64),
+        };
+        if (chunks[quantity].list == NULL) {
+            print_crash_and_exit("Couldn't allocate memory to load the variables!\n");
+        }
+        quantity++;
+        begin = chunk_end;
+    }
+    return quantity;
+}
+
+static void print_load_errors(struct Diagnostics *const diagnostics, const struct Load_Chunk *const chunks, const size_t quantity, const char *const file_name) {
+    size_t first_line = 1;
+    size_t errors = 0;
+    for (size_t i = 0; i < quantity; i++) {
+        const size_t reported = (chunks[i].errors < LOAD_MAX_REPORTED_ERRORS) ? chunks[i].errors : LOAD_MAX_REPORTED_ERRORS;
+        for (size_t j = 0; j < reported; j++) {
+            const struct Load_Error error = chunks[i].reported[j];
+            print_error(diagnostics, "%s:%zu: \"%.*s\" is not a valid %s!\n", file_name, first_line + error.line,
+                error.text.length, error.text.data, error.invalid_name ? "name" : "value");
+        }
+        errors += chunks[i].errors;
+        first_line += chunks[i].lines;
+    }
+    if (errors > 0) {
+        print_warning(diagnostics, "Ignored %zu invalid lines of the file \"%s\"\n", errors, file_name);
+    }
+}
+
+// The file is parsed by several threads, each one producing a sorted list
+// with the variables of its chunk. These lists are merged at once with the
+// current variables, so the cost is O(N log N) instead of the O(N^2) of
+// inserting the variables one by one in the sorted list
+static void read_variables_from_file(struct Variables *const vars, const struct String file_name) {
     // Convert the file name to a C-string
     char file_name_str[file_name.length + 1];
     strncpy(file_name_str, file_name.data, file_name.length);
     file_name_str[file_name.length] = '\0';
-    FILE *const file = fopen(file_name_str, "rb");
-	if (file == NULL) {
-        print_error("Couldn't read the variables from the file \"%.*s\", because of the following error: %s\n",
+    size_t size = 0;
+    const char *const data = map_file(file_name_str, &size);
+    if (data == NULL) {
+        if (errno == EINVAL) {
+            printf("Loaded 0 variables from the file \"%s\"\n", file_name_str);
+            return;
+        }
+        print_error(vars->diagnostics, "Couldn't read the variables from the file \"%.*s\", because of the following error: %s\n",
             file_name.length, file_name.data, strerror(errno));
         return;
     }
-    // Most systems do not allow for a line greather than 4 kbytes
-    char line[4096];
-    while (fgets(line, sizeof(line), file) != NULL) {
-        char *key = strtok(line, "=\n");
-        if (key == NULL) {
-            continue;
+    struct Load_Chunk chunks[LOAD_MAX_THREADS];
+    const size_t quantity = split_in_chunks(chunks, data, size);
+    size_t started = 1;
+    for (; started < quantity; started++) {
+        if (pthread_create(&chunks[started].thread, NULL, load_chunk, &chunks[started]) != 0) {
+            break;
         }
-        remove_whitespaces(&key);
-        const struct String string_key = create_string(key);
-        const struct String name = parse_name(string_key);
-        if (name.length != string_key.length) {
-            // The key is not a valid name
-            print_error("\"%.*s\" is not a valid name!\n", string_key.length, string_key.data);
-            continue;
+    }
+    // The remaining chunks are parsed by this thread
+    for (size_t i = started; i < quantity; i++) {
+        load_chunk(&chunks[i]);
+    }
+    load_chunk(&chunks[0]);
+    size_t loaded_size = 0;
+    for (size_t i = 0; i < quantity; i++) {
+        if ((i > 0) && (i < started)) {
+            pthread_join(chunks[i].thread, NULL);
         }
-        char *value = strtok(NULL, "=\n");
-        if (value == NULL) {
+        loaded_size += array_size(chunks[i].list);
+    }
+    print_load_errors(vars->diagnostics, chunks, quantity, file_name_str);
+    // Merges the chunks in the order they appear in the file, so the last occurrence of a name wins
+    struct Variable *loaded = array_new(sizeof(struct Variable), loaded_size + 1);
+    struct Variable *buffer = array_new(sizeof(struct Variable), loaded_size + 1);
+    if ((loaded == NULL) || (buffer == NULL)) {
+        print_crash_and_exit("Couldn't allocate memory to load the variables!\n");
+    }
+    for (size_t i = 0; i < quantity; i++) {
+        array_size(buffer) = merge_variables(loaded, array_size(loaded), chunks[i].list, array_size(chunks[i].list), buffer);
+        struct Variable *const temp = loaded;
+        loaded = buffer;
+        buffer = temp;
+        array_del(chunks[i].list);
+    }
+    array_del(buffer);
+    const size_t count = array_size(loaded);
+    // If possible, the file itself is used to store the names
+    const bool adopt_file = (array_size(vars->list) == 0) && (vars->mapping == NULL);
+    for (size_t i = 0; (i < count) && !adopt_file; i++) {
+        size_t index;
+        if (search_variable(vars, loaded[i].name, &index) == EXIT_SUCCESS) {
+            // Keep the name already allocated
+            loaded[i].name = vars->list[index].name;
             continue;
         }
-        remove_whitespaces(&value);
-        const struct String string_value = create_string(value);
-        String_Length length;
-        double number = parse_number(string_value, &length);
-        if (length != string_value.length) {
-            // The value is not a valid number
-            print_error("\"%.*s\" is not a valid value!\n", string_value.length, string_value.data);
-            continue;
+        char *const name = tracked_malloc(MEMORY_VARIABLE_NAMES, loaded[i].name.length * sizeof(char));
+        if (name == NULL) {
+            print_crash_and_exit("Couldn't allocate memory for the new variable!\n");
         }
-        assign_variable(vars, string_key, number);
-        printf("%s = %g\n", key, number);
+        memcpy(name, loaded[i].name.data, loaded[i].name.length);
+        loaded[i].name.data = name;
+    }
+    struct Variable *list = array_new(sizeof(struct Variable), array_size(vars->list) + count + 1);
+    if (list == NULL) {
+        print_crash_and_exit("Couldn't allocate memory for the variables!\n");
+    }
+    array_size(list) = merge_variables(vars->list, array_size(vars->list), loaded, count, list);
+    array_del(loaded);
+    array_del(vars->list);
+    vars->list = list;
+    if (adopt_file) {
+        vars->mapping = data;
+        vars->mapping_size = size;
+    } else {
+        unmap_file(data, size);
+    }
+    printf("Loaded %zu variables from the file \"%s\"\n", count, file_name_str);
+    if (vars->journal != NULL) {
+        // The variables changed without passing through assign_variable
+        checkpoint_journal(vars->journal);
     }
-    fclose(file);
 }
 
-void save_variables_to_file(struct Variables *const vars, const struct String file_name) {
+void load_variables_from_file(struct Variables *const vars, const struct String file_name) {
+    const uint64_t start = monotonic_time_ns();
+    read_variables_from_file(vars, file_name);
+    trace_event("load_variables_from_file", "io", start, monotonic_time_ns() - start, 0);
+}
+
+static void write_variables_to_file(struct Variables *const vars, const struct String file_name) {
     if (array_size(vars->list) == 0) {
         return;
     }
@@ -253,7 +583,7 @@ void save_variables_to_file(struct Variables *const vars, const struct String fi
     file_name_str[file_name.length] = '\0';
     FILE *const file = fopen(file_name_str, "wb");
 	if (file == NULL) {
-        print_error("Couldn't save the variables to the file \"%.*s\", because of the following error: %s\n",
+        print_error(vars->diagnostics, "Couldn't save the variables to the file \"%.*s\", because of the following error: %s\n",
             file_name.length, file_name.data, strerror(errno));
         return;
     }
@@ -263,6 +593,12 @@ void save_variables_to_file(struct Variables *const vars, const struct String fi
     fclose(file);
 }
 
+void save_variables_to_file(struct Variables *const vars, const struct String file_name) {
+    const uint64_t start = monotonic_time_ns();
+    write_variables_to_file(vars, file_name);
+    trace_event("save_variables_to_file", "io", start, monotonic_time_ns() - start, 0);
+}
+
 //------------------------------------------------------------------------------
 // END
 //------------------------------------------------------------------------------
@@ -27,7 +27,11 @@
 #ifndef __VARIABLES
 #define __VARIABLES
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "data-structures/sized_string.h"
+#include "printing.h"
 
 #if !defined(__GNUC__) && !defined(__attribute__)
 #define __attribute__(a)
@@ -38,18 +42,34 @@ struct Variable {
     double value;
 };
 
+// Defined on journal.h
+struct Journal;
+
 struct Variables {
     // Dynamic array used to store the list of variables
     struct Variable *list;
+    // Journal which records every change made to the variables, if any
+    struct Journal *journal;
+    // Snapshot file mapped in memory (see snapshot.h), if any. The names of the
+    // variables restored from it point directly to its name blob, so they are
+    // never freed individually. The mapping is released by clear_variables
+    const void *mapping;
+    size_t mapping_size;
+    // Destination of the errors found while loading, saving or journaling the variables
+    struct Diagnostics *diagnostics;
 };
 
-struct Variables create_variables(const size_t initial_list_size);
+struct Variables create_variables(const size_t initial_list_size, struct Diagnostics *const diagnostics)
+    __attribute__((nonnull));
 void destroy_variables(struct Variables *const vars)
     __attribute__((nonnull));
 void clear_variables(struct Variables *const vars)
     __attribute__((nonnull));
 int search_variable(struct Variables *const vars, const struct String name, size_t *const index)
     __attribute__((nonnull));
+// Number of names compared by search_variable while looking for the name
+size_t variable_search_depth(const struct Variables *const vars, const struct String name)
+    __attribute__((nonnull));
 void new_variable(struct Variables *const vars, const size_t index, const struct String name, const double value)
     __attribute__((nonnull));
 int delete_variable(struct Variables *const vars, const struct String name)
@@ -62,6 +82,8 @@ void print_variables(struct Variables *const vars)
     __attribute__((nonnull));
 bool variable_list_is_empty(struct Variables *const vars)
     __attribute__((nonnull));
+bool variable_name_is_mapped(struct Variables *const vars, const struct String name)
+    __attribute__((nonnull));
 
 // The functions bellow can load and save the variables to file.
 // The data is saved in the file using the structure "key = value" in each line.
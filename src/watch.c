@@ -0,0 +1,593 @@
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//------------------------------------------------------------------------------
+// SOURCE
+//------------------------------------------------------------------------------
+
+#ifdef __linux__
+// Required for signalfd when compiling with -std=c11
+#define _GNU_SOURCE
+#endif
+
+#include "watch.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "printing.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <stdalign.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include "data-structures/dynamic_array.h"
+#include "data-structures/sized_string.h"
+#include "dependencies.h"
+#include "journal.h"
+#include "lex.h"
+#include "parser.h"
+#include "platform.h"
+#include "variables.h"
+
+#define WATCH_EVENTS_SIZE 4096
+// Identifier of the writer of the variables defined before the file is evaluated
+#define WATCH_INITIAL_WRITER 0
+#define WATCH_NONE SIZE_MAX
+
+// What a line saw and did the last time it was evaluated, for each of its accesses
+struct Watch_Access_State {
+    size_t seen_writer;  // Identifier of the line that wrote the value read
+    bool is_assigned;
+    double value;        // Value assigned
+};
+
+struct Watch_Line {
+    // The tokens point to the text, which is owned by the line
+    char *text;
+    size_t length;
+    uint64_t hash;
+    // Identifiers are never reused, so a line that moved keeps its identifier
+    size_t id;
+    bool is_new;
+    bool is_matched;
+    bool has_error;
+    bool has_side_effects;
+    size_t head_idx;
+    // Dynamic arrays
+    struct Token_Node *nodes;
+    struct Access *accesses;
+    struct Stored_Diagnostic *diagnostics;
+    // One element per access
+    struct Watch_Access_State *states;
+};
+
+// Value of a variable at the line being evaluated
+struct Watch_Slot {
+    double value;
+    bool is_defined;
+    // The writer evaluated again, and assigned a different value
+    bool is_dirty;
+    size_t writer;
+    size_t update;
+};
+
+struct Watch {
+    const char *file_name;
+    struct Context *ctx;
+    // Context used to lex, parse and evaluate the lines in isolation
+    struct Context line_ctx;
+    // Used to report the diagnostics with the location in the file
+    struct Diagnostics diagnostics;
+    // Line being evaluated, and the line being parsed, whose diagnostics are kept
+    size_t line_number;
+    struct Watch_Line *parsing_line;
+    struct Watch_Line *lines;
+    struct Name_Table names;
+    struct Watch_Slot *slots;
+    size_t slots_capacity;
+    // Variables as they were before the file was evaluated
+    struct Variables initial;
+    size_t next_id;
+    size_t update;
+    // All the lines must be evaluated in the next update
+    bool is_stale;
+};
+
+static void check_allocation(const void *const pointer) {
+    if (pointer == NULL) {
+        print_crash_and_exit("Couldn't allocate memory to watch the file!\n");
+    }
+}
+
+static void report_diagnostic(struct Watch *const watch, const size_t line_number, const struct Diagnostic *const found) {
+    struct Diagnostic diagnostic = *found;
+    diagnostic.source = watch->file_name;
+    diagnostic.line = line_number;
+    emit_diagnostic(&watch->diagnostics, &diagnostic);
+}
+
+static void collect_diagnostic(void *const user_data, const struct Diagnostic *const found) {
+    struct Watch *const watch = user_data;
+    if (watch->parsing_line == NULL) {
+        report_diagnostic(watch, watch->line_number, found);
+        return;
+    }
+    // The diagnostics of the parser are reported when the line is evaluated
+    struct Stored_Diagnostic diagnostic;
+    store_diagnostic(&diagnostic, found);
+    array_push(watch->parsing_line->diagnostics, diagnostic);
+    check_allocation(watch->parsing_line->diagnostics);
+}
+
+static void destroy_line(struct Watch_Line *const line) {
+    free(line->text);
+    free(line->states);
+    array_del(line->nodes);
+    array_del(line->accesses);
+    array_del(line->diagnostics);
+}
+
+static struct Watch_Line create_line(struct Watch *const watch, const char *const text, const size_t length, const uint64_t hash) {
+    struct Watch_Line line = {
+        .text = malloc(length + 1),
+        .length = length,
+        .hash = hash,
+        .id = watch->next_id++,
+        .is_new = true,
+        .has_error = true,
+        .head_idx = WATCH_NONE,
+        .nodes = array_new(sizeof(struct Token_Node), 16),
+        .accesses = array_new(sizeof(struct Access), 4),
+        .diagnostics = array_new(sizeof(struct Stored_Diagnostic), 1),
+    };
+    check_allocation(line.text);
+    check_allocation(line.nodes);
+    check_allocation(line.accesses);
+    check_allocation(line.diagnostics);
+    memcpy(line.text, text, length);
+    struct Context *const ctx = &watch->line_ctx;
+    watch->parsing_line = &line;
+    struct Parser parser = ctx->parser;
+    parser.nodes = line.nodes;
+    size_t offset = 0;
+    struct Parsed_Line parsed;
+    const enum Parse_Status status = parse_line(ctx, &parser, line.text, length, &offset, &parsed, NULL, NULL);
+    line.nodes = parser.nodes;
+    if (parsed.is_lexed) {
+        line.head_idx = parsed.head_idx;
+        line.has_error = (status == PARSE_ERROR);
+        line.has_side_effects = collect_accesses(&watch->names, line.id, line.nodes, line.head_idx, &line.accesses);
+    }
+    watch->parsing_line = NULL;
+    line.states = calloc(array_size(line.accesses) + 1, sizeof(struct Watch_Access_State));
+    check_allocation(line.states);
+    if (array_size(watch->names.names) > watch->slots_capacity) {
+        const size_t old_capacity = watch->slots_capacity;
+        watch->slots_capacity = 2 * array_size(watch->names.names);
+        watch->slots = realloc(watch->slots, watch->slots_capacity * sizeof(struct Watch_Slot));
+        check_allocation(watch->slots);
+        // The updates are counted from one, so the new slots are prepared when touched
+        memset(&watch->slots[old_capacity], 0, (watch->slots_capacity - old_capacity) * sizeof(struct Watch_Slot));
+    }
+    return line;
+}
+
+// Matches the lines of the new content with the lines already parsed, by their content.
+// Returns the number of lines parsed
+static size_t update_lines(struct Watch *const watch, const char *const data, const size_t size) {
+    const size_t old_quantity = array_size(watch->lines);
+    size_t capacity = 64;
+    while (capacity < 2 * old_quantity) {
+        capacity *= 2;
+    }
+    size_t *const table = malloc(capacity * sizeof(size_t));
+    // Tested here instead of by check_allocation, which gcc assumes to read the uninitialized table
+    if (table == NULL) {
+        print_crash_and_exit("Couldn't allocate memory to watch the file!\n");
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        table[i] = WATCH_NONE;
+    }
+    for (size_t i = 0; i < old_quantity; i++) {
+        size_t position = (size_t)watch->lines[i].hash & (capacity - 1);
+        while (table[position] != WATCH_NONE) {
+            position = (position + 1) & (capacity - 1);
+        }
+        table[position] = i;
+    }
+    struct Watch_Line *lines = array_new(sizeof(struct Watch_Line), old_quantity + 1);
+    check_allocation(lines);
+    size_t parsed = 0;
+    size_t begin = 0;
+    while (begin < size) {
+        const char *const new_line = memchr(&data[begin], '\n', size - begin);
+        const size_t end = (new_line == NULL) ? size : (size_t)(new_line - data);
+        size_t length = end - begin;
+        if ((length > 0) && (data[begin + length - 1] == '\r')) {
+            length--;
+        }
+        // Lines too long for a String are matched by their beginning and their
+        // length, and reported as errors when parsed
+        const struct String text = create_sized_string((char *)&data[begin], (String_Length)((length > UINT16_MAX) ? UINT16_MAX : length));
+        const uint64_t hash = hash_string(text);
+        size_t match = WATCH_NONE;
+        for (size_t position = (size_t)hash & (capacity - 1); table[position] != WATCH_NONE; position = (position + 1) & (capacity - 1)) {
+            struct Watch_Line *const old = &watch->lines[table[position]];
+            if (!old->is_matched && (old->hash == hash) && (old->length == length) && (string_compare(text, create_sized_string(old->text, text.length)) == 0)) {
+                match = table[position];
+                break;
+            }
+        }
+        if (match != WATCH_NONE) {
+            watch->lines[match].is_matched = true;
+            array_push(lines, watch->lines[match]);
+        } else {
+            array_push(lines, create_line(watch, text.data, length, hash));
+            parsed++;
+        }
+        check_allocation(lines);
+        begin = end + 1;
+    }
+    for (size_t i = 0; i < old_quantity; i++) {
+        if (!watch->lines[i].is_matched) {
+            destroy_line(&watch->lines[i]);
+        }
+    }
+    for (size_t i = 0; i < array_size(lines); i++) {
+        lines[i].is_matched = false;
+    }
+    array_del(watch->lines);
+    watch->lines = lines;
+    free(table);
+    return parsed;
+}
+
+static struct Watch_Slot *touch_slot(struct Watch *const watch, const size_t name) {
+    struct Watch_Slot *const slot = &watch->slots[name];
+    if (slot->update != watch->update) {
+        size_t index;
+        slot->update = watch->update;
+        slot->is_defined = (search_variable(&watch->initial, watch->names.names[name], &index) == EXIT_SUCCESS);
+        slot->value = slot->is_defined ? get_variable_value(&watch->initial, index) : 0.0;
+        slot->is_dirty = false;
+        slot->writer = WATCH_INITIAL_WRITER;
+    }
+    return slot;
+}
+
+static void report_line(struct Watch *const watch, struct Watch_Line *const line, const enum Evaluation_Status status, const double result) {
+    for (size_t i = 0; i < array_size(line->diagnostics); i++) {
+        const struct Diagnostic diagnostic = stored_diagnostic(&line->diagnostics[i]);
+        report_diagnostic(watch, watch->line_number, &diagnostic);
+    }
+    array_free_all(line->diagnostics);
+    if (status == Eval_OK) {
+        printf("%s:%zu: %lg\n", watch->file_name, watch->line_number, result);
+    }
+}
+
+// Evaluates the line with only the variables it uses, in the context of the lines
+static void evaluate_line_alone(struct Watch *const watch, struct Watch_Line *const line) {
+    struct Variables *const vars = &watch->line_ctx.vars;
+    clear_variables(vars);
+    for (size_t i = 0; i < array_size(line->accesses); i++) {
+        const struct Watch_Slot *const slot = &watch->slots[line->accesses[i].name];
+        if (slot->is_defined) {
+            assign_variable(vars, watch->names.names[line->accesses[i].name], slot->value);
+        }
+    }
+    enum Evaluation_Status status = Eval_Dont_Print;
+    double result = NAN;
+    if (!line->has_error && array_index_is_valid(line->nodes, line->head_idx)) {
+        struct Parser parser = watch->line_ctx.parser;
+        parser.nodes = line->nodes;
+        status = Eval_OK;
+        result = evaluate(&parser, line->head_idx, &status);
+    }
+    report_line(watch, line, line->has_error ? Eval_Error : status, result);
+    for (size_t i = 0; i < array_size(line->accesses); i++) {
+        struct Watch_Access_State *const state = &line->states[i];
+        size_t index;
+        if (line->accesses[i].is_write) {
+            const bool is_assigned = (search_variable(vars, watch->names.names[line->accesses[i].name], &index) == EXIT_SUCCESS);
+            const double value = is_assigned ? vars->list[index].value : 0.0;
+            // The values are compared bitwise, so that NaN is equal to itself
+            const bool changed = (is_assigned != state->is_assigned) || (memcmp(&value, &state->value, sizeof(value)) != 0);
+            state->is_assigned = is_assigned;
+            state->value = value;
+            if (is_assigned) {
+                watch->slots[line->accesses[i].name].is_dirty = changed;
+            }
+        }
+    }
+}
+
+static size_t update_incrementally(struct Watch *const watch) {
+    size_t evaluated = 0;
+    for (size_t line_idx = 0; line_idx < array_size(watch->lines); line_idx++) {
+        struct Watch_Line *const line = &watch->lines[line_idx];
+        watch->line_number = line_idx + 1;
+        bool must_evaluate = line->is_new || watch->is_stale;
+        for (size_t i = 0; i < array_size(line->accesses); i++) {
+            struct Watch_Slot *const slot = touch_slot(watch, line->accesses[i].name);
+            if (line->accesses[i].is_read) {
+                must_evaluate |= (slot->writer != line->states[i].seen_writer) || slot->is_dirty;
+                line->states[i].seen_writer = slot->writer;
+            }
+        }
+        if (must_evaluate) {
+            evaluate_line_alone(watch, line);
+            evaluated++;
+        }
+        for (size_t i = 0; i < array_size(line->accesses); i++) {
+            struct Watch_Slot *const slot = &watch->slots[line->accesses[i].name];
+            if (line->accesses[i].is_write && line->states[i].is_assigned) {
+                if (!must_evaluate) {
+                    slot->is_dirty = false;
+                }
+                slot->value = line->states[i].value;
+                slot->is_defined = true;
+                slot->writer = line->id;
+            }
+        }
+        line->is_new = false;
+    }
+    // Brings the variables of the context to the state reached by the last line
+    struct Variables *const vars = &watch->ctx->vars;
+    for (size_t name = 0; name < array_size(watch->names.names); name++) {
+        const struct Watch_Slot *const slot = touch_slot(watch, name);
+        size_t index;
+        const bool exists = (search_variable(vars, watch->names.names[name], &index) == EXIT_SUCCESS);
+        if (slot->is_defined) {
+            if (!exists || (memcmp(&vars->list[index].value, &slot->value, sizeof(slot->value)) != 0)) {
+                assign_variable(vars, watch->names.names[name], slot->value);
+            }
+        } else if (exists) {
+            delete_variable(vars, watch->names.names[name]);
+        }
+    }
+    watch->is_stale = false;
+    return evaluated;
+}
+
+// Evaluates every line in the context, starting from the initial variables
+static size_t update_everything(struct Watch *const watch) {
+    struct Context *const ctx = watch->ctx;
+    clear_variables(&ctx->vars);
+    for (size_t i = 0; i < array_size(watch->initial.list); i++) {
+        assign_variable(&ctx->vars, watch->initial.list[i].name, watch->initial.list[i].value);
+    }
+    size_t line_idx = 0;
+    for (; (line_idx < array_size(watch->lines)) && ((ctx->actions & ACTION_EXIT) == 0); line_idx++) {
+        struct Watch_Line *const line = &watch->lines[line_idx];
+        watch->line_number = line_idx + 1;
+        enum Evaluation_Status status = line->has_error ? Eval_Error : Eval_Dont_Print;
+        double result = NAN;
+        if (!line->has_error && array_index_is_valid(line->nodes, line->head_idx)) {
+            struct Parser parser = ctx->parser;
+            parser.nodes = line->nodes;
+            status = Eval_OK;
+            result = evaluate(&parser, line->head_idx, &status);
+        }
+        report_line(watch, line, status, result);
+        line->is_new = false;
+    }
+    // The states of the lines are not updated
+    watch->is_stale = true;
+    return line_idx;
+}
+
+static void update(struct Watch *const watch) {
+    const uint64_t start = monotonic_time_ns();
+    size_t size = 0;
+    const char *const data = map_file(watch->file_name, &size);
+    if ((data == NULL) && (errno != EINVAL)) {
+        // The file may be replaced in a moment
+        print_error(&watch->diagnostics, "Couldn't read the file \"%s\", because of the following error: %s\n", watch->file_name, strerror(errno));
+        return;
+    }
+    const size_t parsed = update_lines(watch, data, size);
+    unmap_file(data, size);
+    watch->update++;
+    bool has_side_effects = false;
+    for (size_t i = 0; i < array_size(watch->lines); i++) {
+        has_side_effects |= watch->lines[i].has_side_effects;
+    }
+    const size_t evaluated = has_side_effects ? update_everything(watch) : update_incrementally(watch);
+    if (watch->ctx->vars.journal != NULL) {
+        commit_journal(watch->ctx->vars.journal);
+        // The next update waits for the file to change
+        flush_journal(watch->ctx->vars.journal);
+    }
+    flush_diagnostics(&watch->diagnostics);
+    const double elapsed = (double)(monotonic_time_ns() - start) / 1e6;
+    printf("Parsed %zu and evaluated %zu of %zu lines in %.3lf ms\n\n", parsed, evaluated, array_size(watch->lines), elapsed);
+    fflush(stdout);
+}
+
+static bool is_file_event(const char *const events, const size_t size, const char *const base_name) {
+    for (size_t offset = 0; offset < size;) {
+        const struct inotify_event *const event = (const struct inotify_event *)&events[offset];
+        if ((event->len > 0) && (strcmp(event->name, base_name) == 0)) {
+            return true;
+        }
+        offset += sizeof(struct inotify_event) + event->len;
+    }
+    return false;
+}
+
+static void destroy_watch(struct Watch *const watch) {
+    for (size_t i = 0; i < array_size(watch->lines); i++) {
+        destroy_line(&watch->lines[i]);
+    }
+    array_del(watch->lines);
+    free(watch->slots);
+    destroy_name_table(&watch->names);
+    destroy_variables(&watch->initial);
+    destroy_context(&watch->line_ctx);
+}
+
+// Editors often save a file by replacing it, so its directory is watched instead
+static int watch_directory(struct Context *const ctx, const char *const file_name, const char **const base_name) {
+    const char *const slash = strrchr(file_name, '/');
+    *base_name = (slash == NULL) ? file_name : (slash + 1);
+    const size_t directory_length = (slash == NULL) ? 1 : ((slash == file_name) ? 1 : (size_t)(slash - file_name));
+    char directory[directory_length + 1];
+    if (slash == NULL) {
+        strcpy(directory, ".");
+    } else {
+        memcpy(directory, (slash == file_name) ? "/" : file_name, directory_length);
+        directory[directory_length] = '\0';
+    }
+    const int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        print_error(&ctx->diagnostics, "Function \"inotify_init1()\" failed with error: %s\n", strerror(errno));
+        return -1;
+    }
+    if (inotify_add_watch(inotify_fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        print_error(&ctx->diagnostics, "Couldn't watch the directory \"%s\", because of the following error: %s\n", directory, strerror(errno));
+        close(inotify_fd);
+        return -1;
+    }
+    return inotify_fd;
+}
+
+bool watch_file(struct Context *const ctx, const char *const file_name) {
+    const char *base_name = NULL;
+    const int inotify_fd = watch_directory(ctx, file_name, &base_name);
+    if (inotify_fd < 0) {
+        return true;
+    }
+    // The signals are received by the loop, so the process finishes normally
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    const int signal_fd = (sigprocmask(SIG_BLOCK, &signals, NULL) == 0) ? signalfd(-1, &signals, SFD_CLOEXEC) : -1;
+    if (signal_fd < 0) {
+        print_error(&ctx->diagnostics, "Couldn't handle the signals, because of the following error: %s\n", strerror(errno));
+        close(inotify_fd);
+        return true;
+    }
+    struct Watch *const watch = malloc(sizeof(struct Watch));
+    check_allocation(watch);
+    *watch = (struct Watch){
+        .file_name = file_name,
+        .ctx = ctx,
+        .diagnostics = ctx->diagnostics,
+        .lines = array_new(sizeof(struct Watch_Line), 64),
+        .names = create_name_table(true),
+        .initial = create_variables(array_size(ctx->vars.list) + 1, &watch->diagnostics),
+        .next_id = WATCH_INITIAL_WRITER + 1,
+    };
+    check_allocation(watch->lines);
+    check_allocation(watch->initial.list);
+    for (size_t i = 0; i < array_size(ctx->vars.list); i++) {
+        assign_variable(&watch->initial, ctx->vars.list[i].name, ctx->vars.list[i].value);
+    }
+    create_context(&watch->line_ctx, ctx->diagnostics.file);
+    watch->line_ctx.diagnostics.callback = collect_diagnostic;
+    watch->line_ctx.diagnostics.user_data = watch;
+    watch->line_ctx.input.is_interactive = false;
+    const struct Diagnostics previous_diagnostics = ctx->diagnostics;
+    ctx->diagnostics.callback = collect_diagnostic;
+    ctx->diagnostics.user_data = watch;
+    ctx->input.is_interactive = false;
+    update(watch);
+    struct pollfd fds[] = {
+        {.fd = inotify_fd, .events = POLLIN},
+        {.fd = signal_fd, .events = POLLIN},
+    };
+    bool error = false;
+    while ((ctx->actions & ACTION_EXIT) == 0) {
+        if (poll(fds, sizeof(fds) / sizeof(fds[0]), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            print_error(&watch->diagnostics, "Function \"poll()\" failed with error: %s\n", strerror(errno));
+            error = true;
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        alignas(struct inotify_event) char events[WATCH_EVENTS_SIZE];
+        const ssize_t size = read(inotify_fd, events, sizeof(events));
+        if ((size > 0) && is_file_event(events, (size_t)size, base_name)) {
+            update(watch);
+        }
+    }
+    ctx->diagnostics = previous_diagnostics;
+    destroy_watch(watch);
+    free(watch);
+    close(signal_fd);
+    close(inotify_fd);
+    return error;
+}
+
+#else // Not Linux
+
+bool watch_file(struct Context *const ctx, const char *const file_name) {
+    (void)file_name;
+    print_error(&ctx->diagnostics, "The watch mode is only supported on Linux!\n");
+    return true;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// END
+//------------------------------------------------------------------------------
+
+// MIT License
+
+// Copyright (c) 2022 CLECIO JUNG <clecio.jung@gmail.com>
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.